@@ -72,7 +72,8 @@ HEADERS = \
     src/pluginconfigs.h \
     src/clioptions.h \
     src/recording.h \
-    src/updates.h
+    src/updates.h \
+    src/effectpreviews.h
 
 INCLUDEPATH += \
     ../libAvKys/Lib/src
@@ -102,7 +103,8 @@ SOURCES = \
     src/pluginconfigs.cpp \
     src/clioptions.cpp \
     src/recording.cpp \
-    src/updates.cpp
+    src/updates.cpp \
+    src/effectpreviews.cpp
 
 lupdate_only {
     SOURCES += $$files(share/qml/*.qml)
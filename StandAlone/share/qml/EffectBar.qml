@@ -231,6 +231,31 @@ Rectangle {
         }
     }
 
+    Image {
+        id: imgEffectPreview
+        height: visible? width * 3 / 4: 0
+        anchors.topMargin: visible? 8: 0
+        anchors.right: parent.right
+        anchors.left: parent.left
+        anchors.top: effectResetButton.bottom
+        fillMode: Image.PreserveAspectFit
+        cache: false
+        asynchronous: true
+        visible: advancedMode && scrollEffects.visible
+        source: ""
+
+        Connections {
+            target: EffectPreviews
+
+            onPreviewsUpdated: {
+                imgEffectPreview.source =
+                        recEffectBar.curEffect && imgEffectPreview.visible?
+                            EffectPreviews.previewUrl(recEffectBar.curEffect):
+                            ""
+            }
+        }
+    }
+
     AkScrollView {
         id: scrollEffects
         visible: advancedMode? false: true
@@ -239,7 +264,7 @@ Rectangle {
         anchors.bottom: recAddEffect.top
         anchors.right: parent.right
         anchors.left: parent.left
-        anchors.top: effectResetButton.bottom
+        anchors.top: imgEffectPreview.bottom
 
         onVisibleChanged: {
             if (!advancedMode)
@@ -248,11 +273,11 @@ Rectangle {
             if (visible) {
                 var option = lsvEffectList.model.get(lsvEffectList.currentIndex)
                 var effect = option? option.effect: ""
-                VideoEffects.showPreview(effect)
+                EffectPreviews.effects = effect? [effect]: []
                 recEffectBar.curEffect = effect
                 recEffectBar.curEffectIndex = 0
             } else
-                VideoEffects.removeAllPreviews()
+                EffectPreviews.effects = []
         }
 
         OptionList {
@@ -274,10 +299,10 @@ Rectangle {
 
                 if (scrollEffects.visible) {
                     if (advancedMode)
-                        VideoEffects.showPreview(effect)
+                        EffectPreviews.effects = [effect]
                     else {
                         VideoEffects.effects = []
-                        VideoEffects.appendEffect(effect, false)
+                        VideoEffects.appendEffect(effect)
                     }
                 }
 
@@ -133,7 +133,7 @@ ColumnLayout {
                     if (VideoEffects.effects.length < 1)
                         recEffectConfig.curEffect = ""
                 } else {
-                    VideoEffects.setAsPreview(effectIndex, false)
+                    VideoEffects.appendEffect(recEffectConfig.curEffect)
                     recEffectConfig.effectAdded(recEffectConfig.curEffect)
                 }
             }
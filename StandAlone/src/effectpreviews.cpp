@@ -0,0 +1,316 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QQmlContext>
+#include <QQmlApplicationEngine>
+#include <QQuickImageProvider>
+#include <akpacket.h>
+#include <akutils.h>
+
+#include "effectpreviews.h"
+
+#define DEFAULT_PREVIEW_WIDTH  160
+#define DEFAULT_PREVIEW_HEIGHT 120
+#define DEFAULT_PREVIEW_RATE   5.0
+
+class EffectPreviewsProvider: public QQuickImageProvider
+{
+    public:
+        EffectPreviewsProvider(EffectPreviews *effectPreviews):
+            QQuickImageProvider(QQuickImageProvider::Image),
+            m_effectPreviews(effectPreviews)
+        {
+        }
+
+        QImage requestImage(const QString &id,
+                            QSize *size,
+                            const QSize &requestedSize)
+        {
+            // The id is EFFECT/SERIAL, the serial only defeats the cache.
+            auto preview = this->m_effectPreviews->preview(id.section('/', 0, 0));
+
+            if (!preview.isNull() && requestedSize.isValid())
+                preview = preview.scaled(requestedSize, Qt::KeepAspectRatio);
+
+            if (size)
+                *size = preview.size();
+
+            return preview;
+        }
+
+    private:
+        EffectPreviews *m_effectPreviews;
+};
+
+class EffectPreviewsPrivate
+{
+    public:
+        QQmlApplicationEngine *m_engine;
+        QStringList m_effects;
+        QSize m_size;
+        qreal m_maxRate;
+        QMap<QString, QImage> m_previews;
+        QMap<QString, AkElementPtr> m_elements;
+        quint64 m_serial;
+        mutable QMutex m_mutex;
+
+        // Only used from the streaming thread.
+        QElapsedTimer m_timer;
+
+        EffectPreviewsPrivate():
+            m_engine(nullptr),
+            m_size(DEFAULT_PREVIEW_WIDTH, DEFAULT_PREVIEW_HEIGHT),
+            m_maxRate(DEFAULT_PREVIEW_RATE),
+            m_serial(0)
+        {
+        }
+};
+
+EffectPreviews::EffectPreviews(QQmlApplicationEngine *engine, QObject *parent):
+    QObject(parent)
+{
+    this->d = new EffectPreviewsPrivate;
+    this->setQmlEngine(engine);
+}
+
+EffectPreviews::~EffectPreviews()
+{
+    delete this->d;
+}
+
+QStringList EffectPreviews::effects() const
+{
+    this->d->m_mutex.lock();
+    auto effects = this->d->m_effects;
+    this->d->m_mutex.unlock();
+
+    return effects;
+}
+
+QSize EffectPreviews::size() const
+{
+    this->d->m_mutex.lock();
+    auto size = this->d->m_size;
+    this->d->m_mutex.unlock();
+
+    return size;
+}
+
+qreal EffectPreviews::maxRate() const
+{
+    this->d->m_mutex.lock();
+    auto maxRate = this->d->m_maxRate;
+    this->d->m_mutex.unlock();
+
+    return maxRate;
+}
+
+QImage EffectPreviews::preview(const QString &effectId) const
+{
+    this->d->m_mutex.lock();
+    auto preview = this->d->m_previews.value(effectId);
+    this->d->m_mutex.unlock();
+
+    return preview;
+}
+
+QString EffectPreviews::previewUrl(const QString &effectId) const
+{
+    this->d->m_mutex.lock();
+    auto serial = this->d->m_serial;
+    this->d->m_mutex.unlock();
+
+    return QString("image://effectpreviews/%1/%2").arg(effectId).arg(serial);
+}
+
+void EffectPreviews::setEffects(const QStringList &effects)
+{
+    if (this->effects() == effects)
+        return;
+
+    /* Create the elements here, in the GUI thread, so they belong to a
+     * thread with an event loop. The streaming thread only calls them, but
+     * it can hold the last reference to a dropped element, so they are
+     * released with deleteLater() to be destroyed back in this thread.
+     */
+    this->d->m_mutex.lock();
+    auto elements = this->d->m_elements;
+    this->d->m_mutex.unlock();
+
+    QMap<QString, AkElementPtr> newElements;
+
+    for (auto &effectId: effects) {
+        auto element = elements.value(effectId);
+
+        if (!element) {
+            auto elementPtr = AkElement::createPtr(effectId);
+
+            if (!elementPtr)
+                continue;
+
+            element = AkElementPtr(elementPtr, &QObject::deleteLater);
+
+            element->setState(AkElement::ElementStatePlaying);
+        }
+
+        newElements[effectId] = element;
+    }
+
+    this->d->m_mutex.lock();
+    this->d->m_effects = effects;
+    this->d->m_elements = newElements;
+
+    for (auto &effectId: this->d->m_previews.keys())
+        if (!effects.contains(effectId))
+            this->d->m_previews.remove(effectId);
+
+    this->d->m_mutex.unlock();
+
+    /* The elements dropped here are deleted in this thread once the frame
+     * being rendered, if any, releases its own references.
+     */
+
+    emit this->effectsChanged(effects);
+}
+
+void EffectPreviews::setSize(const QSize &size)
+{
+    this->d->m_mutex.lock();
+
+    if (this->d->m_size == size) {
+        this->d->m_mutex.unlock();
+
+        return;
+    }
+
+    this->d->m_size = size;
+    this->d->m_mutex.unlock();
+
+    emit this->sizeChanged(size);
+}
+
+void EffectPreviews::setMaxRate(qreal maxRate)
+{
+    this->d->m_mutex.lock();
+
+    if (qFuzzyCompare(this->d->m_maxRate, maxRate)) {
+        this->d->m_mutex.unlock();
+
+        return;
+    }
+
+    this->d->m_maxRate = maxRate;
+    this->d->m_mutex.unlock();
+
+    emit this->maxRateChanged(maxRate);
+}
+
+void EffectPreviews::resetEffects()
+{
+    this->setEffects({});
+}
+
+void EffectPreviews::resetSize()
+{
+    this->setSize(QSize(DEFAULT_PREVIEW_WIDTH, DEFAULT_PREVIEW_HEIGHT));
+}
+
+void EffectPreviews::resetMaxRate()
+{
+    this->setMaxRate(DEFAULT_PREVIEW_RATE);
+}
+
+AkPacket EffectPreviews::iStream(const AkPacket &packet)
+{
+    this->d->m_mutex.lock();
+    auto effects = this->d->m_effects;
+    auto elements = this->d->m_elements;
+    auto size = this->d->m_size;
+    auto maxRate = this->d->m_maxRate;
+    this->d->m_mutex.unlock();
+
+    if (elements.isEmpty() || maxRate <= 0 || size.isEmpty())
+        return AkPacket();
+
+    if (this->d->m_timer.isValid()
+        && this->d->m_timer.elapsed() < qint64(1000 / maxRate))
+        return AkPacket();
+
+    this->d->m_timer.start();
+
+    // Scale the frame once, all the effects share the same copy.
+    auto frame = AkUtils::packetToImage(packet);
+
+    if (frame.isNull())
+        return AkPacket();
+
+    frame = frame.scaled(size, Qt::KeepAspectRatio, Qt::FastTransformation)
+                 .convertToFormat(QImage::Format_ARGB32);
+    auto iPacket = AkUtils::imageToPacket(frame, packet);
+
+    if (!iPacket)
+        return AkPacket();
+
+    QMap<QString, QImage> previews;
+
+    for (auto &effectId: effects) {
+        auto element = elements.value(effectId);
+
+        if (!element)
+            continue;
+
+        auto oPacket = (*element)(iPacket);
+
+        // Detach the thumbnail from the frame buffers.
+        if (oPacket)
+            previews[effectId] = AkUtils::packetToImage(oPacket).copy();
+    }
+
+    this->d->m_mutex.lock();
+
+    // The effects could have changed while rendering.
+    for (auto &effectId: previews.keys())
+        if (this->d->m_effects.contains(effectId))
+            this->d->m_previews[effectId] = previews[effectId];
+
+    this->d->m_serial++;
+    this->d->m_mutex.unlock();
+
+    emit this->previewsUpdated();
+
+    return AkPacket();
+}
+
+void EffectPreviews::setQmlEngine(QQmlApplicationEngine *engine)
+{
+    if (this->d->m_engine == engine)
+        return;
+
+    this->d->m_engine = engine;
+
+    if (engine) {
+        engine->rootContext()->setContextProperty("EffectPreviews", this);
+        engine->addImageProvider(QLatin1String("effectpreviews"),
+                                 new EffectPreviewsProvider(this));
+    }
+}
+
+#include "moc_effectpreviews.cpp"
@@ -0,0 +1,88 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef EFFECTPREVIEWS_H
+#define EFFECTPREVIEWS_H
+
+#include <QImage>
+#include <akelement.h>
+
+class EffectPreviewsPrivate;
+class EffectPreviews;
+class QQmlApplicationEngine;
+
+typedef QSharedPointer<EffectPreviews> EffectPreviewsPtr;
+
+/* Renders thumbnails of the effects the user is browsing.
+ *
+ * The effects run in a thread of their own over a downscaled copy of the
+ * current frame, at a limited rate, so browsing the effects doesn't load the
+ * main chain. The thumbnails are served to Qml as image://effectpreviews/.
+ */
+class EffectPreviews: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QStringList effects
+               READ effects
+               WRITE setEffects
+               RESET resetEffects
+               NOTIFY effectsChanged)
+    Q_PROPERTY(QSize size
+               READ size
+               WRITE setSize
+               RESET resetSize
+               NOTIFY sizeChanged)
+    Q_PROPERTY(qreal maxRate
+               READ maxRate
+               WRITE setMaxRate
+               RESET resetMaxRate
+               NOTIFY maxRateChanged)
+
+    public:
+        explicit EffectPreviews(QQmlApplicationEngine *engine=nullptr,
+                                QObject *parent=nullptr);
+        ~EffectPreviews();
+
+        Q_INVOKABLE QStringList effects() const;
+        Q_INVOKABLE QSize size() const;
+        Q_INVOKABLE qreal maxRate() const;
+        Q_INVOKABLE QImage preview(const QString &effectId) const;
+        Q_INVOKABLE QString previewUrl(const QString &effectId) const;
+
+    private:
+        EffectPreviewsPrivate *d;
+
+    signals:
+        void effectsChanged(const QStringList &effects);
+        void sizeChanged(const QSize &size);
+        void maxRateChanged(qreal maxRate);
+        void previewsUpdated();
+
+    public slots:
+        void setEffects(const QStringList &effects);
+        void setSize(const QSize &size);
+        void setMaxRate(qreal maxRate);
+        void resetEffects();
+        void resetSize();
+        void resetMaxRate();
+        AkPacket iStream(const AkPacket &packet);
+        void setQmlEngine(QQmlApplicationEngine *engine=nullptr);
+};
+
+#endif // EFFECTPREVIEWS_H
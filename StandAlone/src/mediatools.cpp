@@ -34,6 +34,8 @@
 #include <akutils.h>
 #include <akcaps.h>
 #include <akvideocaps.h>
+#include <aklatencybudget.h>
+#include <akelementstats.h>
 
 #include "mediatools.h"
 #include "videodisplay.h"
@@ -42,10 +44,14 @@
 #include "mediasource.h"
 #include "audiolayer.h"
 #include "videoeffects.h"
+#include "effectpreviews.h"
 #include "recording.h"
 #include "updates.h"
 #include "clioptions.h"
 
+// About a second of video at 30 fps, absorbs the encoder hiccups.
+#define RECORDING_QUEUE_DEPTH 32
+
 #define COMMONS_PROJECT_URL "https://webcamoid.github.io/"
 #define COMMONS_PROJECT_LICENSE_URL "https://raw.githubusercontent.com/webcamoid/webcamoid/master/COPYING"
 #define COMMONS_PROJECT_DOWNLOADS_URL "https://webcamoid.github.io/#downloads"
@@ -60,12 +66,17 @@ class MediaToolsPrivate
         MediaSourcePtr m_mediaSource;
         AudioLayerPtr m_audioLayer;
         VideoEffectsPtr m_videoEffects;
+        EffectPreviewsPtr m_effectPreviews;
         RecordingPtr m_recording;
         UpdatesPtr m_updates;
         int m_windowWidth;
         int m_windowHeight;
         bool m_enableVirtualCamera;
+        bool m_recordingDropFrames;
         AkElementPtr m_virtualCamera;
+        AkElementPtr m_videoTee;
+        QList<QObject *> m_videoOutputs;
+        AkElementStats *m_elementStats;
         QSystemTrayIcon *m_trayIcon;
         CliOptions m_cliOptions;
 
@@ -74,6 +85,8 @@ class MediaToolsPrivate
             m_windowWidth(0),
             m_windowHeight(0),
             m_enableVirtualCamera(false),
+            m_recordingDropFrames(false),
+            m_elementStats(nullptr),
             m_trayIcon(nullptr)
         {
         }
@@ -81,6 +94,10 @@ class MediaToolsPrivate
         inline bool embedInterface(QQmlApplicationEngine *engine,
                                    QObject *ctrlInterface,
                                    const QString &where) const;
+        inline void addVideoOutput(QObject *element,
+                                   int depth,
+                                   AkPacketQueue::DropPolicy dropPolicy);
+        inline void removeVideoOutputs();
 };
 
 MediaTools::MediaTools(QObject *parent):
@@ -99,14 +116,27 @@ MediaTools::MediaTools(QObject *parent):
     this->d->m_mediaSource = MediaSourcePtr(new MediaSource(this->d->m_engine));
     this->d->m_audioLayer = AudioLayerPtr(new AudioLayer(this->d->m_engine));
     this->d->m_videoEffects = VideoEffectsPtr(new VideoEffects(this->d->m_engine));
+    this->d->m_effectPreviews =
+            EffectPreviewsPtr(new EffectPreviews(this->d->m_engine));
     this->d->m_recording = RecordingPtr(new Recording(this->d->m_engine));
     this->d->m_updates = UpdatesPtr(new Updates(this->d->m_engine));
     this->d->m_virtualCamera = AkElement::create("VirtualCamera");
+    this->d->m_elementStats = new AkElementStats(this);
 
-    if (this->d->m_virtualCamera) {
+    /* The preview, the recording and the virtual camera receive the video
+     * from its own thread, so the slowest of them don't stall the others.
+     */
+    this->d->m_videoTee = AkElement::create("Tee");
+
+    if (this->d->m_videoTee)
         AkElement::link(this->d->m_videoEffects.data(),
-                        this->d->m_virtualCamera.data(),
+                        this->d->m_videoTee.data(),
                         Qt::DirectConnection);
+
+    if (this->d->m_virtualCamera) {
+        this->d->addVideoOutput(this->d->m_virtualCamera.data(),
+                                2,
+                                AkPacketQueue::DropPolicyDropOldest);
         QObject::connect(this->d->m_virtualCamera.data(),
                          SIGNAL(stateChanged(AkElement::ElementState)),
                          this,
@@ -125,15 +155,37 @@ MediaTools::MediaTools(QObject *parent):
                          SLOT(saveVirtualCameraRootMethod(const QString &)));
     }
 
-    AkElement::link(this->d->m_mediaSource.data(),
-                    this->d->m_videoEffects.data(),
-                    Qt::DirectConnection);
+    /* Run the effects chain in its own thread, so the capture thread only
+     * has to hand over the frame. Stale frames are useless for live
+     * preview, so drop the oldest one when effects can't keep up.
+     */
+    AkElement::linkQueued(this->d->m_mediaSource.data(),
+                          this->d->m_videoEffects.data(),
+                          2,
+                          AkPacketQueue::DropPolicyDropOldest);
     AkElement::link(this->d->m_mediaSource.data(),
                     this->d->m_audioLayer.data(),
                     Qt::DirectConnection);
-    AkElement::link(this->d->m_videoEffects.data(),
-                    this->d->m_recording.data(),
-                    Qt::DirectConnection);
+    /* The recording must not lose frames, so by default a lagging encoder
+     * blocks the effects thread, and with it the preview and the virtual
+     * camera, once its queue is full. With recordingDropFrames enabled the
+     * frames it can't take are dropped instead, and counted (see
+     * droppedFrames()).
+     */
+    QSettings config;
+    config.beginGroup("GeneralConfigs");
+    this->d->m_recordingDropFrames =
+            config.value("recordingDropFrames", false).toBool();
+    config.endGroup();
+    this->d->addVideoOutput(this->d->m_recording.data(),
+                            RECORDING_QUEUE_DEPTH,
+                            this->d->m_recordingDropFrames?
+                                AkPacketQueue::DropPolicyDropNewest:
+                                AkPacketQueue::DropPolicyBlock);
+    // The effect thumbnails only need the latest frame.
+    this->d->addVideoOutput(this->d->m_effectPreviews.data(),
+                            1,
+                            AkPacketQueue::DropPolicyDropOldest);
     AkElement::link(this->d->m_audioLayer.data(),
                     this->d->m_recording.data(),
                     Qt::DirectConnection);
@@ -204,6 +256,12 @@ MediaTools::MediaTools(QObject *parent):
 MediaTools::~MediaTools()
 {
     this->saveConfigs();
+
+    // Stop the queue threads before the elements they feed are destroyed.
+    AkElement::unlink(this->d->m_mediaSource.data(),
+                      this->d->m_videoEffects.data());
+    this->d->removeVideoOutputs();
+
     delete this->d->m_engine;
     delete this->d;
 }
@@ -231,6 +289,19 @@ AkElement::ElementState MediaTools::virtualCameraState() const
     return AkElement::ElementStateNull;
 }
 
+QVariantMap MediaTools::droppedFrames() const
+{
+    QVariantMap droppedFrames {
+        {"videoEffects", AkElement::droppedPackets(this->d->m_videoEffects.data())},
+        {"recording"   , AkElement::droppedPackets(this->d->m_recording.data())   }
+    };
+
+    if (this->d->m_virtualCamera)
+        droppedFrames["virtualCamera"] = this->d->m_virtualCamera->droppedPackets();
+
+    return droppedFrames;
+}
+
 QString MediaTools::applicationName() const
 {
     return QCoreApplication::applicationName();
@@ -427,6 +498,36 @@ bool MediaToolsPrivate::embedInterface(QQmlApplicationEngine *engine,
     return false;
 }
 
+void MediaToolsPrivate::addVideoOutput(QObject *element,
+                                       int depth,
+                                       AkPacketQueue::DropPolicy dropPolicy)
+{
+    this->m_videoOutputs << element;
+
+    if (this->m_videoTee)
+        QMetaObject::invokeMethod(this->m_videoTee.data(),
+                                  "addBranch",
+                                  Q_ARG(QObject *, element),
+                                  Q_ARG(int, depth),
+                                  Q_ARG(AkPacketQueue::DropPolicy, dropPolicy));
+    else
+        AkElement::linkQueued(this->m_videoEffects.data(),
+                              element,
+                              depth,
+                              dropPolicy);
+}
+
+void MediaToolsPrivate::removeVideoOutputs()
+{
+    if (this->m_videoTee)
+        QMetaObject::invokeMethod(this->m_videoTee.data(), "clearBranches");
+    else
+        for (auto &element: this->m_videoOutputs)
+            AkElement::unlink(this->m_videoEffects.data(), element);
+
+    this->m_videoOutputs.clear();
+}
+
 void MediaTools::setWindowWidth(int windowWidth)
 {
     if (this->d->m_windowWidth == windowWidth)
@@ -520,6 +621,8 @@ void MediaTools::loadConfigs()
     QSize windowSize = config.value("windowSize", QSize(1024, 600)).toSize();
     this->d->m_windowWidth = windowSize.width();
     this->d->m_windowHeight = windowSize.height();
+    AkLatencyBudget::globalInstance()->setBudget(config.value("latencyBudget",
+                                                              int(AkLatencyBudget::DefaultBudget)).toLongLong());
 
     if (this->d->m_virtualCamera) {
         QString driverPath;
@@ -572,6 +675,8 @@ void MediaTools::saveConfigs()
     config.beginGroup("GeneralConfigs");
     config.setValue("windowSize", QSize(this->d->m_windowWidth,
                                         this->d->m_windowHeight));
+    config.setValue("latencyBudget", AkLatencyBudget::globalInstance()->budget());
+    config.setValue("recordingDropFrames", this->d->m_recordingDropFrames);
 
     if (this->d->m_virtualCamera) {
         auto driverPath = this->d->m_virtualCamera->property("driverPath").toString();
@@ -600,6 +705,7 @@ void MediaTools::show()
 
     // Map tray icon to QML
     this->d->m_engine->rootContext()->setContextProperty("trayIcon", this->d->m_trayIcon);
+    this->d->m_engine->rootContext()->setContextProperty("ElementStats", this->d->m_elementStats);
 
     // Map tray icon enums to QML
     this->d->m_engine->rootContext()->setContextProperty("TrayIcon_NoIcon", QSystemTrayIcon::NoIcon);
@@ -616,9 +722,9 @@ void MediaTools::show()
         if (!videoDisplay)
             continue;
 
-        AkElement::link(this->d->m_videoEffects.data(),
-                        videoDisplay,
-                        Qt::DirectConnection);
+        this->d->addVideoOutput(videoDisplay,
+                                2,
+                                AkPacketQueue::DropPolicyDropOldest);
         break;
     }
 
@@ -58,6 +58,7 @@ class MediaTools: public QObject
         Q_INVOKABLE int windowHeight() const;
         Q_INVOKABLE bool enableVirtualCamera() const;
         Q_INVOKABLE AkElement::ElementState virtualCameraState() const;
+        Q_INVOKABLE QVariantMap droppedFrames() const;
         Q_INVOKABLE QString applicationName() const;
         Q_INVOKABLE QString applicationVersion() const;
         Q_INVOKABLE QString qtVersion() const;
@@ -18,6 +18,7 @@
  */
 
 #include <QMutex>
+#include <QThread>
 #include <QSettings>
 #include <QQuickItem>
 #include <QQmlContext>
@@ -27,6 +28,18 @@
 
 #include "videoeffects.h"
 
+/* The effects chain as seen by the streaming thread.
+ *
+ * A chain is never modified once published. Editing the effects builds a new
+ * chain and replaces the current one between two frames, so the streaming
+ * thread never waits for the UI.
+ */
+struct VideoEffectsChain
+{
+    QList<AkElementPtr> effects;
+    AkElement::ElementState state;
+};
+
 class VideoEffectsPrivate
 {
     public:
@@ -38,13 +51,25 @@ class VideoEffectsPrivate
         QStringList m_effectsId;
         AkElementPtr m_videoMux;
         QMutex m_mutex;
+        QAtomicPointer<VideoEffectsChain> m_chain;
+        QAtomicInt m_epoch;
+        QAtomicInt m_readers[2];
 
         VideoEffectsPrivate():
             m_engine(nullptr),
             m_state(AkElement::ElementStateNull),
-            m_advancedMode(false)
+            m_advancedMode(false),
+            m_chain(nullptr)
+        {
+        }
+
+        ~VideoEffectsPrivate()
         {
+            delete this->replaceChain(nullptr);
         }
+
+        inline void publish();
+        inline VideoEffectsChain *replaceChain(VideoEffectsChain *chain);
 };
 
 VideoEffects::VideoEffects(QQmlApplicationEngine *engine, QObject *parent):
@@ -106,10 +131,8 @@ QStringList VideoEffects::availableEffects() const
         for (const AkElementPtr &effect: this->d->m_effects) {
             int i = effects.indexOf(effect->pluginId());
 
-            if (i < 0 || effect->property("preview").toBool())
-                continue;
-
-            effects.removeAt(i);
+            if (i >= 0)
+                effects.removeAt(i);
         }
 
     return effects;
@@ -208,41 +231,22 @@ void VideoEffects::setEffects(const QStringList &effects, bool emitSignal)
     if (this->d->m_effectsId == effects)
         return;
 
-    auto state = this->state();
-
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
-
-    this->d->m_mutex.lock();
-
-    if (!this->d->m_effects.isEmpty()) {
-        if (this->d->m_videoMux)
-            this->d->m_effects.last()->unlink(this->d->m_videoMux);
-
-        this->d->m_effects.clear();
-        this->d->m_effectsId.clear();
-    }
-
+    // Create the new effects while the current chain keeps running.
+    QList<AkElementPtr> newEffects;
     QStringList curEffects;
-    AkElementPtr prevEffect;
 
     for (const QString &effectId: effects)
         if (auto effect = AkElement::create(effectId)) {
-            this->d->m_effects << effect;
-            this->d->m_effectsId << effectId;
+            effect->setState(this->d->m_state);
+            newEffects << effect;
             curEffects << effectId;
-
-            if (prevEffect)
-                prevEffect->link(effect, Qt::DirectConnection);
-            else
-                prevEffect = effect;
         }
 
-    if (!this->d->m_effects.isEmpty() && this->d->m_videoMux)
-        this->d->m_effects.last()->link(this->d->m_videoMux, Qt::DirectConnection);
-
+    this->d->m_mutex.lock();
+    this->d->m_effects = newEffects;
+    this->d->m_effectsId = curEffects;
+    this->d->publish();
     this->d->m_mutex.unlock();
-    this->setState(state);
 
     if (emitSignal)
         emit this->effectsChanged(curEffects);
@@ -255,14 +259,22 @@ void VideoEffects::setState(AkElement::ElementState state)
 
     this->d->m_mutex.lock();
 
-    if (state == AkElement::ElementStatePlaying)
+    /* Get the elements ready before they start receiving frames, and stop
+     * sending frames before the elements stop.
+     */
+    if (state == AkElement::ElementStatePlaying) {
         for (int i = this->d->m_effects.size() - 1; i >= 0; i--)
             this->d->m_effects[i]->setState(state);
-    else
+
+        this->d->m_state = state;
+        this->d->publish();
+    } else {
+        this->d->m_state = state;
+        this->d->publish();
+
         for (AkElementPtr &effect: this->d->m_effects)
             effect->setState(state);
-
-    this->d->m_state = state;
+    }
 
     this->d->m_mutex.unlock();
 
@@ -293,76 +305,26 @@ void VideoEffects::resetAdvancedMode()
     this->setAdvancedMode(false);
 }
 
-AkElementPtr VideoEffects::appendEffect(const QString &effectId, bool preview)
+AkElementPtr VideoEffects::appendEffect(const QString &effectId)
 {
     auto effect = AkElement::create(effectId);
 
     if (!effect)
         return AkElementPtr();
 
-    if (preview)
-        effect->setProperty("preview", preview);
-
-    auto state = this->state();
-
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
+    effect->setState(this->d->m_state);
 
     this->d->m_mutex.lock();
-
-    if (!this->d->m_effects.isEmpty()) {
-        auto prevEffect = this->d->m_effects.last();
-
-        if (this->d->m_videoMux)
-            prevEffect->unlink(this->d->m_videoMux);
-
-        prevEffect->link(effect, Qt::DirectConnection);
-    }
-
-    if (this->d->m_videoMux)
-        effect->link(this->d->m_videoMux, Qt::DirectConnection);
-
     this->d->m_effects << effect;
-
-    if (!preview)
-        this->d->m_effectsId << effectId;
-
+    this->d->m_effectsId << effectId;
+    this->d->publish();
     this->d->m_mutex.unlock();
 
-    this->setState(state);
-
-    if (!preview)
-        emit this->effectsChanged(this->d->m_effectsId);
+    emit this->effectsChanged(this->d->m_effectsId);
 
     return effect;
 }
 
-void VideoEffects::showPreview(const QString &effectId)
-{
-    this->removeAllPreviews();
-    this->appendEffect(effectId, true);
-}
-
-void VideoEffects::setAsPreview(int index, bool preview)
-{
-    auto effect = this->d->m_effects.value(index);
-
-    if (!effect)
-        return;
-
-    effect->setProperty("preview", preview? true: QVariant());
-
-    if (preview) {
-        if (index < this->d->m_effectsId.size())
-            this->d->m_effectsId.removeAt(index);
-    } else {
-        if (index >= this->d->m_effectsId.size())
-            this->d->m_effectsId << effect->pluginId();
-    }
-
-    emit this->effectsChanged(this->d->m_effectsId);
-}
-
 void VideoEffects::moveEffect(int from, int to)
 {
     if (from == to
@@ -372,134 +334,27 @@ void VideoEffects::moveEffect(int from, int to)
         || to > this->d->m_effects.size())
         return;
 
-    auto state = this->state();
-
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
-
     this->d->m_mutex.lock();
-
-    // Diconnect effect from list.
-    auto effect = this->d->m_effects.value(from);
-    auto prev = this->d->m_effects.value(from - 1);
-    auto next = this->d->m_effects.value(from + 1);
-
-    if (!next)
-        next = this->d->m_videoMux;
-
-    if (prev) {
-        prev->unlink(effect);
-        prev->link(next, Qt::DirectConnection);
-    }
-
-    effect->unlink(next);
-
-    // Reconnect effect.
-    prev = this->d->m_effects.value(to - 1);
-    next = this->d->m_effects.value(to);
-
-    if (!next)
-        next = this->d->m_videoMux;
-
-    if (prev) {
-        prev->unlink(next);
-        prev->link(effect, Qt::DirectConnection);
-    }
-
-    effect->link(next, Qt::DirectConnection);
-
-    // Move the effect in the list.
     this->d->m_effects.move(from, to);
     this->d->m_effectsId.move(from, to);
-
+    this->d->publish();
     this->d->m_mutex.unlock();
 
-    this->setState(state);
     emit this->effectsChanged(this->d->m_effectsId);
 }
 
 void VideoEffects::removeEffect(int index)
 {
-    auto state = this->state();
-
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
-
-    this->d->m_mutex.lock();
-
-    auto effect = this->d->m_effects.value(index);
-
-    if (effect) {
-        auto next = this->d->m_effects.value(index + 1);
-
-        if (!next)
-            next = this->d->m_videoMux;
-
-        effect->unlink(next);
-
-        auto prev = this->d->m_effects.value(index - 1);
-
-        if (prev) {
-            prev->unlink(effect);
-            prev->link(next, Qt::DirectConnection);
-        }
-
-        this->d->m_effects.removeAt(index);
-        this->d->m_effectsId.removeAt(index);
-    }
-
-    this->d->m_mutex.unlock();
-
-    this->setState(state);
-
-    if (effect)
-        emit this->effectsChanged(this->d->m_effectsId);
-}
-
-void VideoEffects::removeAllPreviews()
-{
-    bool hasPreview = false;
-
-    for (AkElementPtr &effect: this->d->m_effects)
-        if (effect->property("preview").toBool()) {
-            hasPreview = true;
-
-            break;
-        }
-
-    if (!hasPreview)
+    if (index < 0 || index >= this->d->m_effects.size())
         return;
 
-    auto state = this->state();
-
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
-
     this->d->m_mutex.lock();
-
-    for (int i = 0; i < this->d->m_effects.size(); i++) {
-        auto effect = this->d->m_effects[i];
-
-        if (effect->property("preview").toBool()) {
-            auto prev = this->d->m_effects.value(i - 1);
-            auto next = this->d->m_effects.value(i + 1);
-
-            if (!next)
-                next = this->d->m_videoMux;
-
-            if (prev) {
-                prev->unlink(effect);
-                prev->link(next, Qt::DirectConnection);
-            }
-
-            effect->unlink(next);
-            this->d->m_effects.removeAt(i);
-            i--;
-        }
-    }
-
+    this->d->m_effects.removeAt(index);
+    this->d->m_effectsId.removeAt(index);
+    this->d->publish();
     this->d->m_mutex.unlock();
-    this->setState(state);
+
+    emit this->effectsChanged(this->d->m_effectsId);
 }
 
 void VideoEffects::updateEffects()
@@ -521,17 +376,29 @@ void VideoEffects::updateEffects()
 
 AkPacket VideoEffects::iStream(const AkPacket &packet)
 {
-    this->d->m_mutex.lock();
+    /* Tell the UI thread that this chain is in use, so it won't be freed
+     * until the frame is done. The counter is taken before reading the chain,
+     * see replaceChain() for why this is enough.
+     */
+    int epoch = this->d->m_epoch.loadAcquire() & 1;
+    this->d->m_readers[epoch].ref();
+    auto chain = this->d->m_chain.loadAcquire();
+
+    if (chain && chain->state == AkElement::ElementStatePlaying) {
+        AkPacket oPacket = packet;
+
+        for (const AkElementPtr &effect: chain->effects) {
+            oPacket = (*effect)(oPacket);
+
+            if (!oPacket)
+                break;
+        }
 
-    if (this->d->m_state == AkElement::ElementStatePlaying) {
-        if (this->d->m_effects.isEmpty()) {
-            if (this->d->m_videoMux)
-                (*this->d->m_videoMux)(packet);
-        } else
-            (*this->d->m_effects.first())(packet);
+        if (oPacket && this->d->m_videoMux)
+            (*this->d->m_videoMux)(oPacket);
     }
 
-    this->d->m_mutex.unlock();
+    this->d->m_readers[epoch].deref();
 
     return AkPacket();
 }
@@ -553,19 +420,13 @@ void VideoEffects::advancedModeUpdated(bool advancedMode)
         return;
 
     auto effect = this->d->m_effects.last();
-    effect->setProperty("preview", QVariant());
-
-    auto state = this->state();
-
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
 
     this->d->m_mutex.lock();
     this->d->m_effects = {effect};
     this->d->m_effectsId = QStringList {effect->pluginId()};
+    this->d->publish();
     this->d->m_mutex.unlock();
 
-    this->setState(state);
     emit this->effectsChanged(this->d->m_effectsId);
 }
 
@@ -610,12 +471,11 @@ void VideoEffects::saveEffects(const QStringList &effects)
 
     int i = 0;
 
-    for (const AkElementPtr &effect: this->d->m_effects)
-        if (!effect->property("preview").toBool()) {
-            config.setArrayIndex(i);
-            config.setValue("effect", effect->pluginId());
-            i++;
-        }
+    for (const AkElementPtr &effect: this->d->m_effects) {
+        config.setArrayIndex(i);
+        config.setValue("effect", effect->pluginId());
+        i++;
+    }
 
     config.endArray();
     config.endGroup();
@@ -658,12 +518,11 @@ void VideoEffects::saveProperties()
 
     int i = 0;
 
-    for (const AkElementPtr &effect: this->d->m_effects)
-        if (!effect->property("preview").toBool()) {
-            config.setArrayIndex(i);
-            config.setValue("effect", effect->pluginId());
-            i++;
-        }
+    for (const AkElementPtr &effect: this->d->m_effects) {
+        config.setArrayIndex(i);
+        config.setValue("effect", effect->pluginId());
+        i++;
+    }
 
     config.endArray();
     config.endGroup();
@@ -686,4 +545,41 @@ void VideoEffects::saveProperties()
     }
 }
 
+void VideoEffectsPrivate::publish()
+{
+    auto chain = new VideoEffectsChain {this->m_effects, this->m_state};
+    auto oldChain = this->replaceChain(chain);
+
+    if (!oldChain)
+        return;
+
+    // Stop the effects that were removed from the chain.
+    for (const AkElementPtr &effect: oldChain->effects)
+        if (!chain->effects.contains(effect))
+            effect->setState(AkElement::ElementStateNull);
+
+    delete oldChain;
+}
+
+VideoEffectsChain *VideoEffectsPrivate::replaceChain(VideoEffectsChain *chain)
+{
+    auto oldChain = this->m_chain.fetchAndStoreOrdered(chain);
+
+    /* Wait for the frames that could still be using the old chain. A frame
+     * reads the epoch before counting itself in, so it can get preempted in
+     * between and count itself in an epoch that was already flipped and
+     * waited for. Flipping twice and waiting for each counter to drain
+     * covers that frame too: once a counter is seen at zero after the chain
+     * was replaced, any frame that counts itself in later reads the new chain.
+     */
+    for (int i = 0; i < 2; i++) {
+        int epoch = this->m_epoch.fetchAndAddOrdered(1) & 1;
+
+        while (this->m_readers[epoch].loadAcquire() > 0)
+            QThread::yieldCurrentThread();
+    }
+
+    return oldChain;
+}
+
 #include "moc_videoeffects.cpp"
@@ -83,12 +83,9 @@ class VideoEffects: public QObject
         void resetEffects();
         void resetState();
         void resetAdvancedMode();
-        AkElementPtr appendEffect(const QString &effectId, bool preview=false);
-        void showPreview(const QString &effectId);
-        void setAsPreview(int index, bool preview=false);
+        AkElementPtr appendEffect(const QString &effectId);
         void moveEffect(int from, int to);
         void removeEffect(int index);
-        void removeAllPreviews();
         void updateEffects();
         AkPacket iStream(const AkPacket &packet);
         void setQmlEngine(QQmlApplicationEngine *engine=nullptr);
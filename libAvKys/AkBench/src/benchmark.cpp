@@ -0,0 +1,598 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <algorithm>
+#include <functional>
+#include <QtMath>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QMap>
+#include <QMetaProperty>
+#include <ak.h>
+#include <akcaps.h>
+#include <akelement.h>
+#include <akfrac.h>
+#include <akutils.h>
+#include <akvideopacket.h>
+
+#include "benchmark.h"
+#include "memorystats.h"
+
+Benchmark::Benchmark():
+    m_frames(300),
+    m_warmup(30)
+{
+}
+
+QString Benchmark::errorString() const
+{
+    return this->m_errorString;
+}
+
+int Benchmark::frames() const
+{
+    return this->m_frames;
+}
+
+int Benchmark::warmup() const
+{
+    return this->m_warmup;
+}
+
+QImage Benchmark::source() const
+{
+    return this->m_source;
+}
+
+QStringList Benchmark::effects() const
+{
+    QStringList effects;
+
+    for (auto &effect: this->m_effects)
+        effects << effect.description;
+
+    return effects;
+}
+
+bool Benchmark::addEffect(const QString &description)
+{
+    auto fields = description.split(':');
+    Effect effect;
+    effect.pluginId = fields.takeFirst().trimmed();
+
+    if (effect.pluginId.isEmpty()) {
+        this->m_errorString = QString("Invalid effect: '%1'").arg(description);
+
+        return false;
+    }
+
+    for (auto &field: fields) {
+        int separator = field.indexOf('=');
+
+        if (separator < 1) {
+            this->m_errorString =
+                    QString("Invalid property '%1' for effect '%2'")
+                        .arg(field, effect.pluginId);
+
+            return false;
+        }
+
+        effect.properties[field.left(separator).trimmed()] =
+                field.mid(separator + 1);
+    }
+
+    effect.description = description;
+    this->m_effects << effect;
+
+    return true;
+}
+
+void Benchmark::setFrames(int frames)
+{
+    this->m_frames = qMax(1, frames);
+}
+
+void Benchmark::setWarmup(int warmup)
+{
+    this->m_warmup = qMax(0, warmup);
+}
+
+void Benchmark::setSource(const QImage &source)
+{
+    this->m_source = source;
+}
+
+QJsonObject Benchmark::run(const QSize &size, AkVideoCaps::PixelFormat format)
+{
+    struct EffectStats
+    {
+        AkElementPtr element;
+        QVector<qint64> times;
+        quint64 allocations;
+        quint64 copies;
+        qint64 rss;
+        int emptyFrames;
+    };
+
+    this->m_errorString.clear();
+
+    if (this->m_effects.isEmpty()) {
+        this->m_errorString = "The effects chain is empty";
+
+        return {};
+    }
+
+    auto rssStart = MemoryStats::residentSetSize();
+    QVector<EffectStats> stats;
+
+    for (auto &effect: this->m_effects) {
+        auto rss = MemoryStats::residentSetSize();
+        EffectStats effectStats;
+        effectStats.element = this->createEffect(effect);
+
+        if (!effectStats.element)
+            return {};
+
+        effectStats.times.reserve(this->m_frames);
+        effectStats.allocations = 0;
+        effectStats.copies = 0;
+        effectStats.rss = rss < 0? -1: MemoryStats::residentSetSize() - rss;
+        effectStats.emptyFrames = 0;
+        stats << effectStats;
+    }
+
+    auto frame = this->inputFrame(size, format);
+
+    if (!frame) {
+        this->m_errorString =
+                QString("Can't create a %1x%2 %3 frame")
+                    .arg(size.width())
+                    .arg(size.height())
+                    .arg(AkVideoCaps::pixelFormatToString(format));
+
+        return {};
+    }
+
+    QVector<qint64> chainTimes;
+    chainTimes.reserve(this->m_frames);
+    quint64 chainAllocations = 0;
+    quint64 chainCopies = 0;
+    auto rssPeak = MemoryStats::residentSetSize();
+    QElapsedTimer timer;
+
+    /* The warmup frames fill the caches and the buffer pools, so only the
+     * memory growth is taken from them. The rest of the metrics are measured
+     * in the steady state.
+     */
+    for (int i = -this->m_warmup; i < this->m_frames; i++) {
+        bool warmingUp = i < 0;
+        frame.pts() = i + this->m_warmup;
+        auto packet = frame;
+        qint64 chainTime = 0;
+
+        for (auto &effectStats: stats) {
+            auto rss = warmingUp? MemoryStats::residentSetSize(): -1;
+            auto allocations = MemoryStats::allocations();
+            auto copies = AkUtils::frameCopies();
+            timer.start();
+            auto oPacket = effectStats.element->iStream(packet);
+            auto elapsed = timer.nsecsElapsed();
+            allocations = MemoryStats::allocations() - allocations;
+            copies = AkUtils::frameCopies() - copies;
+
+            if (warmingUp) {
+                if (rss >= 0 && effectStats.rss >= 0)
+                    effectStats.rss +=
+                            qMax<qint64>(0, MemoryStats::residentSetSize() - rss);
+            } else {
+                effectStats.times << elapsed;
+                effectStats.allocations += allocations;
+                effectStats.copies += copies;
+                chainAllocations += allocations;
+                chainCopies += copies;
+            }
+
+            chainTime += elapsed;
+
+            // Effects that don't output anything are skipped.
+            if (oPacket)
+                packet = oPacket;
+            else if (!warmingUp)
+                effectStats.emptyFrames++;
+        }
+
+        if (!warmingUp)
+            chainTimes << chainTime;
+
+        rssPeak = qMax(rssPeak, MemoryStats::residentSetSize());
+    }
+
+    auto rssEnd = MemoryStats::residentSetSize();
+    bool countAllocations = MemoryStats::canCountAllocations();
+    QJsonArray effects;
+
+    for (int i = 0; i < stats.size(); i++) {
+        auto &effectStats = stats[i];
+        auto latency = this->latencyStats(effectStats.times);
+        auto fps = latency.value("fps");
+        latency.remove("fps");
+
+        effects << QJsonObject {
+            {"plugin"             , this->m_effects[i].pluginId},
+            {"properties"         , QJsonObject::fromVariantMap(this->m_effects[i].properties)},
+            {"fps"                , fps},
+            {"latency"            , latency},
+            {"allocationsPerFrame", countAllocations?
+                                        qreal(effectStats.allocations) / this->m_frames:
+                                        -1},
+            {"copiesPerFrame"     , qreal(effectStats.copies) / this->m_frames},
+            {"rss"                , effectStats.rss},
+            {"emptyFrames"        , effectStats.emptyFrames}
+        };
+    }
+
+    auto latency = this->latencyStats(chainTimes);
+    auto fps = latency.value("fps");
+    latency.remove("fps");
+
+    return QJsonObject {
+        {"width"              , size.width()},
+        {"height"             , size.height()},
+        {"format"             , AkVideoCaps::pixelFormatToString(format)},
+        {"frames"             , this->m_frames},
+        {"warmup"             , this->m_warmup},
+        {"fps"                , fps},
+        {"latency"            , latency},
+        {"allocationsPerFrame", countAllocations?
+                                    qreal(chainAllocations) / this->m_frames:
+                                    -1},
+        {"copiesPerFrame"     , qreal(chainCopies) / this->m_frames},
+        {"rss"                , QJsonObject {
+                                    {"start", rssStart},
+                                    {"end"  , rssEnd},
+                                    {"peak" , rssPeak}
+                                }},
+        {"effects"            , effects}
+    };
+}
+
+QList<QImage> Benchmark::render(const QSize &size,
+                                AkVideoCaps::PixelFormat format,
+                                int frames)
+{
+    this->m_errorString.clear();
+    auto frame = this->inputFrame(size, format);
+
+    if (!frame) {
+        this->m_errorString =
+                QString("Can't create a %1x%2 %3 frame")
+                    .arg(size.width())
+                    .arg(size.height())
+                    .arg(AkVideoCaps::pixelFormatToString(format));
+
+        return {};
+    }
+
+    QList<QImage> images;
+
+    for (auto &effect: this->m_effects) {
+        auto element = this->createEffect(effect);
+
+        if (!element)
+            return {};
+
+        /* Many effects use qrand(), which is seeded per thread, and some of
+         * them seed it with the current time when created. Reseed it before
+         * every frame so the output only depends on the frame number.
+         */
+        AkPacket oPacket;
+
+        for (int i = 0; i < frames; i++) {
+            qsrand(uint(i + 1));
+            frame.pts() = i;
+            oPacket = element->iStream(frame);
+        }
+
+        images << AkUtils::packetToImage(oPacket)
+                      .convertToFormat(QImage::Format_ARGB32);
+    }
+
+    return images;
+}
+
+QJsonObject Benchmark::convert(const QSize &size,
+                               AkVideoCaps::PixelFormat format,
+                               const QSize &outputSize,
+                               AkVideoCaps::PixelFormat outputFormat)
+{
+    static const QMap<AkVideoCaps::PixelFormat, QImage::Format> imageFormats {
+        {AkVideoCaps::Format_0rgb    , QImage::Format_RGB32     },
+        {AkVideoCaps::Format_argb    , QImage::Format_ARGB32    },
+        {AkVideoCaps::Format_rgb565le, QImage::Format_RGB16     },
+        {AkVideoCaps::Format_rgb555le, QImage::Format_RGB555    },
+        {AkVideoCaps::Format_rgb24   , QImage::Format_RGB888    },
+        {AkVideoCaps::Format_rgb444le, QImage::Format_RGB444    },
+        {AkVideoCaps::Format_gray    , QImage::Format_Grayscale8}
+    };
+
+    this->m_errorString.clear();
+    auto frame = this->inputFrame(size, format);
+
+    if (!frame) {
+        this->m_errorString =
+                QString("Can't create a %1x%2 %3 frame")
+                    .arg(size.width())
+                    .arg(size.height())
+                    .arg(AkVideoCaps::pixelFormatToString(format));
+
+        return {};
+    }
+
+    QVector<qint64> times;
+    times.reserve(this->m_frames);
+    QElapsedTimer timer;
+
+    for (int i = -this->m_warmup; i < this->m_frames; i++) {
+        timer.start();
+        auto oPacket = AkUtils::convertVideo(AkVideoPacket(frame),
+                                             outputFormat,
+                                             outputSize);
+        auto elapsed = timer.nsecsElapsed();
+
+        if (!oPacket) {
+            this->m_errorString =
+                    QString("Can't convert from %1 to %2")
+                        .arg(AkVideoCaps::pixelFormatToString(format),
+                             AkVideoCaps::pixelFormatToString(outputFormat));
+
+            return {};
+        }
+
+        if (i >= 0)
+            times << elapsed;
+    }
+
+    QJsonObject conversion {
+        {"from"        , AkVideoCaps::pixelFormatToString(format)},
+        {"to"          , AkVideoCaps::pixelFormatToString(outputFormat)},
+        {"width"       , size.width()},
+        {"height"      , size.height()},
+        {"outputWidth" , outputSize.width()},
+        {"outputHeight", outputSize.height()},
+        {"frames"      , this->m_frames},
+        {"native"      , this->latencyStats(times)}
+    };
+
+    if (!imageFormats.contains(format) || !imageFormats.contains(outputFormat))
+        return conversion;
+
+    // The same conversion through QImage, as convertVideo() used to do it.
+    times.clear();
+
+    for (int i = -this->m_warmup; i < this->m_frames; i++) {
+        timer.start();
+        auto image = AkUtils::packetToImage(frame)
+                         .convertToFormat(imageFormats[outputFormat]);
+
+        if (outputSize != size)
+            image = image.scaled(outputSize);
+
+        auto oPacket = AkUtils::imageToPacket(image, frame);
+        auto elapsed = timer.nsecsElapsed();
+
+        if (!oPacket)
+            break;
+
+        if (i >= 0)
+            times << elapsed;
+    }
+
+    conversion["qimage"] = this->latencyStats(times);
+
+    return conversion;
+}
+
+QJsonObject Benchmark::caps(const QSize &size, AkVideoCaps::PixelFormat format)
+{
+    this->m_errorString.clear();
+    auto frame = this->inputFrame(size, format);
+
+    if (!frame) {
+        this->m_errorString =
+                QString("Can't create a %1x%2 %3 frame")
+                    .arg(size.width())
+                    .arg(size.height())
+                    .arg(AkVideoCaps::pixelFormatToString(format));
+
+        return {};
+    }
+
+    // Each operation is repeated this many times per measured frame.
+    static const int repeat = 100;
+    auto caps = frame.caps();
+    AkCaps other(caps);
+    AkVideoCaps videoCaps(caps);
+    QString capsString = caps.toString();
+    volatile uint sink = 0;
+    QElapsedTimer timer;
+
+    auto measure = [this, &timer] (const std::function<void ()> &operation) {
+        for (int i = 0; i < this->m_warmup; i++)
+            operation();
+
+        timer.start();
+
+        for (int i = 0; i < this->m_frames * repeat; i++)
+            operation();
+
+        return qreal(timer.nsecsElapsed()) / (this->m_frames * repeat);
+    };
+
+    QJsonObject operations {
+        {"videoCapsFromCaps", measure([&] () {
+            sink += uint(AkVideoCaps(caps).width());
+        })},
+        {"videoCapsFromString", measure([&] () {
+            sink += uint(AkVideoCaps(AkCaps(capsString)).width());
+        })},
+        {"compare", measure([&] () {
+            sink += caps == other;
+        })},
+        {"compareStrings", measure([&] () {
+            sink += caps.toString() == other.toString();
+        })},
+        {"hash", measure([&] () {
+            sink += qHash(caps);
+        })},
+        {"toCaps", measure([&] () {
+            sink += videoCaps.toCaps().isValid();
+        })},
+        {"toString", measure([&] () {
+            sink += uint(videoCaps.toString().size());
+        })}
+    };
+
+    return QJsonObject {
+        {"width"     , size.width()},
+        {"height"    , size.height()},
+        {"format"    , AkVideoCaps::pixelFormatToString(format)},
+        {"operations", operations}
+    };
+}
+
+AkElementPtr Benchmark::createEffect(const Effect &effect)
+{
+    auto element = AkElement::create(effect.pluginId);
+
+    if (!element) {
+        this->m_errorString = QString("Can't create '%1'").arg(effect.pluginId);
+
+        return {};
+    }
+
+    auto metaObject = element->metaObject();
+
+    for (auto it = effect.properties.begin();
+         it != effect.properties.end();
+         it++) {
+        auto name = it.key().toStdString();
+        int index = metaObject->indexOfProperty(name.c_str());
+        QVariant value = it.value();
+
+        // Lists, like the kernels, are given as comma separated values.
+        if (index >= 0
+            && metaObject->property(index).userType() == QMetaType::QVariantList) {
+            QVariantList list;
+
+            for (auto &item: value.toString().split(','))
+                list << item.trimmed().toDouble();
+
+            value = list;
+        }
+
+        if (index < 0 || !element->setProperty(name.c_str(), value)) {
+            this->m_errorString =
+                    QString("Can't set '%1' to '%2' in '%3'")
+                        .arg(it.key(), it.value().toString(), effect.pluginId);
+
+            return {};
+        }
+    }
+
+    return element;
+}
+
+QImage Benchmark::syntheticFrame(const QSize &size) const
+{
+    /* A gradient with some noise on top of it, so the effects that depend on
+     * the image contents (histograms, edges, thresholds) don't take any
+     * shortcut. The noise is seeded, so all runs see the same frame.
+     */
+    QImage frame(size, QImage::Format_ARGB32);
+    quint32 seed = 1;
+
+    for (int y = 0; y < frame.height(); y++) {
+        auto line = reinterpret_cast<QRgb *>(frame.scanLine(y));
+
+        for (int x = 0; x < frame.width(); x++) {
+            seed = 1664525 * seed + 1013904223;
+            int noise = int(seed >> 26) - 32;
+            int r = 255 * x / qMax(1, frame.width() - 1);
+            int g = 255 * y / qMax(1, frame.height() - 1);
+            int b = 255 - (r + g) / 2;
+
+            line[x] = qRgb(qBound(0, r + noise, 255),
+                           qBound(0, g + noise, 255),
+                           qBound(0, b + noise, 255));
+        }
+    }
+
+    return frame;
+}
+
+AkPacket Benchmark::inputFrame(const QSize &size,
+                               AkVideoCaps::PixelFormat format) const
+{
+    QImage frame;
+
+    if (this->m_source.isNull())
+        frame = this->syntheticFrame(size);
+    else
+        frame = this->m_source.convertToFormat(QImage::Format_ARGB32)
+                              .scaled(size,
+                                      Qt::IgnoreAspectRatio,
+                                      Qt::SmoothTransformation);
+
+    AkPacket defaultPacket;
+    defaultPacket.setId(Ak::id());
+    defaultPacket.setTimeBase(AkFrac(1, 30));
+    auto packet = AkUtils::imageToPacket(frame, defaultPacket);
+
+    if (!packet)
+        return AkPacket();
+
+    return AkUtils::convertVideo(AkVideoPacket(packet), format).toPacket();
+}
+
+QJsonObject Benchmark::latencyStats(QVector<qint64> times) const
+{
+    if (times.isEmpty())
+        return {};
+
+    std::sort(times.begin(), times.end());
+    qint64 total = 0;
+
+    for (auto &time: times)
+        total += time;
+
+    // Nearest rank percentile, in milliseconds.
+    auto percentile = [&times] (qreal p) -> qreal {
+        int rank = qBound(0, qCeil(p * times.size()) - 1, times.size() - 1);
+
+        return times[rank] / 1.0e6;
+    };
+
+    return QJsonObject {
+        {"fps" , total > 0? 1.0e9 * times.size() / total: 0.0},
+        {"mean", total / 1.0e6 / times.size()},
+        {"p50" , percentile(0.5)},
+        {"p99" , percentile(0.99)},
+        {"max" , times.last() / 1.0e6}
+    };
+}
@@ -0,0 +1,89 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QImage>
+#include <QJsonObject>
+#include <akelement.h>
+#include <akpacket.h>
+#include <akvideocaps.h>
+
+/* Runs a chain of effects over a fixed frame, synchronously and without any
+ * UI, and measures how every effect in the chain behaves.
+ */
+class Benchmark
+{
+    public:
+        Benchmark();
+
+        QString errorString() const;
+        int frames() const;
+        int warmup() const;
+        QImage source() const;
+        QStringList effects() const;
+
+        // PLUGIN[:PROPERTY=VALUE[:PROPERTY=VALUE...]]
+        bool addEffect(const QString &description);
+        void setFrames(int frames);
+        void setWarmup(int warmup);
+        void setSource(const QImage &source);
+        QJsonObject run(const QSize &size, AkVideoCaps::PixelFormat format);
+
+        // Runs every effect alone for the given number of frames, and returns
+        // the last frame produced by each one.
+        QList<QImage> render(const QSize &size,
+                             AkVideoCaps::PixelFormat format,
+                             int frames);
+
+        // Measures AkUtils::convertVideo() from one format and size to
+        // another. When both formats have a QImage equivalent, the QImage
+        // conversion the library used before is measured too.
+        QJsonObject convert(const QSize &size,
+                            AkVideoCaps::PixelFormat format,
+                            const QSize &outputSize,
+                            AkVideoCaps::PixelFormat outputFormat);
+
+        // Measures the caps operations done on every packet, in nanoseconds
+        // per operation, along with the string round trips they replaced.
+        QJsonObject caps(const QSize &size, AkVideoCaps::PixelFormat format);
+
+    private:
+        struct Effect
+        {
+            QString description;
+            QString pluginId;
+            QVariantMap properties;
+        };
+
+        QString m_errorString;
+        QList<Effect> m_effects;
+        int m_frames;
+        int m_warmup;
+        QImage m_source;
+
+        AkElementPtr createEffect(const Effect &effect);
+        QImage syntheticFrame(const QSize &size) const;
+        AkPacket inputFrame(const QSize &size,
+                            AkVideoCaps::PixelFormat format) const;
+        QJsonObject latencyStats(QVector<qint64> times) const;
+};
+
+#endif // BENCHMARK_H
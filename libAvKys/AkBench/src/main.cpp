@@ -0,0 +1,389 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSysInfo>
+#include <QTextStream>
+#include <akelement.h>
+#include <akworkerpool.h>
+
+#include "benchmark.h"
+#include "memorystats.h"
+#include "references.h"
+
+int main(int argc, char *argv[])
+{
+    // There is no UI at all, so don't require a display.
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("akbench");
+    QCoreApplication::setApplicationVersion(COMMONS_VERSION);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.setApplicationDescription(QObject::tr("Benchmark a chain of "
+                                                 "video effects."));
+
+    QCommandLineOption effectOpt({"e", "effect"},
+                                 QObject::tr("Append an effect to the chain. "
+                                             "Can be used many times. List "
+                                             "values are separated by "
+                                             "commas."),
+                                 "PLUGIN[:PROPERTY=VALUE...]");
+    parser.addOption(effectOpt);
+    QCommandLineOption sizeOpt({"s", "size"},
+                               QObject::tr("Frame size. Can be used many "
+                                           "times, the chain runs once per "
+                                           "size."),
+                               "WIDTHxHEIGHT");
+    parser.addOption(sizeOpt);
+    QCommandLineOption formatOpt({"f", "format"},
+                                 QObject::tr("Pixel format of the input "
+                                             "frames."),
+                                 "FORMAT", "0rgb");
+    parser.addOption(formatOpt);
+    QCommandLineOption inputOpt({"i", "input"},
+                                QObject::tr("Use this image as input instead "
+                                            "of a synthetic frame."),
+                                "FILE");
+    parser.addOption(inputOpt);
+    QCommandLineOption framesOpt({"n", "frames"},
+                                 QObject::tr("Number of measured frames."),
+                                 "FRAMES", "300");
+    parser.addOption(framesOpt);
+    QCommandLineOption warmupOpt({"w", "warmup"},
+                                 QObject::tr("Number of frames processed "
+                                             "before measuring."),
+                                 "FRAMES", "30");
+    parser.addOption(warmupOpt);
+    QCommandLineOption outputOpt({"o", "output"},
+                                 QObject::tr("Write the report to FILE "
+                                             "instead of the standard "
+                                             "output."),
+                                 "FILE");
+    parser.addOption(outputOpt);
+    QCommandLineOption recursiveOpt({"r", "recursive"},
+                                    QObject::tr("Search in the specified "
+                                                "plugins paths recursively."));
+    parser.addOption(recursiveOpt);
+    QCommandLineOption pluginPathsOpt({"p", "paths"},
+                                      QObject::tr("Semi-colon separated list "
+                                                  "of paths to search for "
+                                                  "plugins."),
+                                      "PATH1;PATH2;PATH3;...");
+    parser.addOption(pluginPathsOpt);
+    QCommandLineOption listOpt({"l", "list"},
+                               QObject::tr("List the available video "
+                                           "filters and exit."));
+    parser.addOption(listOpt);
+    QCommandLineOption saveReferencesOpt("save-references",
+                                         QObject::tr("Don't benchmark, save "
+                                                     "the output of every "
+                                                     "effect as reference "
+                                                     "images in DIR."),
+                                         "DIR");
+    parser.addOption(saveReferencesOpt);
+    QCommandLineOption checkReferencesOpt("check-references",
+                                          QObject::tr("Don't benchmark, "
+                                                      "compare the output of "
+                                                      "every effect with the "
+                                                      "reference images in "
+                                                      "DIR."),
+                                          "DIR");
+    parser.addOption(checkReferencesOpt);
+    QCommandLineOption referenceFramesOpt("reference-frames",
+                                          QObject::tr("Number of frames "
+                                                      "processed before "
+                                                      "taking the output of "
+                                                      "an effect."),
+                                          "FRAMES", "5");
+    parser.addOption(referenceFramesOpt);
+    QCommandLineOption convertOpt({"c", "convert"},
+                                  QObject::tr("Don't run the effects, "
+                                              "measure the conversion of the "
+                                              "input frames to FORMAT, "
+                                              "optionally scaled. Can be "
+                                              "used many times."),
+                                  "FORMAT[:WIDTHxHEIGHT]");
+    parser.addOption(convertOpt);
+    QCommandLineOption capsOpt("caps",
+                               QObject::tr("Don't run the effects, measure "
+                                           "the caps operations done on "
+                                           "every packet."));
+    parser.addOption(capsOpt);
+    QCommandLineOption threadsOpt({"j", "threads"},
+                                  QObject::tr("Maximum number of threads of "
+                                              "the worker pool shared by the "
+                                              "effects."),
+                                  "THREADS");
+    parser.addOption(threadsOpt);
+    QCommandLineOption toleranceOpt({"t", "tolerance"},
+                                    QObject::tr("Default maximum difference "
+                                                "allowed per channel when "
+                                                "comparing with the "
+                                                "references."),
+                                    "DIFF", "0");
+    parser.addOption(toleranceOpt);
+    parser.process(app);
+
+    if (parser.isSet(recursiveOpt))
+        AkElement::setRecursiveSearch(true);
+
+    if (parser.isSet(pluginPathsOpt)) {
+        auto searchPaths = AkElement::searchPaths();
+
+        for (auto &path: parser.value(pluginPathsOpt).split(';'))
+            if (!path.isEmpty())
+                searchPaths << QDir(path).absolutePath();
+
+        AkElement::setSearchPaths(searchPaths);
+    }
+
+    if (parser.isSet(threadsOpt))
+        AkWorkerPool::globalInstance()->setMaxThreads(qMax(1, parser.value(threadsOpt).toInt()));
+
+    QTextStream out(stdout);
+
+    if (parser.isSet(listOpt)) {
+        for (auto &pluginId: AkElement::listPlugins("VideoFilter"))
+            out << pluginId << endl;
+
+        return 0;
+    }
+
+    Benchmark benchmark;
+
+    for (auto &effect: parser.values(effectOpt))
+        if (!benchmark.addEffect(effect)) {
+            qCritical() << benchmark.errorString();
+
+            return 1;
+        }
+
+    benchmark.setFrames(parser.value(framesOpt).toInt());
+    benchmark.setWarmup(parser.value(warmupOpt).toInt());
+
+    if (parser.isSet(inputOpt)) {
+        QImage source(parser.value(inputOpt));
+
+        if (source.isNull()) {
+            qCritical() << "Can't read" << parser.value(inputOpt);
+
+            return 1;
+        }
+
+        benchmark.setSource(source);
+    }
+
+    auto format = AkVideoCaps::pixelFormatFromString(parser.value(formatOpt));
+
+    if (format == AkVideoCaps::Format_none) {
+        qCritical() << "Unknown pixel format" << parser.value(formatOpt);
+
+        return 1;
+    }
+
+    auto sizes = parser.values(sizeOpt);
+
+    if (sizes.isEmpty())
+        sizes << "640x480";
+
+    QList<QPair<AkVideoCaps::PixelFormat, QSize>> conversions;
+
+    for (auto &conversion: parser.values(convertOpt)) {
+        auto fields = conversion.split(':');
+        auto outputFormat = AkVideoCaps::pixelFormatFromString(fields[0]);
+        QSize outputSize;
+
+        if (fields.size() > 1) {
+            auto dimensions = fields[1].toLower().split('x');
+
+            if (dimensions.size() == 2)
+                outputSize = QSize(dimensions[0].toInt(), dimensions[1].toInt());
+
+            if (outputSize.isEmpty()) {
+                qCritical() << "Invalid frame size" << fields[1];
+
+                return 1;
+            }
+        }
+
+        if (outputFormat == AkVideoCaps::Format_none) {
+            qCritical() << "Unknown pixel format" << fields[0];
+
+            return 1;
+        }
+
+        conversions << qMakePair(outputFormat, outputSize);
+    }
+
+    bool saveReferences = parser.isSet(saveReferencesOpt);
+    bool checkReferences = parser.isSet(checkReferencesOpt);
+    QJsonArray runs;
+    QStringList references;
+    QList<QImage> images;
+
+    for (auto &sizeStr: sizes) {
+        auto dimensions = sizeStr.toLower().split('x');
+        QSize size;
+
+        if (dimensions.size() == 2)
+            size = QSize(dimensions[0].toInt(), dimensions[1].toInt());
+
+        if (size.isEmpty()) {
+            qCritical() << "Invalid frame size" << sizeStr;
+
+            return 1;
+        }
+
+        if (saveReferences || checkReferences) {
+            auto outputs =
+                    benchmark.render(size,
+                                     format,
+                                     parser.value(referenceFramesOpt).toInt());
+
+            if (outputs.isEmpty()) {
+                qCritical() << benchmark.errorString();
+
+                return 1;
+            }
+
+            for (auto &effect: benchmark.effects())
+                references << QString("%1_%2x%3_%4")
+                                .arg(effect)
+                                .arg(size.width())
+                                .arg(size.height())
+                                .arg(AkVideoCaps::pixelFormatToString(format));
+
+            images << outputs;
+
+            continue;
+        }
+
+        if (parser.isSet(capsOpt)) {
+            auto run = benchmark.caps(size, format);
+
+            if (run.isEmpty()) {
+                qCritical() << benchmark.errorString();
+
+                return 1;
+            }
+
+            runs << run;
+
+            continue;
+        }
+
+        if (!conversions.isEmpty()) {
+            for (auto &conversion: conversions) {
+                auto run =
+                        benchmark.convert(size,
+                                          format,
+                                          conversion.second.isEmpty()?
+                                              size: conversion.second,
+                                          conversion.first);
+
+                if (run.isEmpty()) {
+                    qCritical() << benchmark.errorString();
+
+                    return 1;
+                }
+
+                runs << run;
+            }
+
+            continue;
+        }
+
+        auto run = benchmark.run(size, format);
+
+        if (run.isEmpty()) {
+            qCritical() << benchmark.errorString();
+
+            return 1;
+        }
+
+        runs << run;
+    }
+
+    if (saveReferences) {
+        References referencesDir(parser.value(saveReferencesOpt));
+
+        if (!referencesDir.save(references, images)) {
+            qCritical() << referencesDir.errorString();
+
+            return 1;
+        }
+
+        return 0;
+    }
+
+    QJsonObject report {
+        {"version"             , COMMONS_VERSION},
+        {"system"              , QSysInfo::prettyProductName()},
+        {"architecture"        , QSysInfo::currentCpuArchitecture()},
+        {"input"               , parser.isSet(inputOpt)?
+                                     parser.value(inputOpt):
+                                     QString("synthetic")},
+        {"countsAllocations"   , MemoryStats::canCountAllocations()},
+        {"threads"             , AkWorkerPool::globalInstance()->maxThreads()},
+    };
+
+    bool passed = true;
+
+    if (checkReferences) {
+        References referencesDir(parser.value(checkReferencesOpt));
+        auto check = referencesDir.check(references,
+                                         images,
+                                         parser.value(toleranceOpt).toInt());
+        passed = check["passed"].toBool();
+        report["references"] = check;
+    } else {
+        report["runs"] = runs;
+        report["workerPool"] =
+                QJsonObject::fromVariantMap(AkWorkerPool::globalInstance()->statistics());
+    }
+
+    auto json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOpt)) {
+        QFile file(parser.value(outputOpt));
+
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCritical() << "Can't write" << parser.value(outputOpt);
+
+            return 1;
+        }
+
+        file.write(json);
+    } else {
+        out << json;
+    }
+
+    return passed? 0: 1;
+}
@@ -0,0 +1,111 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <atomic>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+#include "memorystats.h"
+
+/* Heap allocations are counted by interposing the C allocator. The
+ * executable symbols take precedence over the ones in libc, so every
+ * allocation made by the library, the plugins and Qt itself goes through
+ * here, including the ones made by operator new.
+ */
+#ifdef __GLIBC__
+#include <cstdlib>
+
+static std::atomic<quint64> memoryStatsAllocations(0);
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t nmemb, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void __libc_free(void *ptr);
+
+    void *malloc(size_t size) __THROW
+    {
+        memoryStatsAllocations++;
+
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t nmemb, size_t size) __THROW
+    {
+        memoryStatsAllocations++;
+
+        return __libc_calloc(nmemb, size);
+    }
+
+    void *realloc(void *ptr, size_t size) __THROW
+    {
+        // Growing a buffer in place is not a new allocation.
+        if (!ptr)
+            memoryStatsAllocations++;
+
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void *ptr) __THROW
+    {
+        __libc_free(ptr);
+    }
+}
+#endif
+
+bool MemoryStats::canCountAllocations()
+{
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 MemoryStats::allocations()
+{
+#ifdef __GLIBC__
+    return memoryStatsAllocations;
+#else
+    return 0;
+#endif
+}
+
+qint64 MemoryStats::residentSetSize()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+
+    if (!statm.open(QIODevice::ReadOnly))
+        return -1;
+
+    auto fields = statm.readAll().split(' ');
+
+    if (fields.size() < 2)
+        return -1;
+
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
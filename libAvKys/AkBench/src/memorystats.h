@@ -0,0 +1,37 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <QtGlobal>
+
+namespace MemoryStats
+{
+    // Returns true if the heap allocations can be counted in this platform.
+    bool canCountAllocations();
+
+    // Number of heap allocations made by the whole process so far.
+    quint64 allocations();
+
+    // Resident set size of the process in bytes, or -1 if unknown.
+    qint64 residentSetSize();
+}
+
+#endif // MEMORYSTATS_H
@@ -0,0 +1,147 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include "references.h"
+
+References::References(const QString &path):
+    m_path(path)
+{
+}
+
+QString References::errorString() const
+{
+    return this->m_errorString;
+}
+
+bool References::save(const QStringList &effects, const QList<QImage> &images)
+{
+    if (!QDir().mkpath(this->m_path)) {
+        this->m_errorString = QString("Can't create '%1'").arg(this->m_path);
+
+        return false;
+    }
+
+    for (int i = 0; i < effects.size() && i < images.size(); i++) {
+        auto fileName = this->fileName(effects[i]);
+
+        if (images[i].isNull() || !images[i].save(fileName, "PNG")) {
+            this->m_errorString = QString("Can't write '%1'").arg(fileName);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QJsonObject References::check(const QStringList &effects,
+                              const QList<QImage> &images,
+                              int defaultTolerance)
+{
+    QVariantMap tolerances;
+    QFile tolerancesFile(QDir(this->m_path).filePath("tolerances.json"));
+
+    if (tolerancesFile.open(QIODevice::ReadOnly))
+        tolerances =
+                QJsonDocument::fromJson(tolerancesFile.readAll()).toVariant().toMap();
+
+    QJsonArray results;
+    bool passed = true;
+
+    for (int i = 0; i < effects.size() && i < images.size(); i++) {
+        auto fileName = this->fileName(effects[i]);
+        auto name = QFileInfo(fileName).completeBaseName();
+        int tolerance = tolerances.value(name, defaultTolerance).toInt();
+        QImage reference(fileName);
+        reference = reference.convertToFormat(QImage::Format_ARGB32);
+        auto &image = images[i];
+        QJsonObject result {
+            {"effect"   , effects[i]},
+            {"reference", fileName},
+            {"tolerance", tolerance}
+        };
+
+        if (reference.isNull()) {
+            result["error"] = "Missing reference";
+        } else if (image.isNull()) {
+            result["error"] = "The effect didn't output any frame";
+        } else if (reference.size() != image.size()) {
+            result["error"] = "Size mismatch";
+        } else {
+            int maxDiff = 0;
+            quint64 totalDiff = 0;
+            quint64 mismatches = 0;
+
+            for (int y = 0; y < image.height(); y++) {
+                auto imageLine =
+                        reinterpret_cast<const QRgb *>(image.constScanLine(y));
+                auto referenceLine =
+                        reinterpret_cast<const QRgb *>(reference.constScanLine(y));
+
+                for (int x = 0; x < image.width(); x++) {
+                    QRgb a = imageLine[x];
+                    QRgb b = referenceLine[x];
+                    int diff = qMax(qMax(qAbs(qRed(a) - qRed(b)),
+                                         qAbs(qGreen(a) - qGreen(b))),
+                                    qMax(qAbs(qBlue(a) - qBlue(b)),
+                                         qAbs(qAlpha(a) - qAlpha(b))));
+                    maxDiff = qMax(maxDiff, diff);
+                    totalDiff += quint64(diff);
+
+                    if (diff > tolerance)
+                        mismatches++;
+                }
+            }
+
+            qreal pixels = qreal(image.width()) * image.height();
+            result["maxDiff"] = maxDiff;
+            result["meanDiff"] = totalDiff / pixels;
+            result["mismatches"] = qreal(mismatches);
+        }
+
+        bool ok = !result.contains("error")
+                  && result["maxDiff"].toInt() <= tolerance;
+        result["passed"] = ok;
+        passed &= ok;
+        results << result;
+    }
+
+    return QJsonObject {
+        {"path"   , this->m_path},
+        {"passed" , passed},
+        {"results", results}
+    };
+}
+
+QString References::fileName(const QString &effect) const
+{
+    QString name;
+
+    for (auto &c: effect)
+        name += c.isLetterOrNumber()
+                || c == '=' || c == '.' || c == '-'? c: QChar('_');
+
+    return QDir(this->m_path).filePath(name + ".png");
+}
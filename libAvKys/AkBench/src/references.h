@@ -0,0 +1,52 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef REFERENCES_H
+#define REFERENCES_H
+
+#include <QImage>
+#include <QJsonObject>
+
+/* Stores the output of the effects as reference images, and checks later
+ * outputs against them.
+ *
+ * The references are PNG files named after the effect description. A
+ * tolerances.json file in the same directory can map any of those names to
+ * the maximum per channel difference allowed for it, otherwise the default
+ * tolerance is used.
+ */
+class References
+{
+    public:
+        explicit References(const QString &path);
+
+        QString errorString() const;
+        bool save(const QStringList &effects, const QList<QImage> &images);
+        QJsonObject check(const QStringList &effects,
+                          const QList<QImage> &images,
+                          int defaultTolerance);
+
+    private:
+        QString m_path;
+        QString m_errorString;
+
+        QString fileName(const QString &effect) const;
+};
+
+#endif // REFERENCES_H
@@ -22,12 +22,14 @@
 #include "akqmlplugin.h"
 #include "akqml.h"
 #include "akelement.h"
+#include "akelementstats.h"
 
 void AkQmlPlugin::registerTypes(const char *uri)
 {
     // @uri AkQml
     qmlRegisterSingletonType<AkQml>(uri, 1, 0, "Ak", &AkQmlPlugin::akProvider);
     qmlRegisterType<AkElement>(uri, 1, 0, "AkElement");
+    qmlRegisterType<AkElementStats>(uri, 1, 0, "AkElementStats");
 }
 
 QObject *AkQmlPlugin::akProvider(QQmlEngine *qmlEngine, QJSEngine *jsEngine)
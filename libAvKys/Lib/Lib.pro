@@ -38,16 +38,28 @@ HEADERS = \
     src/ak.h \
     src/akutils.h \
     src/akcaps.h \
+    src/akcapsvalue.h \
+    src/akcolorlut.h \
     src/akcommons.h \
     src/akelement.h \
     src/akfrac.h \
     src/akpacket.h \
+    src/akpacketpool.h \
+    src/akpixel.h \
     src/akplugin.h \
+    src/akremap.h \
     src/akmultimediasourceelement.h \
     src/akvideocaps.h \
+    src/akvideoconverter.h \
+    src/akvideobufferpool.h \
     src/akaudiocaps.h \
     src/akvideopacket.h \
-    src/akaudiopacket.h
+    src/akaudiopacket.h \
+    src/akworkerpool.h \
+    src/akpacketqueue.h \
+    src/aklatencybudget.h \
+    src/akelementstats.h \
+    src/aktrace.h
 
 QT += qml
 
@@ -55,15 +67,25 @@ SOURCES = \
     src/ak.cpp \
     src/akutils.cpp \
     src/akcaps.cpp \
+    src/akcapsvalue.cpp \
+    src/akcolorlut.cpp \
     src/akelement.cpp \
     src/akfrac.cpp \
     src/akpacket.cpp \
     src/akplugin.cpp \
+    src/akremap.cpp \
     src/akmultimediasourceelement.cpp \
     src/akvideocaps.cpp \
+    src/akvideoconverter.cpp \
+    src/akvideobufferpool.cpp \
     src/akaudiocaps.cpp \
     src/akvideopacket.cpp \
-    src/akaudiopacket.cpp
+    src/akaudiopacket.cpp \
+    src/akworkerpool.cpp \
+    src/akpacketqueue.cpp \
+    src/aklatencybudget.cpp \
+    src/akelementstats.cpp \
+    src/aktrace.cpp
 
 win32: LIBS += -lole32
 
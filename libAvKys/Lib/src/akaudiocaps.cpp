@@ -209,6 +209,31 @@ class AkAudioCapsPrivate
         int m_samples;
         bool m_align;
         bool m_isValid;
+
+        // Fields layout of the caps value.
+        enum ValueField
+        {
+            ValueFieldFormat,
+            ValueFieldBps,
+            ValueFieldChannels,
+            ValueFieldRate,
+            ValueFieldLayout,
+            ValueFieldSamples,
+            ValueFieldAlign
+        };
+
+        inline void fromValue(const AkCapsValue &value)
+        {
+            this->m_format =
+                    AkAudioCaps::SampleFormat(value.field(ValueFieldFormat));
+            this->m_bps = int(value.field(ValueFieldBps));
+            this->m_channels = int(value.field(ValueFieldChannels));
+            this->m_rate = int(value.field(ValueFieldRate));
+            this->m_layout =
+                    AkAudioCaps::ChannelLayout(value.field(ValueFieldLayout));
+            this->m_samples = int(value.field(ValueFieldSamples));
+            this->m_align = value.field(ValueFieldAlign) != 0;
+        }
 };
 
 AkAudioCaps::AkAudioCaps(QObject *parent):
@@ -256,7 +281,10 @@ AkAudioCaps::AkAudioCaps(const AkCaps &caps)
 {
     this->d = new AkAudioCapsPrivate();
 
-    if (caps.mimeType() == "audio/x-raw") {
+    if (caps.cachedValue().type() == AkCapsValue::ValueTypeAudio) {
+        this->d->m_isValid = caps.isValid();
+        this->d->fromValue(caps.cachedValue());
+    } else if (caps.mimeType() == "audio/x-raw") {
         this->d->m_isValid = caps.isValid();
 
         this->d->m_format = this->sampleFormatFromString(caps.property("format").toString());
@@ -333,7 +361,10 @@ AkAudioCaps &AkAudioCaps::operator =(const AkAudioCaps &other)
 
 AkAudioCaps &AkAudioCaps::operator =(const AkCaps &caps)
 {
-    if (caps.mimeType() == "audio/x-raw") {
+    if (caps.cachedValue().type() == AkCapsValue::ValueTypeAudio) {
+        this->d->m_isValid = caps.isValid();
+        this->d->fromValue(caps.cachedValue());
+    } else if (caps.mimeType() == "audio/x-raw") {
         this->d->m_isValid = caps.isValid();
 
         this->d->m_format = this->sampleFormatFromString(caps.property("format").toString());
@@ -561,7 +592,40 @@ AkAudioCaps &AkAudioCaps::update(const AkCaps &caps)
 
 AkCaps AkAudioCaps::toCaps() const
 {
-    return AkCaps(this->toString());
+    if (!this->d->m_isValid)
+        return AkCaps();
+
+    // Build the caps directly, parsing back the caps string is too slow for
+    // being done on every buffer.
+    QString layout = ChannelLayouts::byLayout(this->d->m_layout)->description;
+
+    AkCaps caps;
+    caps.setMimeType("audio/x-raw");
+    caps.setProperty("format", this->sampleFormatToString(this->d->m_format));
+    caps.setProperty("bps", QString::number(this->d->m_bps));
+    caps.setProperty("channels", QString::number(this->d->m_channels));
+    caps.setProperty("rate", QString::number(this->d->m_rate));
+    caps.setProperty("layout", layout);
+    caps.setProperty("samples", QString::number(this->d->m_samples));
+    caps.setProperty("align", QString::number(this->d->m_align));
+    caps.setValue(this->value());
+
+    return caps;
+}
+
+AkCapsValue AkAudioCaps::value() const
+{
+    if (!this->d->m_isValid)
+        return AkCapsValue();
+
+    return AkCapsValue(AkCapsValue::ValueTypeAudio,
+                       {this->d->m_format,
+                        this->d->m_bps,
+                        this->d->m_channels,
+                        this->d->m_rate,
+                        this->d->m_layout,
+                        this->d->m_samples,
+                        this->d->m_align});
 }
 
 int AkAudioCaps::bitsPerSample(AkAudioCaps::SampleFormat sampleFormat)
@@ -576,9 +640,8 @@ int AkAudioCaps::bitsPerSample(const QString &sampleFormat)
 
 QString AkAudioCaps::sampleFormatToString(AkAudioCaps::SampleFormat sampleFormat)
 {
-    AkAudioCaps caps;
-    int formatIndex = caps.metaObject()->indexOfEnumerator("SampleFormat");
-    QMetaEnum formatEnum = caps.metaObject()->enumerator(formatIndex);
+    int formatIndex = AkAudioCaps::staticMetaObject.indexOfEnumerator("SampleFormat");
+    QMetaEnum formatEnum = AkAudioCaps::staticMetaObject.enumerator(formatIndex);
     QString format(formatEnum.valueToKey(sampleFormat));
     format.remove("SampleFormat_");
 
@@ -587,10 +650,9 @@ QString AkAudioCaps::sampleFormatToString(AkAudioCaps::SampleFormat sampleFormat
 
 AkAudioCaps::SampleFormat AkAudioCaps::sampleFormatFromString(const QString &sampleFormat)
 {
-    AkAudioCaps caps;
     QString format = "SampleFormat_" + sampleFormat;
-    int formatIndex = caps.metaObject()->indexOfEnumerator("SampleFormat");
-    QMetaEnum formatEnum = caps.metaObject()->enumerator(formatIndex);
+    int formatIndex = AkAudioCaps::staticMetaObject.indexOfEnumerator("SampleFormat");
+    QMetaEnum formatEnum = AkAudioCaps::staticMetaObject.enumerator(formatIndex);
     int formatInt = formatEnum.keyToValue(format.toStdString().c_str());
 
     return static_cast<SampleFormat>(formatInt);
@@ -809,6 +871,11 @@ void AkAudioCaps::resetAlign()
     this->setAlign(false);
 }
 
+uint qHash(const AkAudioCaps &caps, uint seed)
+{
+    return qHash(caps.value(), seed);
+}
+
 QDebug operator <<(QDebug debug, const AkAudioCaps &caps)
 {
     debug.nospace() << caps.toString();
@@ -22,7 +22,7 @@
 
 #include <QObject>
 
-#include "akcommons.h"
+#include "akcapsvalue.h"
 
 class AkAudioCapsPrivate;
 class AkCaps;
@@ -236,6 +236,7 @@ class AKCOMMONS_EXPORT AkAudioCaps: public QObject
         Q_INVOKABLE QString toString() const;
         Q_INVOKABLE AkAudioCaps &update(const AkCaps &caps);
         Q_INVOKABLE AkCaps toCaps() const;
+        AkCapsValue value() const;
 
         Q_INVOKABLE static int bitsPerSample(SampleFormat sampleFormat);
         Q_INVOKABLE static int bitsPerSample(const QString &sampleFormat);
@@ -301,6 +302,7 @@ class AKCOMMONS_EXPORT AkAudioCaps: public QObject
         friend QDataStream &operator <<(QDataStream &ostream, const AkAudioCaps &caps);
 };
 
+AKCOMMONS_EXPORT uint qHash(const AkAudioCaps &caps, uint seed=0);
 QDebug operator <<(QDebug debug, const AkAudioCaps &caps);
 QDataStream &operator >>(QDataStream &istream, AkAudioCaps &caps);
 QDataStream &operator <<(QDataStream &ostream, const AkAudioCaps &caps);
@@ -21,17 +21,20 @@
 #include <QVariant>
 
 #include "akaudiopacket.h"
+#include "akpacketpool.h"
 #include "akaudiocaps.h"
 #include "akcaps.h"
 
-class AkAudioPacketPrivate
+class AkAudioPacketPrivate: public QSharedData
 {
     public:
         AkAudioCaps m_caps;
+
+        AK_PACKET_POOL_ALLOCATED(AkAudioPacketPrivate)
 };
 
-AkAudioPacket::AkAudioPacket(QObject *parent):
-    AkPacket(parent)
+AkAudioPacket::AkAudioPacket():
+    AkPacket()
 {
     this->d = new AkAudioPacketPrivate();
 }
@@ -52,45 +55,27 @@ AkAudioPacket::AkAudioPacket(const AkAudioCaps &caps,
     this->id() = id;
 }
 
-AkAudioPacket::AkAudioPacket(const AkPacket &other)
+AkAudioPacket::AkAudioPacket(const AkPacket &other):
+    AkPacket(other)
 {
     this->d = new AkAudioPacketPrivate();
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
 }
 
 AkAudioPacket::AkAudioPacket(const AkAudioPacket &other):
-    AkPacket()
+    AkPacket(other),
+    d(other.d)
 {
-    this->d = new AkAudioPacketPrivate();
-    this->d->m_caps = other.d->m_caps;
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
 }
 
 AkAudioPacket::~AkAudioPacket()
 {
-    delete this->d;
 }
 
 AkAudioPacket &AkAudioPacket::operator =(const AkPacket &other)
 {
+    AkPacket::operator =(other);
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
 
     return *this;
 }
@@ -98,13 +83,8 @@ AkAudioPacket &AkAudioPacket::operator =(const AkPacket &other)
 AkAudioPacket &AkAudioPacket::operator =(const AkAudioPacket &other)
 {
     if (this != &other) {
-        this->d->m_caps = other.d->m_caps;
-        this->data() = other.data();
-        this->buffer() = other.buffer();
-        this->pts() = other.pts();
-        this->timeBase() = other.timeBase();
-        this->index() = other.index();
-        this->id() = other.id();
+        AkPacket::operator =(other);
+        this->d = other.d;
     }
 
     return *this;
@@ -177,11 +157,7 @@ AkPacket AkAudioPacket::toPacket() const
 
 void AkAudioPacket::setCaps(const AkAudioCaps &caps)
 {
-    if (this->d->m_caps == caps)
-        return;
-
     this->d->m_caps = caps;
-    emit this->capsChanged(caps);
 }
 
 void AkAudioPacket::resetCaps()
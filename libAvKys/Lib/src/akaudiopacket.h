@@ -27,15 +27,14 @@ class AkAudioCaps;
 
 class AKCOMMONS_EXPORT AkAudioPacket: public AkPacket
 {
-    Q_OBJECT
+    Q_GADGET
     Q_PROPERTY(AkAudioCaps caps
                READ caps
                WRITE setCaps
-               RESET resetCaps
-               NOTIFY capsChanged)
+               RESET resetCaps)
 
     public:
-        explicit AkAudioPacket(QObject *parent=nullptr);
+        AkAudioPacket();
         AkAudioPacket(const AkAudioCaps &caps,
                       const QByteArray &buffer=QByteArray(),
                       qint64 pts=0,
@@ -55,17 +54,13 @@ class AKCOMMONS_EXPORT AkAudioPacket: public AkPacket
         Q_INVOKABLE QString toString() const;
         Q_INVOKABLE AkPacket toPacket() const;
 
-    private:
-        AkAudioPacketPrivate *d;
-
-    Q_SIGNALS:
-        void capsChanged(const AkAudioCaps &caps);
+        Q_INVOKABLE void setCaps(const AkAudioCaps &caps);
+        Q_INVOKABLE void resetCaps();
 
-    public Q_SLOTS:
-        void setCaps(const AkAudioCaps &caps);
-        void resetCaps();
+    private:
+        QSharedDataPointer<AkAudioPacketPrivate> d;
 
-        friend QDebug operator <<(QDebug debug, const AkAudioPacket &packet);
+    friend QDebug operator <<(QDebug debug, const AkAudioPacket &packet);
 };
 
 QDebug operator <<(QDebug debug, const AkAudioPacket &packet);
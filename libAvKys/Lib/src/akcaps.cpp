@@ -21,14 +21,22 @@
 #include <QRegExp>
 #include <QStringList>
 #include <QVariant>
+#include <QEvent>
+#include <QHash>
 
 #include "akcaps.h"
+#include "akvideocaps.h"
+#include "akaudiocaps.h"
 
 class AkCapsPrivate
 {
     public:
         bool m_isValid;
         QString m_mimeType;
+
+        // Typed snapshot of the caps, only set while the dynamic properties
+        // hold exactly the fixed fields of the caps type.
+        AkCapsValue m_value;
 };
 
 AkCaps::AkCaps(QObject *parent): QObject(parent)
@@ -61,6 +69,7 @@ AkCaps::AkCaps(const AkCaps &other):
     this->d->m_isValid = other.d->m_isValid;
     this->d->m_mimeType = other.d->m_mimeType;
     this->update(other);
+    this->d->m_value = other.d->m_value;
 }
 
 AkCaps::~AkCaps()
@@ -75,6 +84,7 @@ AkCaps &AkCaps::operator =(const AkCaps &other)
         this->d->m_isValid = other.d->m_isValid;
         this->d->m_mimeType = other.d->m_mimeType;
         this->update(other);
+        this->d->m_value = other.d->m_value;
     }
 
     return *this;
@@ -87,6 +97,10 @@ AkCaps &AkCaps::operator =(const QString &other)
 
 bool AkCaps::operator ==(const AkCaps &other) const
 {
+    if (this->d->m_value && other.d->m_value)
+        return this->d->m_isValid == other.d->m_isValid
+               && this->d->m_value == other.d->m_value;
+
     return this->toString() == other.toString();
 }
 
@@ -127,6 +141,7 @@ QString AkCaps::mimeType() const
 
 AkCaps &AkCaps::fromMap(const QVariantMap &caps)
 {
+    this->d->m_value = AkCapsValue();
     QList<QByteArray> properties = this->dynamicPropertyNames();
 
     for (const QByteArray &property: properties)
@@ -152,6 +167,7 @@ AkCaps &AkCaps::fromMap(const QVariantMap &caps)
 
 AkCaps &AkCaps::fromString(const QString &caps)
 {
+    this->d->m_value = AkCapsValue();
     this->d->m_isValid = QRegExp("\\s*[a-z]+/\\w+(?:(?:-|\\+|\\.)\\w+)*"
                                  "(?:\\s*,\\s*[a-zA-Z_]\\w*\\s*="
                                  "\\s*[^,=]+)*\\s*").exactMatch(caps);
@@ -246,6 +262,39 @@ bool AkCaps::contains(const QString &property) const
     return this->dynamicPropertyNames().contains(property.toUtf8());
 }
 
+AkCapsValue AkCaps::value() const
+{
+    if (this->d->m_value)
+        return this->d->m_value;
+
+    if (this->d->m_mimeType == "video/x-raw")
+        return AkVideoCaps(*this).value();
+
+    if (this->d->m_mimeType == "audio/x-raw")
+        return AkAudioCaps(*this).value();
+
+    return AkCapsValue();
+}
+
+const AkCapsValue &AkCaps::cachedValue() const
+{
+    return this->d->m_value;
+}
+
+void AkCaps::setValue(const AkCapsValue &value)
+{
+    this->d->m_value = value;
+}
+
+bool AkCaps::event(QEvent *event)
+{
+    // Any change in the dynamic properties invalidates the snapshot.
+    if (event->type() == QEvent::DynamicPropertyChange)
+        this->d->m_value = AkCapsValue();
+
+    return QObject::event(event);
+}
+
 void AkCaps::setMimeType(const QString &mimeType)
 {
     this->d->m_isValid = QRegExp("\\s*[a-z]+/\\w+(?:(?:-|\\+|\\.)\\w+)*\\s*").exactMatch(mimeType);
@@ -255,6 +304,7 @@ void AkCaps::setMimeType(const QString &mimeType)
         return;
 
     this->d->m_mimeType = _mimeType;
+    this->d->m_value = AkCapsValue();
     emit this->mimeTypeChanged(this->d->m_mimeType);
 }
 
@@ -267,6 +317,7 @@ void AkCaps::clear()
 {
     this->d->m_mimeType.clear();
     this->d->m_isValid = false;
+    this->d->m_value = AkCapsValue();
 
     QList<QByteArray> properties = this->dynamicPropertyNames();
 
@@ -274,6 +325,17 @@ void AkCaps::clear()
         this->setProperty(property.constData(), QVariant());
 }
 
+uint qHash(const AkCaps &caps, uint seed)
+{
+    // Only the fixed fields are hashed, equal caps always share them.
+    auto value = caps.value();
+
+    if (value)
+        return qHash(value, seed);
+
+    return qHash(caps.toString(), seed);
+}
+
 QDebug operator <<(QDebug debug, const AkCaps &caps)
 {
     debug.nospace() << caps.toString();
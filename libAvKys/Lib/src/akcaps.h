@@ -22,7 +22,7 @@
 
 #include <QObject>
 
-#include "akcommons.h"
+#include "akcapsvalue.h"
 
 class AkCapsPrivate;
 
@@ -70,10 +70,17 @@ class AKCOMMONS_EXPORT AkCaps: public QObject
         Q_INVOKABLE AkCaps &update(const AkCaps &other);
         Q_INVOKABLE bool isCompatible(const AkCaps &other) const;
         Q_INVOKABLE bool contains(const QString &property) const;
+        AkCapsValue value() const;
 
     private:
         AkCapsPrivate *d;
 
+        const AkCapsValue &cachedValue() const;
+        void setValue(const AkCapsValue &value);
+
+    protected:
+        bool event(QEvent *event);
+
     Q_SIGNALS:
         void mimeTypeChanged(const QString &mimeType);
 
@@ -82,11 +89,15 @@ class AKCOMMONS_EXPORT AkCaps: public QObject
         virtual void resetMimeType();
         void clear();
 
+    friend class AkVideoCaps;
+    friend class AkAudioCaps;
+    friend class AkVideoBufferPool;
     friend QDebug operator <<(QDebug debug, const AkCaps &caps);
     friend QDataStream &operator >>(QDataStream &istream, AkCaps &caps);
     friend QDataStream &operator <<(QDataStream &ostream, const AkCaps &caps);
 };
 
+AKCOMMONS_EXPORT uint qHash(const AkCaps &caps, uint seed=0);
 QDebug operator <<(QDebug debug, const AkCaps &caps);
 QDataStream &operator >>(QDataStream &istream, AkCaps &caps);
 QDataStream &operator <<(QDataStream &ostream, const AkCaps &caps);
@@ -0,0 +1,95 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <cstring>
+#include <QHash>
+
+#include "akcapsvalue.h"
+
+AkCapsValue::AkCapsValue():
+    m_type(ValueTypeUnknown),
+    m_size(0),
+    m_hash(0)
+{
+    memset(this->m_fields, 0, sizeof(this->m_fields));
+}
+
+AkCapsValue::AkCapsValue(ValueType type, std::initializer_list<qint64> fields):
+    m_type(type),
+    m_size(qMin(int(fields.size()), int(MaxFields))),
+    m_hash(0)
+{
+    memset(this->m_fields, 0, sizeof(this->m_fields));
+    int i = 0;
+
+    for (auto field: fields) {
+        if (i >= this->m_size)
+            break;
+
+        this->m_fields[i++] = field;
+    }
+
+    this->m_hash = qHash(int(type));
+
+    for (i = 0; i < this->m_size; i++)
+        this->m_hash = 31 * this->m_hash + qHash(this->m_fields[i]);
+}
+
+bool AkCapsValue::operator ==(const AkCapsValue &other) const
+{
+    return this->m_hash == other.m_hash
+        && this->m_type == other.m_type
+        && this->m_size == other.m_size
+        && memcmp(this->m_fields,
+                  other.m_fields,
+                  size_t(this->m_size) * sizeof(qint64)) == 0;
+}
+
+bool AkCapsValue::operator !=(const AkCapsValue &other) const
+{
+    return !(*this == other);
+}
+
+AkCapsValue::operator bool() const
+{
+    return this->m_type != ValueTypeUnknown;
+}
+
+AkCapsValue::ValueType AkCapsValue::type() const
+{
+    return this->m_type;
+}
+
+int AkCapsValue::size() const
+{
+    return this->m_size;
+}
+
+qint64 AkCapsValue::field(int index) const
+{
+    if (index < 0 || index >= this->m_size)
+        return 0;
+
+    return this->m_fields[index];
+}
+
+uint AkCapsValue::hash() const
+{
+    return this->m_hash;
+}
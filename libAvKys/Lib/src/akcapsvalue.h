@@ -0,0 +1,72 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKCAPSVALUE_H
+#define AKCAPSVALUE_H
+
+#include <initializer_list>
+
+#include "akcommons.h"
+
+/* Plain value representation of a caps.
+ *
+ * It only holds the caps type and a fixed list of numeric fields, which
+ * meaning depends on the caps type (see AkVideoCaps and AkAudioCaps). The
+ * hash is computed on construction, so comparing and hashing are constant
+ * time operations, and copying it never allocates.
+ */
+class AKCOMMONS_EXPORT AkCapsValue
+{
+    public:
+        enum ValueType
+        {
+            ValueTypeUnknown = -1,
+            ValueTypeAudio,
+            ValueTypeVideo
+        };
+
+        enum
+        {
+            MaxFields = 16
+        };
+
+        AkCapsValue();
+        AkCapsValue(ValueType type, std::initializer_list<qint64> fields);
+        bool operator ==(const AkCapsValue &other) const;
+        bool operator !=(const AkCapsValue &other) const;
+        operator bool() const;
+
+        ValueType type() const;
+        int size() const;
+        qint64 field(int index) const;
+        uint hash() const;
+
+    private:
+        ValueType m_type;
+        int m_size;
+        qint64 m_fields[MaxFields];
+        uint m_hash;
+};
+
+inline uint qHash(const AkCapsValue &value, uint seed=0)
+{
+    return value.hash() ^ seed;
+}
+
+#endif // AKCAPSVALUE_H
@@ -0,0 +1,235 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QVector>
+
+#include "akcolorlut.h"
+#include "akpixel.h"
+
+class AkColorLutPrivate
+{
+    public:
+        int m_size;
+
+        // Lattice colors as 0x00RRGGBB, indexed by (r * size + g) * size + b.
+        QVector<quint32> m_table;
+
+        /* Cells evaluated through m_func, indexed as the table but with
+         * size - 1 cells per side. Empty if all cells are interpolated.
+         */
+        QVector<quint8> m_exact;
+        AkColorLut::ColorFunc m_func;
+
+        // Lower lattice point and 8 bits interpolation weight of each level.
+        int m_index[256];
+        int m_weight[256];
+
+        AkColorLutPrivate(int size):
+            m_size(qMax(2, size))
+        {
+            for (int v = 0; v < 256; v++) {
+                int pos = (v * (this->m_size - 1) << 8) / 255;
+                this->m_index[v] = qMin(pos >> 8, this->m_size - 2);
+                this->m_weight[v] = pos - (this->m_index[v] << 8);
+            }
+        }
+
+        inline static int level(int i, int size);
+        inline QRgb map(QRgb color) const;
+};
+
+AkColorLut::AkColorLut(int size)
+{
+    this->d = new AkColorLutPrivate(size);
+}
+
+AkColorLut::~AkColorLut()
+{
+    delete this->d;
+}
+
+int AkColorLut::size() const
+{
+    return this->d->m_size;
+}
+
+bool AkColorLut::isEmpty() const
+{
+    return this->d->m_table.isEmpty();
+}
+
+void AkColorLut::build(const ColorFunc &func,
+                       bool threaded,
+                       const CellFunc &exactCell)
+{
+    int size = this->d->m_size;
+    this->d->m_table.resize(size * size * size);
+    auto table = this->d->m_table.data();
+
+    // Each red slice of the lattice is independent from the others.
+    AkPixelKernel<>::forEachBand(size, [&] (int first, int last) {
+        for (int r = first; r < last; r++) {
+            int red = AkColorLutPrivate::level(r, size);
+
+            for (int g = 0; g < size; g++) {
+                int green = AkColorLutPrivate::level(g, size);
+                auto entry = table + (r * size + g) * size;
+
+                for (int b = 0; b < size; b++) {
+                    int blue = AkColorLutPrivate::level(b, size);
+                    entry[b] = func(red, green, blue) & RGB_MASK;
+                }
+            }
+        }
+    }, threaded, "AkColorLut");
+
+    this->d->m_exact.clear();
+    this->d->m_func = nullptr;
+
+    if (!exactCell)
+        return;
+
+    int cells = size - 1;
+    this->d->m_exact.resize(cells * cells * cells);
+    auto exact = this->d->m_exact.data();
+
+    AkPixelKernel<>::forEachBand(cells, [&] (int first, int last) {
+        for (int r = first; r < last; r++) {
+            int red0 = AkColorLutPrivate::level(r, size);
+            int red1 = AkColorLutPrivate::level(r + 1, size);
+
+            for (int g = 0; g < cells; g++) {
+                int green0 = AkColorLutPrivate::level(g, size);
+                int green1 = AkColorLutPrivate::level(g + 1, size);
+                auto entry = exact + (r * cells + g) * cells;
+
+                for (int b = 0; b < cells; b++) {
+                    int blue0 = AkColorLutPrivate::level(b, size);
+                    int blue1 = AkColorLutPrivate::level(b + 1, size);
+                    entry[b] = exactCell(qRgb(red0, green0, blue0),
+                                         qRgb(red1, green1, blue1));
+                }
+            }
+        }
+    }, threaded, "AkColorLut");
+
+    this->d->m_func = func;
+}
+
+void AkColorLut::clear()
+{
+    this->d->m_table.clear();
+    this->d->m_exact.clear();
+    this->d->m_func = nullptr;
+}
+
+QRgb AkColorLut::map(QRgb color) const
+{
+    if (this->d->m_table.isEmpty())
+        return color;
+
+    return this->d->map(color);
+}
+
+void AkColorLut::apply(const QImage &src,
+                       QImage &dst,
+                       bool threaded,
+                       const char *tag) const
+{
+    if (this->d->m_table.isEmpty()) {
+        dst = src.copy();
+
+        return;
+    }
+
+    int width = src.width();
+
+    AkPixelKernel<>::forEachLine(src, dst, [this, width] (int y,
+                                                         const QRgb *srcLine,
+                                                         QRgb *dstLine) {
+        Q_UNUSED(y)
+
+        for (int x = 0; x < width; x++)
+            dstLine[x] = this->d->map(srcLine[x]);
+    }, threaded, tag? tag: "AkColorLut");
+}
+
+int AkColorLutPrivate::level(int i, int size)
+{
+    return (i * 255 + (size - 1) / 2) / (size - 1);
+}
+
+QRgb AkColorLutPrivate::map(QRgb color) const
+{
+    int r = qRed(color);
+    int g = qGreen(color);
+    int b = qBlue(color);
+
+    int ri = this->m_index[r];
+    int gi = this->m_index[g];
+    int bi = this->m_index[b];
+    int size = this->m_size;
+
+    if (!this->m_exact.isEmpty()) {
+        int cells = size - 1;
+
+        if (this->m_exact[(ri * cells + gi) * cells + bi])
+            return (this->m_func(r, g, b) & RGB_MASK) | (color & ~RGB_MASK);
+    }
+
+    int rw = this->m_weight[r];
+    int gw = this->m_weight[g];
+    int bw = this->m_weight[b];
+
+    auto cell = this->m_table.constData() + (ri * size + gi) * size + bi;
+    const quint32 *corners[8] = {
+        cell,
+        cell + 1,
+        cell + size,
+        cell + size + 1,
+        cell + size * size,
+        cell + size * size + 1,
+        cell + size * size + size,
+        cell + size * size + size + 1,
+    };
+
+    // Interpolate along blue, then green, then red.
+    int channels[3];
+
+    for (int c = 0; c < 3; c++) {
+        int shift = 16 - 8 * c;
+        int v[8];
+
+        for (int i = 0; i < 8; i++)
+            v[i] = int(*corners[i] >> shift) & 0xff;
+
+        int v00 = (v[0] << 8) + (v[1] - v[0]) * bw;
+        int v01 = (v[2] << 8) + (v[3] - v[2]) * bw;
+        int v10 = (v[4] << 8) + (v[5] - v[4]) * bw;
+        int v11 = (v[6] << 8) + (v[7] - v[6]) * bw;
+
+        int v0 = (v00 << 8) + (v01 - v00) * gw;
+        int v1 = (v10 << 8) + (v11 - v10) * gw;
+
+        // v0 and v1 are scaled by 2^16, the result by 2^24.
+        channels[c] = int(((qint64(v0) << 8) + qint64(v1 - v0) * rw + (1 << 23)) >> 24);
+    }
+
+    return qRgba(channels[0], channels[1], channels[2], qAlpha(color));
+}
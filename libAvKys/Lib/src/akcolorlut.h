@@ -0,0 +1,72 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKCOLORLUT_H
+#define AKCOLORLUT_H
+
+#include <functional>
+#include <QImage>
+
+#include "akcommons.h"
+
+class AkColorLutPrivate;
+
+/* 3D color lookup table.
+ *
+ * build() samples a color transform on a size³ lattice of the RGB cube,
+ * apply() maps each pixel by trilinear interpolation of the 8 lattice points
+ * around it, in fixed point. This turns any per-pixel color transform, no
+ * matter how expensive, into a few table lookups per pixel. The alpha is
+ * always copied from the source.
+ *
+ * Interpolating is only right where the transform is continuous. A cell of
+ * the lattice, given by its lower and upper corner colors, for which the
+ * optional exactCell function returns true is not interpolated, apply() calls
+ * func for the pixels inside it instead.
+ */
+class AKCOMMONS_EXPORT AkColorLut
+{
+    Q_DISABLE_COPY(AkColorLut)
+
+    public:
+        typedef std::function<QRgb (int r, int g, int b)> ColorFunc;
+        typedef std::function<bool (QRgb lower, QRgb upper)> CellFunc;
+
+        AkColorLut(int size=33);
+        ~AkColorLut();
+
+        int size() const;
+        bool isEmpty() const;
+        void build(const ColorFunc &func,
+                   bool threaded=true,
+                   const CellFunc &exactCell=CellFunc());
+        void clear();
+        QRgb map(QRgb color) const;
+
+        // src and dst must be QImage::Format_ARGB32 frames of the same size.
+        void apply(const QImage &src,
+                   QImage &dst,
+                   bool threaded=true,
+                   const char *tag=nullptr) const;
+
+    private:
+        AkColorLutPrivate *d;
+};
+
+#endif // AKCOLORLUT_H
@@ -31,6 +31,9 @@
 #include <QQmlContext>
 #include <QQmlComponent>
 #include <QDebug>
+#include <QMap>
+#include <QMutex>
+#include <QElapsedTimer>
 
 #include "akelement.h"
 #include "akplugin.h"
@@ -38,9 +41,16 @@
 #include "akpacket.h"
 #include "akaudiopacket.h"
 #include "akvideopacket.h"
+#include "aktrace.h"
 
 #define SUBMODULES_PATH "submodules"
 
+// Buckets of the processing time histogram, from 1 us to 8 s.
+#define STATS_BUCKETS 24
+
+// Time spent by the elements called from the current one, per thread.
+static thread_local quint64 akElementChildrenTime = 0;
+
 class AkPluginInfoPrivate
 {
     public:
@@ -50,6 +60,74 @@ class AkPluginInfoPrivate
         bool m_used;
 };
 
+struct AkLinkQueue
+{
+    QSharedPointer<AkPacketQueue> queue;
+    QMetaObject::Connection input;
+    QMetaObject::Connection srcDestroyed;
+    QMetaObject::Connection dstDestroyed;
+};
+
+// Processing statistics of an element, all times are in nanoseconds.
+class AkElementCounters
+{
+    public:
+        QAtomicInteger<quint64> m_packetsIn;
+        QAtomicInteger<quint64> m_packetsOut;
+        QAtomicInteger<quint64> m_processingTime;
+        QAtomicInteger<quint64> m_maxProcessingTime;
+        QAtomicInteger<quint64> m_histogram[STATS_BUCKETS];
+
+        AkElementCounters()
+        {
+            this->reset();
+        }
+
+        inline void addSample(quint64 time)
+        {
+            this->m_packetsIn.fetchAndAddRelaxed(1);
+            this->m_processingTime.fetchAndAddRelaxed(time);
+            quint64 maxTime = this->m_maxProcessingTime.load();
+
+            while (time > maxTime
+                   && !this->m_maxProcessingTime.testAndSetRelaxed(maxTime, time))
+                maxTime = this->m_maxProcessingTime.load();
+
+            int bucket = 0;
+
+            for (quint64 us = time / 1000; us > 1 && bucket < STATS_BUCKETS - 1; us >>= 1)
+                bucket++;
+
+            this->m_histogram[bucket].fetchAndAddRelaxed(1);
+        }
+
+        inline void reset()
+        {
+            this->m_packetsIn.store(0);
+            this->m_packetsOut.store(0);
+            this->m_processingTime.store(0);
+            this->m_maxProcessingTime.store(0);
+
+            for (auto &bucket: this->m_histogram)
+                bucket.store(0);
+        }
+};
+
+// Process wide list of the live elements and of the queued links.
+class AkElementRegistry
+{
+    public:
+        // Queues of the queued links, by source and destination.
+        QMap<QPair<const QObject *, const QObject *>, AkLinkQueue> m_linkQueues;
+        QMutex m_linkQueuesMutex;
+
+        // Live elements, for collecting the statistics.
+        QList<AkElement *> m_elements;
+        QMutex m_elementsMutex;
+};
+
+Q_GLOBAL_STATIC(AkElementRegistry, akElementRegistry)
+
 class AkElementPrivate
 {
     public:
@@ -66,8 +144,12 @@ class AkElementPrivate
         bool m_recursiveSearchPaths;
         bool m_pluginsScanned;
 
+        // Only allocated for the elements, not for the global instance.
+        AkElementCounters *m_counters;
+
         AkElementPrivate()
         {
+            this->m_counters = nullptr;
             this->m_recursiveSearchPaths = false;
             this->m_pluginsScanned = false;
 
@@ -126,6 +208,25 @@ class AkElementPrivate
             return methods;
         }
 
+        // Dropped and waiting packets of the queues feeding the element.
+        static inline void queuedPackets(const QObject *element,
+                                         quint64 *dropped,
+                                         int *size);
+
+        // Packets are sent to the elements through the timed slot.
+        static inline QMetaMethod inputSlot(const QObject *element,
+                                            const QMetaMethod &slot)
+        {
+            if (!qobject_cast<const AkElement *>(element)
+                || slot.methodSignature() != "iStream(AkPacket)")
+                return slot;
+
+            auto index =
+                    AkElement::staticMetaObject.indexOfSlot("processPacket(AkPacket)");
+
+            return AkElement::staticMetaObject.method(index);
+        }
+
         static inline bool methodCompat(const QMetaMethod &method1,
                                         const QMetaMethod &method2)
         {
@@ -268,16 +369,53 @@ class AkElementPrivate
 
 Q_GLOBAL_STATIC(AkElementPrivate, akElementGlobalStuff)
 
+void AkElementPrivate::queuedPackets(const QObject *element,
+                                     quint64 *dropped,
+                                     int *size)
+{
+    AkElementRegistry *registry = akElementRegistry;
+    QMutexLocker mutexLocker(&registry->m_linkQueuesMutex);
+
+    for (auto it = registry->m_linkQueues.cbegin();
+         it != registry->m_linkQueues.cend();
+         it++)
+        if (it.key().second == element) {
+            *dropped += it->queue->dropped();
+            *size += it->queue->size();
+        }
+}
+
 AkElement::AkElement(QObject *parent):
     QObject(parent)
 {
     this->d = new AkElementPrivate();
     this->d->m_state = ElementStateNull;
+    this->d->m_counters = new AkElementCounters();
+    QObject::connect(this,
+                     &AkElement::oStream,
+                     this,
+                     [this] () {
+                         this->d->m_counters->m_packetsOut.fetchAndAddRelaxed(1);
+                     },
+                     Qt::DirectConnection);
+
+    AkElementRegistry *registry = akElementRegistry;
+    registry->m_elementsMutex.lock();
+    registry->m_elements << this;
+    registry->m_elementsMutex.unlock();
 }
 
 AkElement::~AkElement()
 {
+    if (!akElementRegistry.isDestroyed()) {
+        AkElementRegistry *registry = akElementRegistry;
+        registry->m_elementsMutex.lock();
+        registry->m_elements.removeOne(this);
+        registry->m_elementsMutex.unlock();
+    }
+
     this->setState(AkElement::ElementStateNull);
+    delete this->d->m_counters;
     delete this->d;
 }
 
@@ -301,6 +439,43 @@ AkElement::ElementState AkElement::state() const
     return this->d->m_state;
 }
 
+quint64 AkElement::droppedPackets() const
+{
+    return AkElement::droppedPackets(this);
+}
+
+QVariantMap AkElement::statistics() const
+{
+    auto counters = this->d->m_counters;
+    quint64 packetsIn = counters->m_packetsIn.load();
+    quint64 processingTime = counters->m_processingTime.load();
+    quint64 dropped = 0;
+    int queued = 0;
+    AkElementPrivate::queuedPackets(this, &dropped, &queued);
+    QVariantList histogram;
+
+    for (auto &bucket: counters->m_histogram)
+        histogram << bucket.load();
+
+    return QVariantMap {
+        {"pluginId", this->d->m_pluginId},
+        {"objectName", this->objectName()},
+        {"packetsIn", packetsIn},
+        {"packetsOut", counters->m_packetsOut.load()},
+        {"dropped", dropped},
+        {"queued", queued},
+        {"processingTime", processingTime},
+        {"meanProcessingTime", packetsIn > 0? processingTime / packetsIn: 0},
+        {"maxProcessingTime", counters->m_maxProcessingTime.load()},
+        {"histogram", histogram}
+    };
+}
+
+void AkElement::resetStatistics()
+{
+    this->d->m_counters->reset();
+}
+
 QObject *AkElement::controlInterface(QQmlEngine *engine,
                                      const QString &controlId) const
 {
@@ -356,6 +531,13 @@ bool AkElement::link(const AkElementPtr &dstElement, Qt::ConnectionType connecti
     return this->link(static_cast<QObject *>(dstElement.data()), connectionType);
 }
 
+bool AkElement::linkQueued(const QObject *dstElement,
+                           int depth,
+                           AkPacketQueue::DropPolicy dropPolicy) const
+{
+    return this->linkQueued(this, dstElement, depth, dropPolicy);
+}
+
 bool AkElement::unlink(const QObject *dstElement) const
 {
     return this->unlink(this, dstElement);
@@ -395,11 +577,115 @@ bool AkElement::link(const QObject *srcElement,
             if (AkElementPrivate::methodCompat(signal, slot) &&
                 signal.methodType() == QMetaMethod::Signal &&
                 slot.methodType() == QMetaMethod::Slot)
-                QObject::connect(srcElement, signal, dstElement, slot, connectionType);
+                QObject::connect(srcElement,
+                                 signal,
+                                 dstElement,
+                                 AkElementPrivate::inputSlot(dstElement, slot),
+                                 connectionType);
+
+    return true;
+}
+
+bool AkElement::linkQueued(const QObject *srcElement,
+                           const QObject *dstElement,
+                           int depth,
+                           AkPacketQueue::DropPolicy dropPolicy)
+{
+    if (!srcElement || !dstElement)
+        return false;
+
+    auto key = qMakePair(srcElement, dstElement);
+    AkElementRegistry *registry = akElementRegistry;
+    registry->m_linkQueuesMutex.lock();
+
+    if (registry->m_linkQueues.contains(key)) {
+        registry->m_linkQueuesMutex.unlock();
+
+        return false;
+    }
+
+    QSharedPointer<AkPacketQueue> queue(new AkPacketQueue(depth, dropPolicy));
+
+    // The queue thread calls dstElement.
+    AkElement::link(queue.data(), dstElement, Qt::DirectConnection);
+    QMetaObject::Connection input;
+
+    /* Qt releases the sender lock before calling a direct slot, so a packet
+     * being sent can still reach the queue after the link is removed. Qt
+     * keeps a reference to a functor while calling it, so the functor holds
+     * the queue alive until the packet is delivered.
+     */
+    if (auto element = qobject_cast<const AkElement *>(srcElement)) {
+        input = QObject::connect(element,
+                                 &AkElement::oStream,
+                                 [queue] (const AkPacket &packet) {
+            queue->iStream(packet);
+        });
+    } else {
+        /* The oStream() signal of other objects can only be connected by
+         * name, to the queue itself. Keep the queue alive until the source
+         * is destroyed, when it's sure that it is not sending packets.
+         */
+        AkElement::link(srcElement, queue.data(), Qt::DirectConnection);
+        QObject::connect(srcElement, &QObject::destroyed, [queue] () {});
+    }
+
+    // Don't leave the worker running if one of the ends is gone.
+    auto removeQueue = [srcElement, dstElement] () {
+        AkElement::unlink(srcElement, dstElement);
+    };
+
+    registry->m_linkQueues[key] = {
+        queue,
+        input,
+        QObject::connect(srcElement, &QObject::destroyed, removeQueue),
+        QObject::connect(dstElement, &QObject::destroyed, removeQueue)
+    };
+    registry->m_linkQueuesMutex.unlock();
 
     return true;
 }
 
+AkPacketQueue *AkElement::linkQueue(const QObject *srcElement,
+                                    const QObject *dstElement)
+{
+    AkElementRegistry *registry = akElementRegistry;
+    QMutexLocker mutexLocker(&registry->m_linkQueuesMutex);
+
+    return registry->m_linkQueues.value(qMakePair(srcElement, dstElement),
+                                        {}).queue.data();
+}
+
+quint64 AkElement::droppedPackets(const QObject *element)
+{
+    quint64 dropped = 0;
+    int queued = 0;
+    AkElementPrivate::queuedPackets(element, &dropped, &queued);
+
+    return dropped;
+}
+
+QVariantList AkElement::elementsStatistics()
+{
+    AkElementRegistry *registry = akElementRegistry;
+    QMutexLocker mutexLocker(&registry->m_elementsMutex);
+    QVariantList statistics;
+
+    for (auto element: registry->m_elements)
+        statistics << element->statistics();
+
+    return statistics;
+}
+
+void AkElement::resetElementsStatistics()
+{
+    AkElementRegistry *registry = akElementRegistry;
+    QMutexLocker mutexLocker(&registry->m_elementsMutex);
+
+    for (auto element: registry->m_elements)
+        element->resetStatistics();
+}
+
 bool AkElement::unlink(const AkElementPtr &srcElement,
                        const QObject *dstElement)
 {
@@ -417,12 +703,43 @@ bool AkElement::unlink(const QObject *srcElement, const QObject *dstElement)
     if (!srcElement || !dstElement)
         return false;
 
+    if (!akElementRegistry.isDestroyed()) {
+        AkElementRegistry *registry = akElementRegistry;
+        registry->m_linkQueuesMutex.lock();
+        auto linkQueue =
+                registry->m_linkQueues.take(qMakePair(srcElement,
+                                                      dstElement));
+        registry->m_linkQueuesMutex.unlock();
+
+        if (linkQueue.queue) {
+            QObject::disconnect(linkQueue.srcDestroyed);
+            QObject::disconnect(linkQueue.dstDestroyed);
+
+            /* Stop feeding the queue and join its thread, so dstElement is
+             * not called anymore. The queue is freed when the last packet
+             * being sent to it is delivered, see linkQueued().
+             */
+            if (linkQueue.input)
+                QObject::disconnect(linkQueue.input);
+            else
+                QObject::disconnect(srcElement,
+                                    nullptr,
+                                    linkQueue.queue.data(),
+                                    nullptr);
+
+            linkQueue.queue->stop();
+        }
+    }
+
     for (const QMetaMethod &signal: AkElementPrivate::methodsByName(srcElement, "oStream"))
         for (const QMetaMethod &slot: AkElementPrivate::methodsByName(dstElement, "iStream"))
             if (AkElementPrivate::methodCompat(signal, slot) &&
                 signal.methodType() == QMetaMethod::Signal &&
                 slot.methodType() == QMetaMethod::Slot)
-                QObject::disconnect(srcElement, signal, dstElement, slot);
+                QObject::disconnect(srcElement,
+                                    signal,
+                                    dstElement,
+                                    AkElementPrivate::inputSlot(dstElement, slot));
 
     return true;
 }
@@ -825,7 +1142,8 @@ void AkElement::clearCache()
 
 AkPacket AkElement::operator ()(const AkPacket &packet)
 {
-    return this->iStream(packet);
+    // Calling the element directly is accounted like a linked one.
+    return this->processPacket(packet);
 }
 
 AkPacket AkElement::operator ()(const AkAudioPacket &packet)
@@ -957,6 +1275,38 @@ void AkElement::resetState()
     this->setState(ElementStateNull);
 }
 
+AkPacket AkElement::processPacket(const AkPacket &packet)
+{
+    /* The elements linked with a direct connection run inside iStream(),
+     * take their time out to get the time spent in this element only.
+     */
+    quint64 childrenTime = akElementChildrenTime;
+    akElementChildrenTime = 0;
+
+    auto trace = AkTrace::globalInstance();
+    qint64 traceStart = trace->isActive()? trace->now(): -1;
+
+    QElapsedTimer timer;
+    timer.start();
+    auto oPacket = this->iStream(packet);
+    auto elapsed = quint64(timer.nsecsElapsed());
+
+    if (traceStart >= 0)
+        trace->addSpan(this->objectName().isEmpty()?
+                           this->d->m_pluginId.toUtf8():
+                           this->objectName().toUtf8(),
+                       "element",
+                       traceStart,
+                       qint64(elapsed),
+                       packet.id(),
+                       packet.pts());
+
+    this->d->m_counters->addSample(elapsed - qMin(elapsed, akElementChildrenTime));
+    akElementChildrenTime = childrenTime + elapsed;
+
+    return oPacket;
+}
+
 QDataStream &operator >>(QDataStream &istream, AkElement::ElementState &state)
 {
     int stateInt;
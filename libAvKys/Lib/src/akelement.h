@@ -23,6 +23,7 @@
 #include <QObject>
 
 #include "akcommons.h"
+#include "akpacketqueue.h"
 
 #define akSend(packet) { \
     if (packet) \
@@ -71,6 +72,16 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         Q_INVOKABLE static QString pluginId(const QString &path);
         Q_INVOKABLE QString pluginPath() const;
         Q_INVOKABLE virtual AkElement::ElementState state() const;
+        Q_INVOKABLE quint64 droppedPackets() const;
+
+        /* Packets received and sent, packets dropped and waiting in the
+         * queues feeding the element, and the time spent in iStream() in
+         * nanoseconds, without counting the elements called from it.
+         * The histogram counts the packets by processing time, bucket i
+         * goes from 2^i to 2^(i + 1) microseconds.
+         */
+        Q_INVOKABLE QVariantMap statistics() const;
+        Q_INVOKABLE void resetStatistics();
         Q_INVOKABLE virtual QObject *controlInterface(QQmlEngine *engine,
                                                       const QString &controlId) const;
 
@@ -80,6 +91,10 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         Q_INVOKABLE virtual bool link(const AkElementPtr &dstElement,
                                       Qt::ConnectionType connectionType=Qt::AutoConnection) const;
 
+        Q_INVOKABLE virtual bool linkQueued(const QObject *dstElement,
+                                            int depth=2,
+                                            AkPacketQueue::DropPolicy dropPolicy=AkPacketQueue::DropPolicyDropOldest) const;
+
         Q_INVOKABLE virtual bool unlink(const QObject *dstElement) const;
         Q_INVOKABLE virtual bool unlink(const AkElementPtr &dstElement) const;
 
@@ -92,6 +107,15 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         Q_INVOKABLE static bool link(const QObject *srcElement,
                                      const QObject *dstElement,
                                      Qt::ConnectionType connectionType=Qt::AutoConnection);
+        Q_INVOKABLE static bool linkQueued(const QObject *srcElement,
+                                           const QObject *dstElement,
+                                           int depth=2,
+                                           AkPacketQueue::DropPolicy dropPolicy=AkPacketQueue::DropPolicyDropOldest);
+        Q_INVOKABLE static AkPacketQueue *linkQueue(const QObject *srcElement,
+                                                    const QObject *dstElement);
+        Q_INVOKABLE static quint64 droppedPackets(const QObject *element);
+        Q_INVOKABLE static QVariantList elementsStatistics();
+        Q_INVOKABLE static void resetElementsStatistics();
         Q_INVOKABLE static bool unlink(const AkElementPtr &srcElement,
                                        const QObject *dstElement);
         Q_INVOKABLE static bool unlink(const AkElementPtr &srcElement,
@@ -154,6 +178,9 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         virtual AkPacket iStream(const AkVideoPacket &packet);
         virtual bool setState(AkElement::ElementState state);
         virtual void resetState();
+
+    private Q_SLOTS:
+        AkPacket processPacket(const AkPacket &packet);
 };
 
 QDataStream &operator >>(QDataStream &istream, AkElement::ElementState &state);
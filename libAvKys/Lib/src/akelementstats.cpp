@@ -0,0 +1,143 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDebug>
+#include <QTimer>
+
+#include "akelementstats.h"
+#include "akelement.h"
+
+#define DEFAULT_INTERVAL 1000
+
+class AkElementStatsPrivate
+{
+    public:
+        QVariantList m_statistics;
+        QTimer m_timer;
+        bool m_dump;
+
+        AkElementStatsPrivate():
+            m_dump(false)
+        {
+        }
+};
+
+AkElementStats::AkElementStats(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkElementStatsPrivate;
+    this->d->m_timer.setInterval(DEFAULT_INTERVAL);
+
+    QObject::connect(&this->d->m_timer,
+                     &QTimer::timeout,
+                     this,
+                     &AkElementStats::update);
+
+    // Let the DUMP_ELEMENT_STATS environment variable enable the dump.
+    this->d->m_dump = qEnvironmentVariableIsSet("DUMP_ELEMENT_STATS");
+    this->d->m_timer.start();
+}
+
+AkElementStats::~AkElementStats()
+{
+    delete this->d;
+}
+
+QVariantList AkElementStats::statistics() const
+{
+    return this->d->m_statistics;
+}
+
+int AkElementStats::interval() const
+{
+    return this->d->m_timer.interval();
+}
+
+bool AkElementStats::dump() const
+{
+    return this->d->m_dump;
+}
+
+void AkElementStats::setInterval(int interval)
+{
+    if (this->d->m_timer.interval() == interval)
+        return;
+
+    this->d->m_timer.setInterval(interval);
+
+    if (interval > 0)
+        this->d->m_timer.start();
+    else
+        this->d->m_timer.stop();
+
+    emit this->intervalChanged(interval);
+}
+
+void AkElementStats::setDump(bool dump)
+{
+    if (this->d->m_dump == dump)
+        return;
+
+    this->d->m_dump = dump;
+    emit this->dumpChanged(dump);
+}
+
+void AkElementStats::resetInterval()
+{
+    this->setInterval(DEFAULT_INTERVAL);
+}
+
+void AkElementStats::resetDump()
+{
+    this->setDump(false);
+}
+
+void AkElementStats::update()
+{
+    this->d->m_statistics = AkElement::elementsStatistics();
+    emit this->statisticsChanged(this->d->m_statistics);
+
+    if (!this->d->m_dump)
+        return;
+
+    for (auto &statistics: this->d->m_statistics) {
+        auto element = statistics.toMap();
+
+        qDebug().nospace().noquote()
+                << element["pluginId"].toString()
+                << (element["objectName"].toString().isEmpty()?
+                        "":
+                        " (" + element["objectName"].toString() + ")")
+                << ": in " << element["packetsIn"].toULongLong()
+                << ", out " << element["packetsOut"].toULongLong()
+                << ", dropped " << element["dropped"].toULongLong()
+                << ", queued " << element["queued"].toInt()
+                << ", mean " << element["meanProcessingTime"].toULongLong() / 1000
+                << " us, max " << element["maxProcessingTime"].toULongLong() / 1000
+                << " us";
+    }
+}
+
+void AkElementStats::reset()
+{
+    AkElement::resetElementsStatistics();
+    this->update();
+}
+
+#include "moc_akelementstats.cpp"
@@ -0,0 +1,77 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKELEMENTSTATS_H
+#define AKELEMENTSTATS_H
+
+#include <QObject>
+#include <QVariantList>
+
+#include "akcommons.h"
+
+class AkElementStatsPrivate;
+
+/* Periodically collects the statistics of all the elements.
+ *
+ * Meant for QML and for debugging: with dump enabled, a summary of each
+ * element is printed every interval.
+ */
+class AKCOMMONS_EXPORT AkElementStats: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList statistics
+               READ statistics
+               NOTIFY statisticsChanged)
+    Q_PROPERTY(int interval
+               READ interval
+               WRITE setInterval
+               RESET resetInterval
+               NOTIFY intervalChanged)
+    Q_PROPERTY(bool dump
+               READ dump
+               WRITE setDump
+               RESET resetDump
+               NOTIFY dumpChanged)
+
+    public:
+        explicit AkElementStats(QObject *parent=nullptr);
+        ~AkElementStats();
+
+        Q_INVOKABLE QVariantList statistics() const;
+        Q_INVOKABLE int interval() const;
+        Q_INVOKABLE bool dump() const;
+
+    private:
+        AkElementStatsPrivate *d;
+
+    signals:
+        void statisticsChanged(const QVariantList &statistics);
+        void intervalChanged(int interval);
+        void dumpChanged(bool dump);
+
+    public slots:
+        void setInterval(int interval);
+        void setDump(bool dump);
+        void resetInterval();
+        void resetDump();
+        void update();
+        void reset();
+};
+
+#endif // AKELEMENTSTATS_H
@@ -0,0 +1,170 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+
+#include "aklatencybudget.h"
+#include "akpacket.h"
+
+/* Latency jumps bigger than this, in microseconds, are taken as a
+ * discontinuity of the stream.
+ */
+#define DISCONTINUITY_THRESHOLD_US 10000000
+
+// The zero latency reference advances 1 ms per second.
+#define REFERENCE_DRIFT 1000
+
+/* A reference that wasn't updated for this long, in microseconds, belongs to
+ * a stream that already ended.
+ */
+#define REFERENCE_TIMEOUT_US 10000000
+
+// Maximum number of streams tracked at once.
+#define MAX_REFERENCES 64
+
+struct AkLatencyReference
+{
+    qint64 offset;
+    qint64 time;
+};
+
+class AkLatencyBudgetPrivate
+{
+    public:
+        QAtomicInteger<qint64> m_budget;
+        QElapsedTimer m_timer;
+        QMap<QPair<qint64, int>, AkLatencyReference> m_references;
+        QMutex m_mutex;
+
+        void removeExpired(qint64 now);
+};
+
+Q_GLOBAL_STATIC_WITH_ARGS(AkLatencyBudget, akLatencyBudget, (int(AkLatencyBudget::DefaultBudget)))
+
+AkLatencyBudget::AkLatencyBudget(qint64 budget)
+{
+    this->d = new AkLatencyBudgetPrivate;
+    this->d->m_budget.store(budget);
+    this->d->m_timer.start();
+}
+
+AkLatencyBudget::~AkLatencyBudget()
+{
+    delete this->d;
+}
+
+AkLatencyBudget *AkLatencyBudget::globalInstance()
+{
+    return akLatencyBudget;
+}
+
+qint64 AkLatencyBudget::budget() const
+{
+    return this->d->m_budget.load();
+}
+
+void AkLatencyBudget::setBudget(qint64 budget)
+{
+    this->d->m_budget.store(budget);
+}
+
+void AkLatencyBudget::resetBudget()
+{
+    this->setBudget(DefaultBudget);
+}
+
+qint64 AkLatencyBudget::latency(const AkPacket &packet)
+{
+    auto timeBase = packet.timeBase();
+
+    if (packet.pts() == AkNoPts<qint64>()
+        || timeBase.num() < 1
+        || timeBase.den() < 1)
+        return -1;
+
+    // All the values are in microseconds.
+    qint64 now = this->d->m_timer.nsecsElapsed() / 1000;
+    qint64 pts = qint64(1e6 * qreal(packet.pts()) * timeBase.value());
+    qint64 offset = now - pts;
+    auto key = qMakePair(packet.id(), packet.index());
+
+    this->d->m_mutex.lock();
+    auto it = this->d->m_references.find(key);
+
+    if (it == this->d->m_references.end()) {
+        this->d->removeExpired(now);
+        this->d->m_references[key] = {offset, now};
+        this->d->m_mutex.unlock();
+
+        return 0;
+    }
+
+    it->offset += (now - it->time) / REFERENCE_DRIFT;
+    it->time = now;
+
+    if (offset < it->offset || offset - it->offset > DISCONTINUITY_THRESHOLD_US)
+        it->offset = offset;
+
+    qint64 latency = offset - it->offset;
+    this->d->m_mutex.unlock();
+
+    return latency / 1000;
+}
+
+bool AkLatencyBudget::isStale(const AkPacket &packet)
+{
+    qint64 budget = this->d->m_budget.load();
+
+    if (budget <= 0)
+        return false;
+
+    return this->latency(packet) > budget;
+}
+
+void AkLatencyBudget::reset()
+{
+    this->d->m_mutex.lock();
+    this->d->m_references.clear();
+    this->d->m_mutex.unlock();
+}
+
+void AkLatencyBudgetPrivate::removeExpired(qint64 now)
+{
+    // Every new stream id adds a reference, drop the ones of ended streams.
+    for (auto it = this->m_references.begin();
+         it != this->m_references.end();)
+        if (now - it->time > REFERENCE_TIMEOUT_US)
+            it = this->m_references.erase(it);
+        else
+            ++it;
+
+    // Too many live streams, forget the least recently seen.
+    while (this->m_references.size() >= MAX_REFERENCES) {
+        auto oldest = this->m_references.begin();
+
+        for (auto it = oldest; it != this->m_references.end(); ++it)
+            if (it->time < oldest->time)
+                oldest = it;
+
+        this->m_references.erase(oldest);
+    }
+}
@@ -0,0 +1,72 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKLATENCYBUDGET_H
+#define AKLATENCYBUDGET_H
+
+#include "akcommons.h"
+
+class AkLatencyBudgetPrivate;
+class AkPacket;
+
+/* Pipeline wide latency budget.
+ *
+ * The pts of the packets comes from a different clock for each source, so
+ * the latency of a packet is measured relative to the fastest packet seen
+ * in the same stream: the smallest difference between the wall clock and
+ * the pts is taken as zero latency. That reference slowly moves forward
+ * with time, so a source clock running slower than the wall clock doesn't
+ * accumulate a fake delay.
+ *
+ * A packet is stale when its latency exceeds the budget. The elements that
+ * can drop packets should only drop a stale packet when a newer one is
+ * already waiting, so the pipeline always makes progress.
+ */
+class AKCOMMONS_EXPORT AkLatencyBudget
+{
+    Q_DISABLE_COPY(AkLatencyBudget)
+
+    public:
+        enum
+        {
+            DefaultBudget = 200
+        };
+
+        AkLatencyBudget(qint64 budget=DefaultBudget);
+        ~AkLatencyBudget();
+
+        static AkLatencyBudget *globalInstance();
+
+        // Budget in milliseconds, a value <= 0 disables the dropping.
+        qint64 budget() const;
+        void setBudget(qint64 budget);
+        void resetBudget();
+
+        // Latency of the packet in milliseconds, or -1 if it has no pts.
+        qint64 latency(const AkPacket &packet);
+        bool isStale(const AkPacket &packet);
+
+        // Forget the reference of all streams.
+        void reset();
+
+    private:
+        AkLatencyBudgetPrivate *d;
+};
+
+#endif // AKLATENCYBUDGET_H
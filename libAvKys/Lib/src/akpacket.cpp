@@ -21,9 +21,10 @@
 #include <QVariant>
 
 #include "akpacket.h"
+#include "akpacketpool.h"
 #include "akcaps.h"
 
-class AkPacketPrivate
+class AkPacketPrivate: public QSharedData
 {
     public:
         AkCaps m_caps;
@@ -33,10 +34,11 @@ class AkPacketPrivate
         AkFrac m_timeBase;
         int m_index;
         qint64 m_id;
+
+        AK_PACKET_POOL_ALLOCATED(AkPacketPrivate)
 };
 
-AkPacket::AkPacket(QObject *parent):
-    QObject(parent)
+AkPacket::AkPacket()
 {
     this->d = new AkPacketPrivate();
     this->d->m_pts = 0;
@@ -62,34 +64,18 @@ AkPacket::AkPacket(const AkCaps &caps,
 }
 
 AkPacket::AkPacket(const AkPacket &other):
-    QObject()
+    d(other.d)
 {
-    this->d = new AkPacketPrivate();
-    this->d->m_caps = other.d->m_caps;
-    this->d->m_data = other.d->m_data;
-    this->d->m_buffer = other.d->m_buffer;
-    this->d->m_pts = other.d->m_pts;
-    this->d->m_timeBase = other.d->m_timeBase;
-    this->d->m_index = other.d->m_index;
-    this->d->m_id = other.d->m_id;
 }
 
 AkPacket::~AkPacket()
 {
-    delete this->d;
 }
 
 AkPacket &AkPacket::operator =(const AkPacket &other)
 {
-    if (this != &other) {
-        this->d->m_caps = other.d->m_caps;
-        this->d->m_data = other.d->m_data;
-        this->d->m_buffer = other.d->m_buffer;
-        this->d->m_pts = other.d->m_pts;
-        this->d->m_timeBase = other.d->m_timeBase;
-        this->d->m_index = other.d->m_index;
-        this->d->m_id = other.d->m_id;
-    }
+    if (this != &other)
+        this->d = other.d;
 
     return *this;
 }
@@ -208,65 +194,37 @@ int &AkPacket::index()
 
 void AkPacket::setCaps(const AkCaps &caps)
 {
-    if (this->d->m_caps == caps)
-        return;
-
     this->d->m_caps = caps;
-    emit this->capsChanged(caps);
 }
 
 void AkPacket::setData(const QVariant &data)
 {
-    if (this->d->m_data == data)
-        return;
-
     this->d->m_data = data;
-    emit this->dataChanged(data);
 }
 
 void AkPacket::setBuffer(const QByteArray &buffer)
 {
-    if (this->d->m_buffer == buffer)
-        return;
-
     this->d->m_buffer = buffer;
-    emit this->bufferChanged(buffer);
 }
 
 void AkPacket::setId(qint64 id)
 {
-    if (this->d->m_id == id)
-        return;
-
     this->d->m_id = id;
-    emit this->idChanged(id);
 }
 
 void AkPacket::setPts(qint64 pts)
 {
-    if (this->d->m_pts == pts)
-        return;
-
     this->d->m_pts = pts;
-    emit this->ptsChanged(pts);
 }
 
 void AkPacket::setTimeBase(const AkFrac &timeBase)
 {
-    if (this->d->m_timeBase == timeBase)
-        return;
-
     this->d->m_timeBase = timeBase;
-    emit this->timeBaseChanged(timeBase);
 }
 
 void AkPacket::setIndex(int index)
 {
-    if (this->d->m_index == index)
-        return;
-
     this->d->m_index = index;
-    emit this->indexChanged(index);
 }
 
 void AkPacket::resetCaps()
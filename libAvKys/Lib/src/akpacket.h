@@ -20,6 +20,8 @@
 #ifndef AKPACKET_H
 #define AKPACKET_H
 
+#include <QSharedDataPointer>
+
 #include "akfrac.h"
 
 class AkPacketPrivate;
@@ -31,47 +33,44 @@ inline T AkNoPts()
     return T(0x1) << (sizeof(T) - 1);
 }
 
-class AKCOMMONS_EXPORT AkPacket: public QObject
+/* Packets are implicitly shared value types, copying a packet between
+ * elements only increments a reference counter, the data is only copied
+ * when a shared packet is modified.
+ */
+class AKCOMMONS_EXPORT AkPacket
 {
-    Q_OBJECT
+    Q_GADGET
     Q_PROPERTY(AkCaps caps
                READ caps
                WRITE setCaps
-               RESET resetCaps
-               NOTIFY capsChanged)
+               RESET resetCaps)
     Q_PROPERTY(QVariant data
                READ data
                WRITE setData
-               RESET resetData
-               NOTIFY dataChanged)
+               RESET resetData)
     Q_PROPERTY(QByteArray buffer
                READ buffer
                WRITE setBuffer
-               RESET resetBuffer
-               NOTIFY bufferChanged)
+               RESET resetBuffer)
     Q_PROPERTY(qint64 id
                READ id
                WRITE setId
-               RESET resetId
-               NOTIFY idChanged)
+               RESET resetId)
     Q_PROPERTY(qint64 pts
                READ pts
                WRITE setPts
-               RESET resetPts
-               NOTIFY ptsChanged)
+               RESET resetPts)
     Q_PROPERTY(AkFrac timeBase
                READ timeBase
                WRITE setTimeBase
-               RESET resetTimeBase
-               NOTIFY timeBaseChanged)
+               RESET resetTimeBase)
     Q_PROPERTY(int index
                READ index
                WRITE setIndex
-               RESET resetIndex
-               NOTIFY indexChanged)
+               RESET resetIndex)
 
     public:
-        explicit AkPacket(QObject *parent=nullptr);
+        AkPacket();
         AkPacket(const AkCaps &caps,
                  const QByteArray &buffer=QByteArray(),
                  qint64 pts=0,
@@ -99,33 +98,23 @@ class AKCOMMONS_EXPORT AkPacket: public QObject
         Q_INVOKABLE int index() const;
         Q_INVOKABLE int &index();
 
-    private:
-        AkPacketPrivate *d;
+        Q_INVOKABLE void setCaps(const AkCaps &caps);
+        Q_INVOKABLE void setData(const QVariant &data);
+        Q_INVOKABLE void setBuffer(const QByteArray &buffer);
+        Q_INVOKABLE void setId(qint64 id);
+        Q_INVOKABLE void setPts(qint64 pts);
+        Q_INVOKABLE void setTimeBase(const AkFrac &timeBase);
+        Q_INVOKABLE void setIndex(int index);
+        Q_INVOKABLE void resetCaps();
+        Q_INVOKABLE void resetData();
+        Q_INVOKABLE void resetBuffer();
+        Q_INVOKABLE void resetId();
+        Q_INVOKABLE void resetPts();
+        Q_INVOKABLE void resetTimeBase();
+        Q_INVOKABLE void resetIndex();
 
-    Q_SIGNALS:
-        void capsChanged(const AkCaps &caps);
-        void dataChanged(const QVariant &data);
-        void bufferChanged(const QByteArray &buffer);
-        void idChanged(qint64 id);
-        void ptsChanged(qint64 pts);
-        void timeBaseChanged(const AkFrac &timeBase);
-        void indexChanged(int index);
-
-    public Q_SLOTS:
-        void setCaps(const AkCaps &caps);
-        void setData(const QVariant &data);
-        void setBuffer(const QByteArray &buffer);
-        void setId(qint64 id);
-        void setPts(qint64 pts);
-        void setTimeBase(const AkFrac &timeBase);
-        void setIndex(int index);
-        void resetCaps();
-        void resetData();
-        void resetBuffer();
-        void resetId();
-        void resetPts();
-        void resetTimeBase();
-        void resetIndex();
+    private:
+        QSharedDataPointer<AkPacketPrivate> d;
 
     friend QDebug operator <<(QDebug debug, const AkPacket &packet);
 };
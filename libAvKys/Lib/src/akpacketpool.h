@@ -0,0 +1,128 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKPACKETPOOL_H
+#define AKPACKETPOOL_H
+
+#include <QMutex>
+#include <QVector>
+
+/* Free list allocator for the packets private data.
+ *
+ * Packets are created and destroyed at the frame rate in every element of
+ * the chain, but the size of their private data never changes, so the
+ * released blocks are kept and given back on the next allocation instead of
+ * hitting the system allocator.
+ */
+template<typename T>
+class AkPacketPool
+{
+    public:
+        enum
+        {
+            MaxBlocks = 256
+        };
+
+        static void *allocate()
+        {
+            auto &pool = AkPacketPool<T>::instance();
+
+            pool.m_mutex.lock();
+
+            if (!pool.m_blocks.isEmpty()) {
+                void *block = pool.m_blocks.takeLast();
+                pool.m_mutex.unlock();
+
+                return block;
+            }
+
+            pool.m_mutex.unlock();
+
+            return ::operator new(sizeof(T));
+        }
+
+        static void release(void *block)
+        {
+            if (!block)
+                return;
+
+            // The pool can be already gone if a packet outlives the
+            // application.
+            if (!AkPacketPool<T>::destroyed()) {
+                auto &pool = AkPacketPool<T>::instance();
+
+                pool.m_mutex.lock();
+
+                if (pool.m_blocks.size() < MaxBlocks) {
+                    pool.m_blocks << block;
+                    pool.m_mutex.unlock();
+
+                    return;
+                }
+
+                pool.m_mutex.unlock();
+            }
+
+            ::operator delete(block);
+        }
+
+    private:
+        QMutex m_mutex;
+        QVector<void *> m_blocks;
+
+        AkPacketPool()
+        {
+            this->m_blocks.reserve(MaxBlocks);
+        }
+
+        ~AkPacketPool()
+        {
+            AkPacketPool<T>::destroyed() = true;
+
+            for (auto block: this->m_blocks)
+                ::operator delete(block);
+        }
+
+        static AkPacketPool<T> &instance()
+        {
+            static AkPacketPool<T> pool;
+
+            return pool;
+        }
+
+        static bool &destroyed()
+        {
+            static bool destroyed = false;
+
+            return destroyed;
+        }
+};
+
+#define AK_PACKET_POOL_ALLOCATED(Type) \
+    static void *operator new(size_t) \
+    { \
+        return AkPacketPool<Type>::allocate(); \
+    } \
+    \
+    static void operator delete(void *block) \
+    { \
+        AkPacketPool<Type>::release(block); \
+    }
+
+#endif // AKPACKETPOOL_H
@@ -0,0 +1,329 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "akpacketqueue.h"
+#include "akpacket.h"
+#include "aklatencybudget.h"
+
+class AkPacketQueueThread;
+
+class AkPacketQueuePrivate
+{
+    public:
+        AkPacketQueue *self;
+        int m_depth;
+
+        /* Packets are stored by pointer so the slots can be claimed with a
+         * single atomic exchange. m_head is only moved by the producer,
+         * m_tail is moved by the consumer and, with DropPolicyDropOldest,
+         * by the producer too; the one that wins the compare and swap owns
+         * the packet.
+         */
+        QAtomicPointer<AkPacket> *m_slots;
+        QAtomicInteger<quint64> m_head;
+        QAtomicInteger<quint64> m_tail;
+        QAtomicInt m_dropPolicy;
+        QAtomicInteger<quint64> m_dropped;
+        QAtomicInt m_run;
+
+        // Only used to sleep when there is nothing to do.
+        QMutex m_mutex;
+        QWaitCondition m_notEmpty;
+        QWaitCondition m_notFull;
+        QAtomicInt m_consumerWaiting;
+        QAtomicInt m_producerWaiting;
+
+        // Serializes the producers if more than one thread sends packets.
+        QMutex m_producerMutex;
+
+        AkPacketQueueThread *m_thread;
+
+        AkPacketQueuePrivate(AkPacketQueue *self, int depth):
+            self(self),
+            m_depth(depth),
+            m_slots(new QAtomicPointer<AkPacket>[depth]),
+            m_head(0),
+            m_tail(0),
+            m_dropPolicy(AkPacketQueue::DropPolicyDropOldest),
+            m_dropped(0),
+            m_run(1),
+            m_consumerWaiting(0),
+            m_producerWaiting(0),
+            m_thread(nullptr)
+        {
+            for (int i = 0; i < depth; i++)
+                this->m_slots[i].store(nullptr);
+        }
+
+        ~AkPacketQueuePrivate()
+        {
+            for (int i = 0; i < this->m_depth; i++)
+                delete this->m_slots[i].load();
+
+            delete [] this->m_slots;
+        }
+
+        inline bool isFull(quint64 head) const;
+        inline void push(const AkPacket &packet);
+        inline AkPacket *pop();
+        inline void loop();
+        inline void wake(QWaitCondition *condition, const QAtomicInt &waiting);
+};
+
+class AkPacketQueueThread: public QThread
+{
+    public:
+        AkPacketQueueThread(AkPacketQueuePrivate *queue):
+            QThread(),
+            m_queue(queue)
+        {
+            this->setObjectName("AkPacketQueue");
+        }
+
+    protected:
+        void run()
+        {
+            this->m_queue->loop();
+        }
+
+    private:
+        AkPacketQueuePrivate *m_queue;
+};
+
+AkPacketQueue::AkPacketQueue(int depth,
+                             AkPacketQueue::DropPolicy dropPolicy,
+                             QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkPacketQueuePrivate(this, qMax(depth, 1));
+    this->d->m_dropPolicy.store(dropPolicy);
+    this->d->m_thread = new AkPacketQueueThread(this->d);
+    this->d->m_thread->start();
+}
+
+AkPacketQueue::~AkPacketQueue()
+{
+    this->stop();
+    delete this->d->m_thread;
+    delete this->d;
+}
+
+int AkPacketQueue::depth() const
+{
+    return this->d->m_depth;
+}
+
+AkPacketQueue::DropPolicy AkPacketQueue::dropPolicy() const
+{
+    return AkPacketQueue::DropPolicy(this->d->m_dropPolicy.load());
+}
+
+int AkPacketQueue::size() const
+{
+    return int(this->d->m_head.loadAcquire() - this->d->m_tail.loadAcquire());
+}
+
+quint64 AkPacketQueue::dropped() const
+{
+    return this->d->m_dropped.load();
+}
+
+void AkPacketQueue::stop()
+{
+    this->d->m_run.storeRelease(0);
+    this->d->m_mutex.lock();
+    this->d->m_notEmpty.wakeAll();
+    this->d->m_notFull.wakeAll();
+    this->d->m_mutex.unlock();
+
+    this->d->m_thread->wait();
+
+    // Wait for a producer blocked in iStream(), and drop what is left.
+    this->d->m_producerMutex.lock();
+
+    for (int i = 0; i < this->d->m_depth; i++)
+        delete this->d->m_slots[i].fetchAndStoreAcquire(nullptr);
+
+    this->d->m_tail.storeRelease(this->d->m_head.loadAcquire());
+    this->d->m_producerMutex.unlock();
+}
+
+void AkPacketQueue::setDropPolicy(AkPacketQueue::DropPolicy dropPolicy)
+{
+    if (this->d->m_dropPolicy.fetchAndStoreOrdered(dropPolicy) == dropPolicy)
+        return;
+
+    // A blocked producer must re-evaluate the policy.
+    this->d->wake(&this->d->m_notFull, this->d->m_producerWaiting);
+    emit this->dropPolicyChanged(dropPolicy);
+}
+
+void AkPacketQueue::resetDropPolicy()
+{
+    this->setDropPolicy(DropPolicyDropOldest);
+}
+
+AkPacket AkPacketQueue::iStream(const AkPacket &packet)
+{
+    if (packet) {
+        this->d->m_producerMutex.lock();
+
+        // The queue could be already shutting down.
+        if (this->d->m_run.loadAcquire())
+            this->d->push(packet);
+
+        this->d->m_producerMutex.unlock();
+    }
+
+    return AkPacket();
+}
+
+bool AkPacketQueuePrivate::isFull(quint64 head) const
+{
+    return head - this->m_tail.loadAcquire() >= quint64(this->m_depth);
+}
+
+void AkPacketQueuePrivate::push(const AkPacket &packet)
+{
+    quint64 head = this->m_head.load();
+
+    while (this->isFull(head)) {
+        if (!this->m_run.loadAcquire())
+            return;
+
+        switch (this->m_dropPolicy.load()) {
+        case AkPacketQueue::DropPolicyDropNewest:
+            this->m_dropped.fetchAndAddRelaxed(1);
+
+            return;
+
+        case AkPacketQueue::DropPolicyDropOldest: {
+            quint64 tail = this->m_tail.loadAcquire();
+
+            if (head - tail >= quint64(this->m_depth)
+                && this->m_tail.testAndSetOrdered(tail, tail + 1)) {
+                delete this->m_slots[tail % quint64(this->m_depth)]
+                        .fetchAndStoreAcquire(nullptr);
+                this->m_dropped.fetchAndAddRelaxed(1);
+            }
+
+            break;
+        }
+
+        default:
+            this->m_mutex.lock();
+            this->m_producerWaiting.fetchAndStoreOrdered(1);
+
+            if (this->isFull(head)
+                && this->m_run.loadAcquire()
+                && this->m_dropPolicy.load() == AkPacketQueue::DropPolicyBlock)
+                this->m_notFull.wait(&this->m_mutex);
+
+            this->m_producerWaiting.fetchAndStoreOrdered(0);
+            this->m_mutex.unlock();
+
+            break;
+        }
+    }
+
+    /* The previous packet of this slot was already claimed, but the consumer
+     * may still be taking it out.
+     */
+    auto &slot = this->m_slots[head % quint64(this->m_depth)];
+    auto newPacket = new AkPacket(packet);
+
+    while (!slot.testAndSetRelease(nullptr, newPacket))
+        QThread::yieldCurrentThread();
+
+    this->m_head.fetchAndStoreOrdered(head + 1);
+    this->wake(&this->m_notEmpty, this->m_consumerWaiting);
+}
+
+AkPacket *AkPacketQueuePrivate::pop()
+{
+    forever {
+        quint64 tail = this->m_tail.loadAcquire();
+
+        if (tail == this->m_head.loadAcquire())
+            return nullptr;
+
+        if (!this->m_tail.testAndSetOrdered(tail, tail + 1))
+            continue;
+
+        auto packet = this->m_slots[tail % quint64(this->m_depth)]
+                      .fetchAndStoreAcquire(nullptr);
+        this->wake(&this->m_notFull, this->m_producerWaiting);
+
+        return packet;
+    }
+}
+
+void AkPacketQueuePrivate::loop()
+{
+    while (this->m_run.loadAcquire()) {
+        auto packet = this->pop();
+
+        if (!packet) {
+            this->m_mutex.lock();
+            this->m_consumerWaiting.fetchAndStoreOrdered(1);
+
+            if (this->m_tail.loadAcquire() == this->m_head.loadAcquire()
+                && this->m_run.loadAcquire())
+                this->m_notEmpty.wait(&this->m_mutex);
+
+            this->m_consumerWaiting.fetchAndStoreOrdered(0);
+            this->m_mutex.unlock();
+
+            continue;
+        }
+
+        /* Skip the packets that waited too long, but only if there is a
+         * newer one to send instead.
+         */
+        if (this->m_dropPolicy.load() != AkPacketQueue::DropPolicyBlock
+            && AkLatencyBudget::globalInstance()->isStale(*packet)
+            && this->m_tail.loadAcquire() != this->m_head.loadAcquire()) {
+            this->m_dropped.fetchAndAddRelaxed(1);
+            delete packet;
+
+            continue;
+        }
+
+        emit this->self->oStream(*packet);
+        delete packet;
+    }
+}
+
+void AkPacketQueuePrivate::wake(QWaitCondition *condition,
+                                const QAtomicInt &waiting)
+{
+    if (!waiting.loadAcquire())
+        return;
+
+    this->m_mutex.lock();
+    condition->wakeAll();
+    this->m_mutex.unlock();
+}
+
+#include "moc_akpacketqueue.cpp"
@@ -0,0 +1,94 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+#ifndef AKPACKETQUEUE_H
+#define AKPACKETQUEUE_H
+
+#include <QObject>
+
+#include "akcommons.h"
+
+class AkPacketQueuePrivate;
+class AkPacket;
+
+/* Bounded queue with its own worker thread, placed between two elements.
+ *
+ * Packets received in iStream() are stored in a fixed size ring buffer and
+ * sent through oStream() from the worker thread, so the element linked
+ * after the queue runs in parallel with the one before it. The ring is lock
+ * free, the threads only sleep when the queue is empty, or when it's full
+ * and the drop policy is DropPolicyBlock.
+ *
+ * Unless the policy is DropPolicyBlock, packets that exceed the latency
+ * budget (see AkLatencyBudget) are also dropped when a newer one is queued.
+ *
+ * stop() joins the worker thread, after that iStream() ignores the packets,
+ * but the queue must not be deleted while another thread can still call it.
+ */
+class AKCOMMONS_EXPORT AkPacketQueue: public QObject
+{
+    Q_OBJECT
+    Q_ENUMS(DropPolicy)
+    Q_PROPERTY(int depth
+               READ depth
+               CONSTANT)
+    Q_PROPERTY(AkPacketQueue::DropPolicy dropPolicy
+               READ dropPolicy
+               WRITE setDropPolicy
+               RESET resetDropPolicy
+               NOTIFY dropPolicyChanged)
+    Q_PROPERTY(int size
+               READ size)
+    Q_PROPERTY(quint64 dropped
+               READ dropped)
+
+    public:
+        enum DropPolicy
+        {
+            DropPolicyBlock,
+            DropPolicyDropOldest,
+            DropPolicyDropNewest
+        };
+
+        explicit AkPacketQueue(int depth=2,
+                               AkPacketQueue::DropPolicy dropPolicy=DropPolicyDropOldest,
+                               QObject *parent=nullptr);
+        ~AkPacketQueue();
+
+        Q_INVOKABLE int depth() const;
+        Q_INVOKABLE AkPacketQueue::DropPolicy dropPolicy() const;
+        Q_INVOKABLE int size() const;
+        Q_INVOKABLE quint64 dropped() const;
+        Q_INVOKABLE void stop();
+
+    private:
+        AkPacketQueuePrivate *d;
+
+    signals:
+        void dropPolicyChanged(AkPacketQueue::DropPolicy dropPolicy);
+        void oStream(const AkPacket &packet);
+
+    public slots:
+        void setDropPolicy(AkPacketQueue::DropPolicy dropPolicy);
+        void resetDropPolicy();
+        AkPacket iStream(const AkPacket &packet);
+};
+
+Q_DECLARE_METATYPE(AkPacketQueue::DropPolicy)
+
+#endif // AKPACKETQUEUE_H
@@ -0,0 +1,486 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+#ifndef AKPIXEL_H
+#define AKPIXEL_H
+
+#include <cmath>
+#include <type_traits>
+#include <QImage>
+
+#include "akworkerpool.h"
+
+/* Channel layout of a packed 32 bits pixel.
+ *
+ * The shifts are the position of each component inside the native 32 bits
+ * word, an alpha shift of -1 means that the format has no alpha and the
+ * component is always read as opaque.
+ */
+template<int RedShift, int GreenShift, int BlueShift, int AlphaShift>
+struct AkPixelFormat32
+{
+    typedef quint32 Type;
+
+    enum
+    {
+        HasAlpha = AlphaShift >= 0
+    };
+
+    static inline int red(Type pixel)
+    {
+        return (pixel >> RedShift) & 0xff;
+    }
+
+    static inline int green(Type pixel)
+    {
+        return (pixel >> GreenShift) & 0xff;
+    }
+
+    static inline int blue(Type pixel)
+    {
+        return (pixel >> BlueShift) & 0xff;
+    }
+
+    static inline int alpha(Type pixel)
+    {
+        return HasAlpha? (pixel >> (HasAlpha? AlphaShift: 0)) & 0xff: 0xff;
+    }
+
+    static inline Type pack(int r, int g, int b, int a=0xff)
+    {
+        return Type(r & 0xff) << RedShift
+             | Type(g & 0xff) << GreenShift
+             | Type(b & 0xff) << BlueShift
+             | Type(HasAlpha? a & 0xff: 0xff) << (HasAlpha? AlphaShift: 24);
+    }
+};
+
+// QImage::Format_ARGB32, the format used by most of the effects.
+struct AkPixelFormatARGB32: public AkPixelFormat32<16, 8, 0, 24>
+{
+    static inline QImage::Format imageFormat()
+    {
+        return QImage::Format_ARGB32;
+    }
+};
+
+// QImage::Format_RGB32, alpha is ignored on read and set opaque on write.
+struct AkPixelFormatRGB32: public AkPixelFormat32<16, 8, 0, -1>
+{
+    static inline QImage::Format imageFormat()
+    {
+        return QImage::Format_RGB32;
+    }
+};
+
+// QImage::Format_RGBA8888, byte ordered, so the shifts depend on endianness.
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+struct AkPixelFormatRGBA8888: public AkPixelFormat32<0, 8, 16, 24>
+#else
+struct AkPixelFormatRGBA8888: public AkPixelFormat32<24, 16, 8, 0>
+#endif
+{
+    static inline QImage::Format imageFormat()
+    {
+        return QImage::Format_RGBA8888;
+    }
+};
+
+/* Per channel pixel value, used for accumulators, integral images and
+ * histograms.
+ */
+template<typename T>
+class AkPixel
+{
+    public:
+        AkPixel():
+            r(0), g(0), b(0), a(0)
+        {
+        }
+
+        AkPixel(T r, T g, T b, T a=0):
+            r(r), g(g), b(b), a(a)
+        {
+        }
+
+        template<typename R>
+        AkPixel(const AkPixel<R> &other):
+            r(T(other.r)), g(T(other.g)), b(T(other.b)), a(T(other.a))
+        {
+        }
+
+        AkPixel &operator =(QRgb pixel)
+        {
+            this->r = T(qRed(pixel));
+            this->g = T(qGreen(pixel));
+            this->b = T(qBlue(pixel));
+            this->a = T(qAlpha(pixel));
+
+            return *this;
+        }
+
+        AkPixel operator +(const AkPixel &other) const
+        {
+            return AkPixel(this->r + other.r,
+                           this->g + other.g,
+                           this->b + other.b,
+                           this->a + other.a);
+        }
+
+        AkPixel operator +(int c) const
+        {
+            return AkPixel(this->r + c,
+                           this->g + c,
+                           this->b + c,
+                           this->a + c);
+        }
+
+        template<typename R>
+        AkPixel operator -(const AkPixel<R> &other) const
+        {
+            return AkPixel(this->r - other.r,
+                           this->g - other.g,
+                           this->b - other.b,
+                           this->a - other.a);
+        }
+
+        template<typename R>
+        AkPixel operator *(const AkPixel<R> &other) const
+        {
+            return AkPixel(this->r * other.r,
+                           this->g * other.g,
+                           this->b * other.b,
+                           this->a * other.a);
+        }
+
+        template<typename R>
+        AkPixel<R> operator /(R c) const
+        {
+            return AkPixel<R>(R(this->r / c),
+                              R(this->g / c),
+                              R(this->b / c),
+                              R(this->a / c));
+        }
+
+        AkPixel operator <<(int bits) const
+        {
+            return AkPixel(this->r << bits,
+                           this->g << bits,
+                           this->b << bits,
+                           this->a << bits);
+        }
+
+        template<typename R>
+        AkPixel operator |(const AkPixel<R> &other) const
+        {
+            return AkPixel(this->r | other.r,
+                           this->g | other.g,
+                           this->b | other.b,
+                           this->a | other.a);
+        }
+
+        template<typename R>
+        AkPixel &operator +=(const AkPixel<R> &other)
+        {
+            this->r += other.r;
+            this->g += other.g;
+            this->b += other.b;
+            this->a += other.a;
+
+            return *this;
+        }
+
+        AkPixel &operator +=(QRgb pixel)
+        {
+            this->r += qRed(pixel);
+            this->g += qGreen(pixel);
+            this->b += qBlue(pixel);
+            this->a += qAlpha(pixel);
+
+            return *this;
+        }
+
+        AkPixel &operator -=(QRgb pixel)
+        {
+            this->r -= qRed(pixel);
+            this->g -= qGreen(pixel);
+            this->b -= qBlue(pixel);
+            this->a -= qAlpha(pixel);
+
+            return *this;
+        }
+
+        void clear()
+        {
+            this->r = 0;
+            this->g = 0;
+            this->b = 0;
+            this->a = 0;
+        }
+
+        T r;
+        T g;
+        T b;
+        T a;
+};
+
+typedef AkPixel<qint8> AkPixelI8;
+typedef AkPixel<quint8> AkPixelU8;
+typedef AkPixel<quint16> AkPixelU16;
+typedef AkPixel<qint32> AkPixelI32;
+typedef AkPixel<quint32> AkPixelU32;
+typedef AkPixel<qint64> AkPixelI64;
+typedef AkPixel<quint64> AkPixelU64;
+typedef AkPixel<qreal> AkPixelReal;
+
+template<typename S, typename T>
+inline typename std::enable_if<std::is_arithmetic<S>::value, AkPixel<T>>::type
+operator *(S c, const AkPixel<T> &pixel)
+{
+    return AkPixel<T>(T(c * pixel.r),
+                      T(c * pixel.g),
+                      T(c * pixel.b),
+                      T(c * pixel.a));
+}
+
+template<typename R, typename S>
+inline AkPixel<R> akPixelMult(R c, const AkPixel<S> &pixel)
+{
+    return AkPixel<R>(c * pixel.r,
+                      c * pixel.g,
+                      c * pixel.b,
+                      c * pixel.a);
+}
+
+inline AkPixelU64 akPixelPow2(QRgb pixel)
+{
+    quint64 r = quint64(qRed(pixel));
+    quint64 g = quint64(qGreen(pixel));
+    quint64 b = quint64(qBlue(pixel));
+    quint64 a = quint64(qAlpha(pixel));
+
+    return AkPixelU64(r * r, g * g, b * b, a * a);
+}
+
+template<typename T>
+inline AkPixel<T> akPixelPow2(const AkPixel<T> &pixel)
+{
+    return AkPixel<T>(pixel.r * pixel.r,
+                      pixel.g * pixel.g,
+                      pixel.b * pixel.b,
+                      pixel.a * pixel.a);
+}
+
+template<typename T>
+inline AkPixel<T> akPixelSqrt(const AkPixel<T> &pixel)
+{
+    return AkPixel<T>(T(std::sqrt(pixel.r)),
+                      T(std::sqrt(pixel.g)),
+                      T(std::sqrt(pixel.b)),
+                      T(std::sqrt(pixel.a)));
+}
+
+template<typename T>
+inline AkPixel<T> akPixelBound(T min, const AkPixel<T> &pixel, T max)
+{
+    return AkPixel<T>(qBound(min, pixel.r, max),
+                      qBound(min, pixel.g, max),
+                      qBound(min, pixel.b, max),
+                      qBound(min, pixel.a, max));
+}
+
+/* Sum of the kw x kh rectangle at (x, y) of an integral image with one
+ * extra leading row and column.
+ */
+template<typename T>
+inline AkPixel<T> akPixelIntegralSum(const AkPixel<T> *integral,
+                                     int lineWidth,
+                                     int x, int y, int kw, int kh)
+{
+    const AkPixel<T> *p0 = integral + x + y * lineWidth;
+    const AkPixel<T> *p1 = p0 + kw;
+    const AkPixel<T> *p2 = p0 + kh * lineWidth;
+    const AkPixel<T> *p3 = p2 + kw;
+
+    return *p0 + *p3 - *p1 - *p2;
+}
+
+/* Per line and per pixel loops over a QImage, specialized at compile time on
+ * the pixel Format.
+ *
+ * The callbacks are inlined in the innermost loop, so simple arithmetic
+ * kernels get auto-vectorized by the compiler. When threaded is true the
+ * lines are split in bands that run on the global AkWorkerPool, the tag
+ * names the caller in the pool statistics.
+ */
+template<typename Format=AkPixelFormatARGB32>
+class AkPixelKernel
+{
+    public:
+        typedef typename Format::Type Type;
+
+        enum
+        {
+            MinBandLines = 16
+        };
+
+        // Calls func(first, last) for consecutive ranges of [0, lines).
+        template<typename Func>
+        static void forEachBand(int lines,
+                                const Func &func,
+                                bool threaded,
+                                const char *tag=nullptr)
+        {
+            auto pool = threaded? AkWorkerPool::globalInstance(): nullptr;
+
+            if (pool)
+                pool->parallelFor(lines, MinBandLines, func, tag);
+            else
+                func(0, lines);
+        }
+
+        // Calls func(y, line) for each line of image.
+        template<typename LineFunc>
+        static void forEachLine(QImage &image,
+                                const LineFunc &func,
+                                bool threaded=false,
+                                const char *tag=nullptr)
+        {
+            Q_ASSERT(image.format() == Format::imageFormat());
+
+            /* Detach here, scanLine() detaches too and isn't safe to call
+             * from the workers.
+             */
+            auto bits = image.bits();
+            auto lineSize = image.bytesPerLine();
+
+            forEachBand(image.height(), [bits, lineSize, &func] (int first,
+                                                                 int last) {
+                for (int y = first; y < last; y++)
+                    func(y, reinterpret_cast<Type *>(bits + y * lineSize));
+            }, threaded, tag);
+        }
+
+        // Calls func(y, srcLine, dstLine) for each line of src.
+        template<typename LineFunc>
+        static void forEachLine(const QImage &src,
+                                QImage &dst,
+                                const LineFunc &func,
+                                bool threaded=false,
+                                const char *tag=nullptr)
+        {
+            Q_ASSERT(src.format() == Format::imageFormat());
+            Q_ASSERT(dst.format() == Format::imageFormat());
+            Q_ASSERT(src.size() == dst.size());
+
+            /* Detach here, scanLine() detaches too and isn't safe to call
+             * from the workers.
+             */
+            auto srcBits = src.constBits();
+            auto srcLineSize = src.bytesPerLine();
+            auto dstBits = dst.bits();
+            auto dstLineSize = dst.bytesPerLine();
+
+            forEachBand(src.height(), [=, &func] (int first, int last) {
+                for (int y = first; y < last; y++)
+                    func(y,
+                         reinterpret_cast<const Type *>(srcBits + y * srcLineSize),
+                         reinterpret_cast<Type *>(dstBits + y * dstLineSize));
+            }, threaded, tag);
+        }
+
+        // Calls func(pixel) for each pixel of src, in order.
+        template<typename PixelFunc>
+        static void forEachPixel(const QImage &src, const PixelFunc &func)
+        {
+            Q_ASSERT(src.format() == Format::imageFormat());
+
+            for (int y = 0; y < src.height(); y++) {
+                auto line = reinterpret_cast<const Type *>(src.constScanLine(y));
+
+                for (int x = 0; x < src.width(); x++)
+                    func(line[x]);
+            }
+        }
+
+        // dst = func(src) for each pixel, src and dst can be the same image.
+        template<typename PixelFunc>
+        static void map(const QImage &src,
+                        QImage &dst,
+                        const PixelFunc &func,
+                        bool threaded=false,
+                        const char *tag=nullptr)
+        {
+            int width = src.width();
+
+            forEachLine(src, dst, [width, &func] (int y,
+                                                  const Type *srcLine,
+                                                  Type *dstLine) {
+                Q_UNUSED(y)
+
+                for (int x = 0; x < width; x++)
+                    dstLine[x] = func(srcLine[x]);
+            }, threaded, tag);
+        }
+
+        /* Replaces each component with its entry in the 256 levels table of
+         * the channel. A null table leaves the channel untouched.
+         */
+        static void lookup(const QImage &src,
+                           QImage &dst,
+                           const quint8 *redTable,
+                           const quint8 *greenTable,
+                           const quint8 *blueTable,
+                           const quint8 *alphaTable=nullptr,
+                           bool threaded=false,
+                           const char *tag=nullptr)
+        {
+            quint8 identity[256];
+
+            for (int i = 0; i < 256; i++)
+                identity[i] = quint8(i);
+
+            const quint8 *rt = redTable? redTable: identity;
+            const quint8 *gt = greenTable? greenTable: identity;
+            const quint8 *bt = blueTable? blueTable: identity;
+            const quint8 *at = alphaTable? alphaTable: identity;
+
+            map(src, dst, [rt, gt, bt, at] (Type pixel) {
+                return Format::pack(rt[Format::red(pixel)],
+                                    gt[Format::green(pixel)],
+                                    bt[Format::blue(pixel)],
+                                    at[Format::alpha(pixel)]);
+            }, threaded, tag);
+        }
+
+        // Fills the 256 levels histogram of each channel.
+        static void histogram(const QImage &src, AkPixelU32 *histogram)
+        {
+            for (int i = 0; i < 256; i++)
+                histogram[i].clear();
+
+            forEachPixel(src, [histogram] (Type pixel) {
+                histogram[Format::red(pixel)].r++;
+                histogram[Format::green(pixel)].g++;
+                histogram[Format::blue(pixel)].b++;
+                histogram[Format::alpha(pixel)].a++;
+            });
+        }
+};
+
+#endif // AKPIXEL_H
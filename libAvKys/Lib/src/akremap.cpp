@@ -0,0 +1,128 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QVector>
+
+#include "akremap.h"
+#include "akpixel.h"
+
+class AkRemapPrivate
+{
+    public:
+        QSize m_size;
+        int m_stride;
+        QVector<qint32> m_offsets;
+
+        AkRemapPrivate():
+            m_stride(0)
+        {
+        }
+};
+
+AkRemap::AkRemap()
+{
+    this->d = new AkRemapPrivate;
+}
+
+AkRemap::~AkRemap()
+{
+    delete this->d;
+}
+
+QSize AkRemap::size() const
+{
+    return this->d->m_size;
+}
+
+int AkRemap::stride() const
+{
+    return this->d->m_stride;
+}
+
+bool AkRemap::fits(const QImage &image) const
+{
+    return !this->d->m_offsets.isEmpty()
+           && image.size() == this->d->m_size
+           && AkRemap::stride(image) == this->d->m_stride;
+}
+
+bool AkRemap::isEmpty() const
+{
+    return this->d->m_offsets.isEmpty();
+}
+
+void AkRemap::build(const QSize &size,
+                    int stride,
+                    const LineFunc &func,
+                    bool threaded,
+                    const char *tag)
+{
+    int width = size.width();
+    int height = size.height();
+
+    if (width < 1 || height < 1 || stride < width) {
+        this->clear();
+
+        return;
+    }
+
+    // The buffer is reused as long as the frame size doesn't change.
+    this->d->m_size = size;
+    this->d->m_stride = stride;
+    this->d->m_offsets.resize(width * height);
+    auto offsets = this->d->m_offsets.data();
+
+    AkPixelKernel<>::forEachBand(height, [&] (int first, int last) {
+        for (int y = first; y < last; y++)
+            func(y, width, stride, offsets + y * width);
+    }, threaded, tag? tag: "AkRemap");
+}
+
+void AkRemap::clear()
+{
+    this->d->m_size = QSize();
+    this->d->m_stride = 0;
+    this->d->m_offsets.clear();
+}
+
+void AkRemap::apply(const QImage &src,
+                    QImage &dst,
+                    bool threaded,
+                    const char *tag) const
+{
+    if (!this->fits(src)) {
+        dst = src.copy();
+
+        return;
+    }
+
+    // The offsets already account for the line padding of src.
+    auto pixels = reinterpret_cast<const QRgb *>(src.constBits());
+    auto offsets = this->d->m_offsets.constData();
+    int width = src.width();
+
+    AkPixelKernel<>::forEachLine(dst, [&] (int y, QRgb *oLine) {
+        auto lineOffsets = offsets + y * width;
+
+        for (int x = 0; x < width; x++) {
+            qint32 offset = lineOffsets[x];
+            oLine[x] = offset < 0? qRgba(0, 0, 0, 0): pixels[offset];
+        }
+    }, threaded, tag? tag: "AkRemap");
+}
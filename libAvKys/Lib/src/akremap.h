@@ -0,0 +1,92 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKREMAP_H
+#define AKREMAP_H
+
+#include <functional>
+#include <QImage>
+
+#include "akcommons.h"
+
+class AkRemapPrivate;
+
+/* Cached geometric transform.
+ *
+ * Holds, for each pixel of the output frame, the index (y * stride + x) of
+ * the source pixel it is copied from, or -1 for a transparent pixel. The
+ * stride is the source line size in pixels, which is not always the width:
+ * frames wrapped from a packet keep the padding of their lines. Effects whose
+ * mapping only depends on the frame layout and their parameters build() the
+ * map once, and then apply() is a plain gather over the lines in parallel.
+ */
+class AKCOMMONS_EXPORT AkRemap
+{
+    Q_DISABLE_COPY(AkRemap)
+
+    public:
+        /* Fills the offsets of the width pixels of the output line y, for a
+         * source with lines of stride pixels.
+         */
+        typedef std::function<void (int y,
+                                    int width,
+                                    int stride,
+                                    qint32 *offsets)> LineFunc;
+
+        AkRemap();
+        ~AkRemap();
+
+        QSize size() const;
+        int stride() const;
+        bool isEmpty() const;
+
+        // True if the map was built for the layout of image.
+        bool fits(const QImage &image) const;
+
+        void build(const QSize &size,
+                   int stride,
+                   const LineFunc &func,
+                   bool threaded=true,
+                   const char *tag=nullptr);
+        void clear();
+
+        /* src and dst must be QImage::Format_ARGB32 frames, and the map must
+         * fit src, otherwise src is just copied.
+         */
+        void apply(const QImage &src,
+                   QImage &dst,
+                   bool threaded=true,
+                   const char *tag=nullptr) const;
+
+        static inline qint32 offset(int x, int y, int stride)
+        {
+            return y * stride + x;
+        }
+
+        // Line size of image in pixels.
+        static inline int stride(const QImage &image)
+        {
+            return image.bytesPerLine() / int(sizeof(QRgb));
+        }
+
+    private:
+        AkRemapPrivate *d;
+};
+
+#endif // AKREMAP_H
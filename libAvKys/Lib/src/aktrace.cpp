@@ -0,0 +1,302 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <QCoreApplication>
+
+#include "aktrace.h"
+
+// Keep the memory bounded if the trace is left running.
+#define MAX_EVENTS (4 * 1024 * 1024)
+
+struct AkTraceEvent
+{
+    QByteArray name;
+    const char *category;
+    qint64 start;
+    qint64 duration;
+    int thread;
+    qint64 id;
+    qint64 pts;
+};
+
+class AkTracePrivate
+{
+    public:
+        QAtomicInt m_active;
+        QString m_fileName;
+        QElapsedTimer m_timer;
+        QVector<AkTraceEvent> m_events;
+        QMap<Qt::HANDLE, int> m_threads;
+        QStringList m_threadNames;
+        quint64 m_lost;
+        QMutex m_mutex;
+
+        AkTracePrivate():
+            m_active(0),
+            m_lost(0)
+        {
+        }
+
+        inline int threadIndex();
+        inline bool write();
+        inline static QByteArray escape(const QByteArray &str);
+};
+
+Q_GLOBAL_STATIC(AkTrace, akTrace)
+
+AkTrace::AkTrace()
+{
+    this->d = new AkTracePrivate;
+    auto fileName = qgetenv("AK_TRACE_FILE");
+
+    if (!fileName.isEmpty())
+        this->start(QString::fromLocal8Bit(fileName));
+}
+
+AkTrace::~AkTrace()
+{
+    this->stop();
+    delete this->d;
+}
+
+AkTrace *AkTrace::globalInstance()
+{
+    return akTrace;
+}
+
+bool AkTrace::isActive() const
+{
+    return this->d->m_active.load();
+}
+
+bool AkTrace::start(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return false;
+
+    this->stop();
+
+    this->d->m_mutex.lock();
+    this->d->m_fileName = fileName;
+    this->d->m_events.clear();
+    this->d->m_threads.clear();
+    this->d->m_threadNames.clear();
+    this->d->m_lost = 0;
+    this->d->m_timer.start();
+    this->d->m_active.store(1);
+    this->d->m_mutex.unlock();
+
+    return true;
+}
+
+bool AkTrace::stop()
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+
+    if (!this->d->m_active.fetchAndStoreOrdered(0))
+        return false;
+
+    bool ok = this->d->write();
+    this->d->m_events.clear();
+
+    return ok;
+}
+
+qint64 AkTrace::now() const
+{
+    return this->d->m_timer.nsecsElapsed();
+}
+
+void AkTrace::addSpan(const QByteArray &name,
+                      const char *category,
+                      qint64 start,
+                      qint64 duration,
+                      qint64 id,
+                      qint64 pts)
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+
+    if (!this->d->m_active.load())
+        return;
+
+    if (this->d->m_events.size() >= MAX_EVENTS) {
+        this->d->m_lost++;
+
+        return;
+    }
+
+    this->d->m_events << AkTraceEvent {
+        name,
+        category,
+        start,
+        duration,
+        this->d->threadIndex(),
+        id,
+        pts
+    };
+}
+
+int AkTracePrivate::threadIndex()
+{
+    auto threadId = QThread::currentThreadId();
+    auto it = this->m_threads.find(threadId);
+
+    if (it != this->m_threads.end())
+        return it.value();
+
+    int index = this->m_threadNames.size();
+    this->m_threads[threadId] = index;
+    auto threadName = QThread::currentThread()->objectName();
+
+    if (threadName.isEmpty())
+        threadName = qApp && QThread::currentThread() == qApp->thread()?
+                         QString("Main"):
+                         QString("Thread %1").arg(index);
+
+    this->m_threadNames << threadName;
+
+    return index;
+}
+
+bool AkTracePrivate::write()
+{
+    QFile file(this->m_fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    qint64 pid = QCoreApplication::applicationPid();
+    file.write("{\"traceEvents\":[\n");
+
+    for (int i = 0; i < this->m_threadNames.size(); i++)
+        file.write(QString("{\"ph\":\"M\",\"name\":\"thread_name\","
+                           "\"pid\":%1,\"tid\":%2,"
+                           "\"args\":{\"name\":\"%3\"}},\n")
+                   .arg(pid)
+                   .arg(i)
+                   .arg(QString::fromUtf8(escape(this->m_threadNames[i].toUtf8())))
+                   .toUtf8());
+
+    for (auto &event: this->m_events) {
+        QByteArray args;
+
+        if (event.id >= 0)
+            args += "\"id\":" + QByteArray::number(event.id);
+
+        if (event.pts != AkNoPts<qint64>()) {
+            if (!args.isEmpty())
+                args += ',';
+
+            args += "\"pts\":" + QByteArray::number(event.pts);
+        }
+
+        // Timestamps are in microseconds.
+        file.write("{\"ph\":\"X\",\"name\":\"" + escape(event.name)
+                   + "\",\"cat\":\"" + escape(event.category)
+                   + "\",\"pid\":" + QByteArray::number(pid)
+                   + ",\"tid\":" + QByteArray::number(event.thread)
+                   + ",\"ts\":" + QByteArray::number(qreal(event.start) / 1e3, 'f', 3)
+                   + ",\"dur\":" + QByteArray::number(qreal(event.duration) / 1e3, 'f', 3)
+                   + ",\"args\":{" + args + "}},\n");
+    }
+
+    file.write(QString("{\"ph\":\"M\",\"name\":\"process_name\","
+                       "\"pid\":%1,\"args\":{\"name\":\"%2\","
+                       "\"lostEvents\":%3}}\n]}\n")
+               .arg(pid)
+               .arg(QString::fromUtf8(escape(QCoreApplication::applicationName().toUtf8())))
+               .arg(this->m_lost).toUtf8());
+
+    return true;
+}
+
+QByteArray AkTracePrivate::escape(const QByteArray &str)
+{
+    QByteArray escaped;
+    escaped.reserve(str.size());
+
+    for (auto c: str)
+        if (c == '"' || c == '\\')
+            escaped += '\\' + QByteArray(1, c);
+        else if (uchar(c) < 0x20)
+            escaped += QString("\\u%1").arg(int(c), 4, 16, QChar('0')).toUtf8();
+        else
+            escaped += c;
+
+    return escaped;
+}
+
+AkTraceScope::AkTraceScope(const char *name,
+                           const char *category,
+                           qint64 id,
+                           qint64 pts):
+    m_name(name),
+    m_category(category),
+    m_start(-1),
+    m_id(id),
+    m_pts(pts)
+{
+    auto trace = AkTrace::globalInstance();
+
+    if (trace->isActive())
+        this->m_start = trace->now();
+}
+
+AkTraceScope::AkTraceScope(const char *name,
+                           const char *category,
+                           const AkPacket &packet):
+    AkTraceScope(name, category, packet.id(), packet.pts())
+{
+}
+
+AkTraceScope::~AkTraceScope()
+{
+    if (this->m_start < 0)
+        return;
+
+    auto trace = AkTrace::globalInstance();
+
+    if (trace->isActive())
+        trace->addSpan(QByteArray::fromRawData(this->m_name,
+                                               int(qstrlen(this->m_name))),
+                       this->m_category,
+                       this->m_start,
+                       trace->now() - this->m_start,
+                       this->m_id,
+                       this->m_pts);
+}
+
+void AkTraceScope::setPacket(const AkPacket &packet)
+{
+    this->setPacket(packet.id(), packet.pts());
+}
+
+void AkTraceScope::setPacket(qint64 id, qint64 pts)
+{
+    this->m_id = id;
+    this->m_pts = pts;
+}
@@ -0,0 +1,88 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKTRACE_H
+#define AKTRACE_H
+
+#include "akpacket.h"
+
+class AkTracePrivate;
+
+/* Records spans of the pipeline execution and writes them as a Chrome
+ * trace (JSON), readable with chrome://tracing or Perfetto.
+ *
+ * Tracing is disabled by default, it can be enabled from code with start()
+ * or by setting the AK_TRACE_FILE environment variable to the output file.
+ * While disabled, a trace point only costs an atomic read.
+ */
+class AKCOMMONS_EXPORT AkTrace
+{
+    Q_DISABLE_COPY(AkTrace)
+
+    public:
+        AkTrace();
+        ~AkTrace();
+
+        static AkTrace *globalInstance();
+
+        bool isActive() const;
+        bool start(const QString &fileName);
+        bool stop();
+
+        // Nanoseconds since the trace was started.
+        qint64 now() const;
+        void addSpan(const QByteArray &name,
+                     const char *category,
+                     qint64 start,
+                     qint64 duration,
+                     qint64 id=-1,
+                     qint64 pts=AkNoPts<qint64>());
+
+    private:
+        AkTracePrivate *d;
+};
+
+// Records a span from its construction to its destruction.
+class AKCOMMONS_EXPORT AkTraceScope
+{
+    Q_DISABLE_COPY(AkTraceScope)
+
+    public:
+        AkTraceScope(const char *name,
+                     const char *category,
+                     qint64 id=-1,
+                     qint64 pts=AkNoPts<qint64>());
+        AkTraceScope(const char *name,
+                     const char *category,
+                     const AkPacket &packet);
+        ~AkTraceScope();
+
+        // Set the frame ids, when they are only known at the end of the span.
+        void setPacket(const AkPacket &packet);
+        void setPacket(qint64 id, qint64 pts);
+
+    private:
+        const char *m_name;
+        const char *m_category;
+        qint64 m_start;
+        qint64 m_id;
+        qint64 m_pts;
+};
+
+#endif // AKTRACE_H
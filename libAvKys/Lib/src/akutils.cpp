@@ -19,6 +19,8 @@
 
 #include <QVariant>
 #include <QMap>
+#include <QMultiHash>
+#include <QMutex>
 #include <QImage>
 
 #include "akutils.h"
@@ -26,6 +28,8 @@
 #include "akvideocaps.h"
 #include "akpacket.h"
 #include "akvideopacket.h"
+#include "akvideoconverter.h"
+#include "akvideobufferpool.h"
 
 typedef QMap<QImage::Format, AkVideoCaps::PixelFormat> ImageToPixelFormatMap;
 
@@ -47,20 +51,179 @@ inline ImageToPixelFormatMap initImageToPixelFormatMap()
 
 Q_GLOBAL_STATIC_WITH_ARGS(ImageToPixelFormatMap, AkImageToFormat, (initImageToPixelFormatMap()))
 
+/* Keeps track of the frame buffers that are currently wrapped by a QImage.
+ *
+ * The QImage does not own the memory, instead it holds a reference to the
+ * QByteArray that does, and that reference is released through the QImage
+ * cleanup function once the last copy of the image is gone. Meanwhile, the
+ * buffer can be found again from the image bits, so the image can be turned
+ * back into a packet without copying a single pixel.
+ */
+class AkFrameBuffers
+{
+    public:
+        QMutex m_mutex;
+        QMultiHash<const uchar *, QByteArray *> m_buffers;
+
+        // Full frame copies done by packetToImage() and imageToPacket().
+        QAtomicInteger<quint64> m_copies;
+
+        inline QImage wrap(const QByteArray &buffer,
+                           int width,
+                           int height,
+                           int bytesPerLine,
+                           QImage::Format format);
+        inline QImage create(int width,
+                             int height,
+                             QImage::Format format);
+        inline QByteArray buffer(const QImage &image, int size);
+        inline static void releaseAdopted();
+        static void release(void *userData);
+};
+
+Q_GLOBAL_STATIC(AkFrameBuffers, akFrameBuffers)
+
+/* A writable image is not detached when its data is not shared, so after its
+ * buffer was adopted by a packet, writing to it again would change that
+ * packet. A copy of every adopted image is kept until it's the only one left,
+ * so writing to the image detaches it meanwhile. Each thread keeps the images
+ * it adopted, usually the output of the frame being processed, and releases
+ * them when it creates or adopts the next frame, so no lock is needed.
+ */
+static thread_local QList<QImage> akAdoptedFrames;
+
+QImage AkFrameBuffers::wrap(const QByteArray &buffer,
+                            int width,
+                            int height,
+                            int bytesPerLine,
+                            QImage::Format format)
+{
+    auto frameBuffer = new QByteArray(buffer);
+
+    this->m_mutex.lock();
+    this->m_buffers.insert(reinterpret_cast<const uchar *>(frameBuffer->constData()),
+                           frameBuffer);
+    this->m_mutex.unlock();
+
+    // Read-only image, writing to it will detach it from the buffer.
+    return QImage(reinterpret_cast<const uchar *>(frameBuffer->constData()),
+                  width,
+                  height,
+                  bytesPerLine,
+                  format,
+                  AkFrameBuffers::release,
+                  frameBuffer);
+}
+
+QImage AkFrameBuffers::create(int width, int height, QImage::Format format)
+{
+    AkFrameBuffers::releaseAdopted();
+
+    int bytesPerLine = ((width * QImage::toPixelFormat(format).bitsPerPixel() + 31) >> 5) << 2;
+
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkImageToFormat->value(format, AkVideoCaps::Format_none);
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = width;
+    caps.height() = height;
+    auto frameBuffer =
+            new QByteArray(AkVideoBufferPool::globalInstance()->buffer(caps,
+                                                                       bytesPerLine * height));
+
+    this->m_mutex.lock();
+    this->m_buffers.insert(reinterpret_cast<const uchar *>(frameBuffer->constData()),
+                           frameBuffer);
+    this->m_mutex.unlock();
+
+    return QImage(reinterpret_cast<uchar *>(AkVideoBufferPool::data(*frameBuffer)),
+                  width,
+                  height,
+                  bytesPerLine,
+                  format,
+                  AkFrameBuffers::release,
+                  frameBuffer);
+}
+
+QByteArray AkFrameBuffers::buffer(const QImage &image, int size)
+{
+    AkFrameBuffers::releaseAdopted();
+
+    this->m_mutex.lock();
+    auto frameBuffer = this->m_buffers.value(image.constBits(), nullptr);
+    QByteArray buffer;
+
+    if (frameBuffer && frameBuffer->size() == size)
+        buffer = *frameBuffer;
+
+    this->m_mutex.unlock();
+
+    if (buffer.isEmpty())
+        return buffer;
+
+    // One copy of the image is enough, however many times it was adopted.
+    for (auto &frame: akAdoptedFrames)
+        if (frame.constBits() == image.constBits())
+            return buffer;
+
+    akAdoptedFrames << image;
+
+    return buffer;
+}
+
+void AkFrameBuffers::releaseAdopted()
+{
+    // Releasing an image may call release(), so this is done out of the lock.
+    for (auto it = akAdoptedFrames.begin(); it != akAdoptedFrames.end();)
+        if (it->isDetached())
+            it = akAdoptedFrames.erase(it);
+        else
+            it++;
+}
+
+void AkFrameBuffers::release(void *userData)
+{
+    auto frameBuffer = reinterpret_cast<QByteArray *>(userData);
+
+    if (!akFrameBuffers.isDestroyed()) {
+        akFrameBuffers->m_mutex.lock();
+        akFrameBuffers->m_buffers.remove(reinterpret_cast<const uchar *>(frameBuffer->constData()),
+                                         frameBuffer);
+        akFrameBuffers->m_mutex.unlock();
+    }
+
+    delete frameBuffer;
+}
+
 AkPacket AkUtils::imageToPacket(const QImage &image, const AkPacket &defaultPacket)
 {
     if (!AkImageToFormat->contains(image.format()))
         return AkPacket();
 
-    size_t imageSize = size_t(image.bytesPerLine()) * size_t(image.height());
-    QByteArray oBuffer(int(imageSize), 0);
-    memcpy(oBuffer.data(), image.constBits(), imageSize);
+    int imageSize = image.bytesPerLine() * image.height();
 
     AkVideoCaps caps(defaultPacket.caps());
     caps.format() = AkImageToFormat->value(image.format());
     caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
     caps.width() = image.width();
     caps.height() = image.height();
+    caps.resetLayout();
+
+    // Keep the image lines as they are, just describe them in the caps.
+    if (caps.lineSize(0) != image.bytesPerLine())
+        caps.setLineSize(0, image.bytesPerLine());
+
+    // If the image was created from a frame buffer, adopt it, otherwise copy
+    // the pixels to a new buffer.
+    QByteArray oBuffer = akFrameBuffers->buffer(image, imageSize);
+
+    if (oBuffer.isEmpty()) {
+        oBuffer = AkVideoBufferPool::globalInstance()->buffer(caps, imageSize);
+        memcpy(AkVideoBufferPool::data(oBuffer),
+               image.constBits(),
+               size_t(imageSize));
+        akFrameBuffers->m_copies.fetchAndAddRelaxed(1);
+    }
 
     AkPacket packet = defaultPacket;
     packet.setCaps(caps.toCaps());
@@ -76,21 +239,69 @@ QImage AkUtils::packetToImage(const AkPacket &packet)
     if (!caps)
         return QImage();
 
-    if (!AkImageToFormat->values().contains(caps.format()))
+    if (!AkImageToFormat->values().contains(caps.format())) {
+        // Camera native formats (YUYV, NV12, ...) are converted natively.
+        if (!AkVideoConverter::canConvert(caps.format()))
+            return QImage();
+
+        AkVideoConverter converter;
+        auto videoPacket = converter.convert(packet, AkVideoCaps::Format_0rgb);
+
+        if (!videoPacket)
+            return QImage();
+
+        return AkUtils::packetToImage(videoPacket.toPacket());
+    }
+
+    if (caps.width() < 1 || caps.height() < 1)
         return QImage();
 
-    QImage image(caps.width(),
-                 caps.height(),
-                 AkImageToFormat->key(caps.format()));
-    memcpy(image.bits(), packet.buffer().constData(), size_t(packet.buffer().size()));
+    auto format = AkImageToFormat->key(caps.format());
+    auto buffer = packet.buffer();
+    int bytesPerLine = caps.lineSize(0);
+    int offset = caps.planeOffset(0);
+    int minBytesPerLine =
+            (caps.width() * QImage::toPixelFormat(format).bitsPerPixel() + 7) >> 3;
+
+    if (bytesPerLine < minBytesPerLine
+        || buffer.size() < offset + bytesPerLine * caps.height())
+        return QImage();
+
+    // Share the packet buffer with the image whenever the lines are properly
+    // aligned.
+    if (offset == 0 && (bytesPerLine & 0x3) == 0)
+        return akFrameBuffers->wrap(buffer,
+                                    caps.width(),
+                                    caps.height(),
+                                    bytesPerLine,
+                                    format);
+
+    QImage image(caps.width(), caps.height(), format);
+    auto iLineSize = size_t(qMin(bytesPerLine, image.bytesPerLine()));
 
-    if (caps.format() == AkVideoCaps::Format_gray)
-        for (int i = 0; i < 256; i++)
-            image.setColor(i, QRgb(i));
+    for (int y = 0; y < caps.height(); y++)
+        memcpy(image.scanLine(y),
+               buffer.constData() + offset + y * bytesPerLine,
+               iLineSize);
+
+    akFrameBuffers->m_copies.fetchAndAddRelaxed(1);
 
     return image;
 }
 
+QImage AkUtils::frameImage(const QSize &size, QImage::Format format)
+{
+    if (size.isEmpty() || format == QImage::Format_Invalid)
+        return QImage();
+
+    return akFrameBuffers->create(size.width(), size.height(), format);
+}
+
+quint64 AkUtils::frameCopies()
+{
+    return akFrameBuffers->m_copies.load();
+}
+
 AkPacket AkUtils::roundSizeTo(const AkPacket &packet, int align)
 {
     int frameWidth = packet.caps().property("width").toInt();
@@ -136,13 +347,20 @@ AkVideoPacket AkUtils::convertVideo(const AkVideoPacket &packet,
                                     AkVideoCaps::PixelFormat format,
                                     const QSize &size)
 {
-    if (!AkImageToFormat->values().contains(format))
-        return AkVideoPacket();
-
     if (packet.caps().format() == format
         && (size.isEmpty() || packet.caps().size() == size))
         return packet;
 
+    if (AkVideoConverter::canConvert(packet.caps().format())
+        && AkVideoConverter::canConvert(format)) {
+        AkVideoConverter converter;
+
+        return converter.convert(packet, format, size);
+    }
+
+    if (!AkImageToFormat->values().contains(format))
+        return AkVideoPacket();
+
     QImage frame = AkUtils::packetToImage(packet.toPacket());
 
     if (frame.isNull())
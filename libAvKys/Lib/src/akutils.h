@@ -21,6 +21,7 @@
 #define AKUTILS_H
 
 #include <QSize>
+#include <QImage>
 
 #include "akvideocaps.h"
 
@@ -32,6 +33,13 @@ namespace AkUtils
     AKCOMMONS_EXPORT AkPacket imageToPacket(const QImage &image,
                                             const AkPacket &defaultPacket);
     AKCOMMONS_EXPORT QImage packetToImage(const AkPacket &packet);
+    AKCOMMONS_EXPORT QImage frameImage(const QSize &size,
+                                       QImage::Format format);
+
+    /* Number of times packetToImage() and imageToPacket() copied the whole
+     * frame because they could not share it.
+     */
+    AKCOMMONS_EXPORT quint64 frameCopies();
     AKCOMMONS_EXPORT AkPacket roundSizeTo(const AkPacket &packet, int align);
     AKCOMMONS_EXPORT AkVideoPacket convertVideo(const AkVideoPacket &packet,
                                                 AkVideoCaps::PixelFormat format,
@@ -0,0 +1,204 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+#include "akvideobufferpool.h"
+#include "akcaps.h"
+#include "akvideocaps.h"
+
+// Pools not requested for this number of buffer requests are released.
+#define IDLE_REQUESTS 256
+
+struct AkVideoBufferKey
+{
+    AkCapsValue value;
+    int size;
+
+    inline bool operator ==(const AkVideoBufferKey &other) const
+    {
+        return this->size == other.size && this->value == other.value;
+    }
+};
+
+inline uint qHash(const AkVideoBufferKey &key, uint seed=0)
+{
+    return qHash(key.value, seed) ^ uint(key.size);
+}
+
+struct AkVideoBuffers
+{
+    QVector<QByteArray> buffers;
+    quint64 lastRequest;
+};
+
+class AkVideoBufferPoolPrivate
+{
+    public:
+        QMutex m_mutex;
+        QHash<AkVideoBufferKey, AkVideoBuffers> m_pools;
+        int m_maxBuffers;
+        quint64 m_requests;
+        quint64 m_hits;
+        quint64 m_misses;
+
+        inline QByteArray buffer(const AkVideoBufferKey &key);
+        inline static QByteArray allocate(int size);
+        inline void releaseIdle();
+};
+
+Q_GLOBAL_STATIC(AkVideoBufferPool, akVideoBufferPool)
+
+AkVideoBufferPool::AkVideoBufferPool(int maxBuffers)
+{
+    this->d = new AkVideoBufferPoolPrivate;
+    this->d->m_maxBuffers = maxBuffers;
+    this->d->m_requests = 0;
+    this->d->m_hits = 0;
+    this->d->m_misses = 0;
+}
+
+AkVideoBufferPool::~AkVideoBufferPool()
+{
+    delete this->d;
+}
+
+AkVideoBufferPool *AkVideoBufferPool::globalInstance()
+{
+    return akVideoBufferPool;
+}
+
+char *AkVideoBufferPool::data(QByteArray &buffer)
+{
+    /* A buffer just returned by buffer() is only shared with the pool, which
+     * won't hand it out again until every other copy is gone, so it can be
+     * written in place. A buffer shared with anyone else is detached as
+     * usual.
+     */
+    if (buffer.data_ptr()->ref.atomic.loadAcquire() == 2)
+        return const_cast<char *>(buffer.constData());
+
+    return buffer.data();
+}
+
+QByteArray AkVideoBufferPool::buffer(const AkVideoCaps &caps, int size)
+{
+    if (size < 0)
+        size = caps.pictureSize();
+
+    return this->d->buffer({caps.value(), size});
+}
+
+QByteArray AkVideoBufferPool::buffer(const AkCaps &caps, int size)
+{
+    // Caps without a typed value, like compressed formats, are only keyed
+    // by the buffer size.
+    return this->d->buffer({caps.cachedValue(), size});
+}
+
+int AkVideoBufferPool::maxBuffers() const
+{
+    return this->d->m_maxBuffers;
+}
+
+quint64 AkVideoBufferPool::hits() const
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+
+    return this->d->m_hits;
+}
+
+quint64 AkVideoBufferPool::misses() const
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+
+    return this->d->m_misses;
+}
+
+void AkVideoBufferPool::setMaxBuffers(int maxBuffers)
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+    this->d->m_maxBuffers = maxBuffers;
+}
+
+void AkVideoBufferPool::resetCounters()
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+    this->d->m_hits = 0;
+    this->d->m_misses = 0;
+}
+
+void AkVideoBufferPool::clear()
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+    this->d->m_pools.clear();
+}
+
+QByteArray AkVideoBufferPoolPrivate::buffer(const AkVideoBufferKey &key)
+{
+    if (key.size < 1)
+        return QByteArray();
+
+    QMutexLocker mutexLocker(&this->m_mutex);
+    this->m_requests++;
+    auto &pool = this->m_pools[key];
+    pool.lastRequest = this->m_requests;
+
+    // A buffer only referenced by the pool is not used anymore.
+    for (auto &buffer: pool.buffers)
+        if (buffer.isDetached()) {
+            this->m_hits++;
+
+            return buffer;
+        }
+
+    this->m_misses++;
+    auto buffer = AkVideoBufferPoolPrivate::allocate(key.size);
+
+    if (pool.buffers.size() < this->m_maxBuffers)
+        pool.buffers << buffer;
+
+    this->releaseIdle();
+
+    return buffer;
+}
+
+QByteArray AkVideoBufferPoolPrivate::allocate(int size)
+{
+    /* Keep the usual QByteArray layout, Qt takes any other data offset for
+     * raw data and deep copies it when detaching, even if it's not shared.
+     * The SIMD code uses unaligned loads and stores, and the lines are
+     * aligned through the caps.
+     */
+    return QByteArray(size, Qt::Uninitialized);
+}
+
+void AkVideoBufferPoolPrivate::releaseIdle()
+{
+    for (auto it = this->m_pools.begin(); it != this->m_pools.end();) {
+        if (this->m_requests - it->lastRequest > IDLE_REQUESTS) {
+            // Buffers still in use are just forgotten by the pool.
+            it = this->m_pools.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
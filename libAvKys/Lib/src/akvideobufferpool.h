@@ -0,0 +1,72 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVIDEOBUFFERPOOL_H
+#define AKVIDEOBUFFERPOOL_H
+
+#include <QByteArray>
+
+#include "akcommons.h"
+
+class AkVideoBufferPoolPrivate;
+class AkCaps;
+class AkVideoCaps;
+
+/* Recycles the frame buffers of a stream.
+ *
+ * The pool keeps a reference to every buffer it hands out, grouped by caps
+ * and size. Once all the other copies of a buffer are gone the buffer is
+ * free again, and the next request with the same caps and size will get it
+ * back instead of a new allocation.
+ *
+ * A returned buffer is still shared with the pool, so calling
+ * QByteArray::data() on it will detach it. Write to it through
+ * AkVideoBufferPool::data() instead, before making any other copy of it.
+ */
+class AKCOMMONS_EXPORT AkVideoBufferPool
+{
+    Q_DISABLE_COPY(AkVideoBufferPool)
+
+    public:
+        // Line alignment suitable for SIMD code, see AkVideoCaps::align().
+        enum
+        {
+            Alignment = 32
+        };
+
+        AkVideoBufferPool(int maxBuffers=32);
+        ~AkVideoBufferPool();
+
+        static AkVideoBufferPool *globalInstance();
+        static char *data(QByteArray &buffer);
+
+        QByteArray buffer(const AkVideoCaps &caps, int size=-1);
+        QByteArray buffer(const AkCaps &caps, int size);
+        int maxBuffers() const;
+        quint64 hits() const;
+        quint64 misses() const;
+        void setMaxBuffers(int maxBuffers);
+        void resetCounters();
+        void clear();
+
+    private:
+        AkVideoBufferPoolPrivate *d;
+};
+
+#endif // AKVIDEOBUFFERPOOL_H
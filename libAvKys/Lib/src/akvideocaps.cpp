@@ -17,9 +17,11 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <cstring>
 #include <QDebug>
 #include <QSize>
 #include <QVector>
+#include <QStringList>
 #include <QMetaEnum>
 
 #include "akvideocaps.h"
@@ -238,6 +240,80 @@ class VideoFormat
         }
 };
 
+struct VideoPlane
+{
+    int bitsPerPixel;
+    int xShift;
+    int yShift;
+};
+
+/* Planes of the multi-plane and macropixel formats, for every other format
+ * the frame is considered a single plane with the bits per pixel of the
+ * format.
+ */
+class VideoFormatPlanes
+{
+    public:
+        AkVideoCaps::PixelFormat format;
+        int planes;
+        VideoPlane plane[AkVideoCaps::MaxPlanes];
+
+        static inline const QVector<VideoFormatPlanes> &formats()
+        {
+            static const QVector<VideoFormatPlanes> videoFormatPlanes = {
+                {AkVideoCaps::Format_yuv420p     , 3, {{ 8, 0, 0}, { 8, 1, 1}, { 8, 1, 1}}},
+                {AkVideoCaps::Format_yuvj420p    , 3, {{ 8, 0, 0}, { 8, 1, 1}, { 8, 1, 1}}},
+                {AkVideoCaps::Format_yuv422p     , 3, {{ 8, 0, 0}, { 8, 1, 0}, { 8, 1, 0}}},
+                {AkVideoCaps::Format_yuvj422p    , 3, {{ 8, 0, 0}, { 8, 1, 0}, { 8, 1, 0}}},
+                {AkVideoCaps::Format_yuv444p     , 3, {{ 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}}},
+                {AkVideoCaps::Format_yuvj444p    , 3, {{ 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}}},
+                {AkVideoCaps::Format_yuv410p     , 3, {{ 8, 0, 0}, { 8, 2, 2}, { 8, 2, 2}}},
+                {AkVideoCaps::Format_yuv411p     , 3, {{ 8, 0, 0}, { 8, 2, 0}, { 8, 2, 0}}},
+                {AkVideoCaps::Format_yuvj411p    , 3, {{ 8, 0, 0}, { 8, 2, 0}, { 8, 2, 0}}},
+                {AkVideoCaps::Format_yuv440p     , 3, {{ 8, 0, 0}, { 8, 0, 1}, { 8, 0, 1}}},
+                {AkVideoCaps::Format_yuvj440p    , 3, {{ 8, 0, 0}, { 8, 0, 1}, { 8, 0, 1}}},
+                {AkVideoCaps::Format_yuva420p    , 4, {{ 8, 0, 0}, { 8, 1, 1}, { 8, 1, 1}, { 8, 0, 0}}},
+                {AkVideoCaps::Format_yuva422p    , 4, {{ 8, 0, 0}, { 8, 1, 0}, { 8, 1, 0}, { 8, 0, 0}}},
+                {AkVideoCaps::Format_yuva444p    , 4, {{ 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}}},
+                {AkVideoCaps::Format_yuv420p10le , 3, {{16, 0, 0}, {16, 1, 1}, {16, 1, 1}}},
+                {AkVideoCaps::Format_yuv420p10be , 3, {{16, 0, 0}, {16, 1, 1}, {16, 1, 1}}},
+                {AkVideoCaps::Format_yuv420p16le , 3, {{16, 0, 0}, {16, 1, 1}, {16, 1, 1}}},
+                {AkVideoCaps::Format_yuv420p16be , 3, {{16, 0, 0}, {16, 1, 1}, {16, 1, 1}}},
+                {AkVideoCaps::Format_yuv422p10le , 3, {{16, 0, 0}, {16, 1, 0}, {16, 1, 0}}},
+                {AkVideoCaps::Format_yuv422p10be , 3, {{16, 0, 0}, {16, 1, 0}, {16, 1, 0}}},
+                {AkVideoCaps::Format_yuv422p16le , 3, {{16, 0, 0}, {16, 1, 0}, {16, 1, 0}}},
+                {AkVideoCaps::Format_yuv422p16be , 3, {{16, 0, 0}, {16, 1, 0}, {16, 1, 0}}},
+                {AkVideoCaps::Format_yuv444p10le , 3, {{16, 0, 0}, {16, 0, 0}, {16, 0, 0}}},
+                {AkVideoCaps::Format_yuv444p10be , 3, {{16, 0, 0}, {16, 0, 0}, {16, 0, 0}}},
+                {AkVideoCaps::Format_yuv444p16le , 3, {{16, 0, 0}, {16, 0, 0}, {16, 0, 0}}},
+                {AkVideoCaps::Format_yuv444p16be , 3, {{16, 0, 0}, {16, 0, 0}, {16, 0, 0}}},
+                {AkVideoCaps::Format_yuyv422     , 1, {{32, 1, 0}}},
+                {AkVideoCaps::Format_uyvy422     , 1, {{32, 1, 0}}},
+                {AkVideoCaps::Format_yvyu422     , 1, {{32, 1, 0}}},
+                {AkVideoCaps::Format_nv12        , 2, {{ 8, 0, 0}, {16, 1, 1}}},
+                {AkVideoCaps::Format_nv21        , 2, {{ 8, 0, 0}, {16, 1, 1}}},
+                {AkVideoCaps::Format_nv16        , 2, {{ 8, 0, 0}, {16, 1, 0}}},
+                {AkVideoCaps::Format_p010le      , 2, {{16, 0, 0}, {32, 1, 1}}},
+                {AkVideoCaps::Format_p010be      , 2, {{16, 0, 0}, {32, 1, 1}}},
+                {AkVideoCaps::Format_p016le      , 2, {{16, 0, 0}, {32, 1, 1}}},
+                {AkVideoCaps::Format_p016be      , 2, {{16, 0, 0}, {32, 1, 1}}},
+                {AkVideoCaps::Format_gbrp        , 3, {{ 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}}},
+                {AkVideoCaps::Format_gbrap       , 4, {{ 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}, { 8, 0, 0}}},
+            };
+
+            return videoFormatPlanes;
+        }
+
+        static inline const VideoFormatPlanes *byFormat(AkVideoCaps::PixelFormat format)
+        {
+            for (int i = 0; i < formats().size(); i++)
+                if (formats()[i].format == format)
+                    return &formats()[i];
+
+            return nullptr;
+        }
+};
+
 class AkVideoCapsPrivate
 {
     public:
@@ -247,6 +323,189 @@ class AkVideoCapsPrivate
         int m_width;
         int m_height;
         AkFrac m_fps;
+        int m_align;
+
+        // Explicit layout, 0 and -1 means computed from the alignment.
+        int m_lineSize[AkVideoCaps::MaxPlanes];
+        int m_planeOffset[AkVideoCaps::MaxPlanes];
+
+        // Fields layout of the caps value.
+        enum ValueField
+        {
+            ValueFieldFormat,
+            ValueFieldBpp,
+            ValueFieldWidth,
+            ValueFieldHeight,
+            ValueFieldFpsNum,
+            ValueFieldFpsDen,
+            ValueFieldAlign,
+            ValueFieldLineSize,
+            ValueFieldPlaneOffset = ValueFieldLineSize + AkVideoCaps::MaxPlanes
+        };
+
+        AkVideoCapsPrivate():
+            m_align(1)
+        {
+            this->resetLayout();
+        }
+
+        inline void resetLayout()
+        {
+            for (int plane = 0; plane < AkVideoCaps::MaxPlanes; plane++) {
+                this->m_lineSize[plane] = 0;
+                this->m_planeOffset[plane] = -1;
+            }
+        }
+
+        inline void copyLayout(const AkVideoCapsPrivate *other)
+        {
+            this->m_align = other->m_align;
+            memcpy(this->m_lineSize, other->m_lineSize, sizeof(this->m_lineSize));
+            memcpy(this->m_planeOffset, other->m_planeOffset, sizeof(this->m_planeOffset));
+        }
+
+        inline bool hasExplicitLayout() const
+        {
+            for (int plane = 0; plane < AkVideoCaps::MaxPlanes; plane++)
+                if (this->m_lineSize[plane] > 0
+                    || this->m_planeOffset[plane] >= 0)
+                    return true;
+
+            return false;
+        }
+
+        inline void fromValue(const AkCapsValue &value)
+        {
+            this->m_format =
+                    AkVideoCaps::PixelFormat(value.field(ValueFieldFormat));
+            this->m_bpp = int(value.field(ValueFieldBpp));
+            this->m_width = int(value.field(ValueFieldWidth));
+            this->m_height = int(value.field(ValueFieldHeight));
+            this->m_fps = AkFrac(value.field(ValueFieldFpsNum),
+                                 value.field(ValueFieldFpsDen));
+            this->m_align = int(value.field(ValueFieldAlign));
+
+            for (int plane = 0; plane < AkVideoCaps::MaxPlanes; plane++) {
+                this->m_lineSize[plane] =
+                        int(value.field(ValueFieldLineSize + plane));
+                this->m_planeOffset[plane] =
+                        int(value.field(ValueFieldPlaneOffset + plane));
+            }
+        }
+
+        inline bool sameFields(const AkVideoCapsPrivate *other) const
+        {
+            return this->m_format == other->m_format
+                   && this->m_bpp == other->m_bpp
+                   && this->m_width == other->m_width
+                   && this->m_height == other->m_height
+                   && this->m_fps.num() == other->m_fps.num()
+                   && this->m_fps.den() == other->m_fps.den()
+                   && this->m_align == other->m_align
+                   && !memcmp(this->m_lineSize,
+                              other->m_lineSize,
+                              sizeof(this->m_lineSize))
+                   && !memcmp(this->m_planeOffset,
+                              other->m_planeOffset,
+                              sizeof(this->m_planeOffset));
+        }
+
+        inline int alignUp(int value) const
+        {
+            int align = qMax(this->m_align, 1);
+
+            return (value + align - 1) / align * align;
+        }
+
+        inline int planes() const
+        {
+            auto formatPlanes = VideoFormatPlanes::byFormat(this->m_format);
+
+            return formatPlanes? formatPlanes->planes: 1;
+        }
+
+        inline int planeHeight(int plane) const
+        {
+            auto formatPlanes = VideoFormatPlanes::byFormat(this->m_format);
+
+            if (!formatPlanes)
+                return plane == 0? this->m_height: 0;
+
+            if (plane < 0 || plane >= formatPlanes->planes)
+                return 0;
+
+            int yShift = formatPlanes->plane[plane].yShift;
+
+            return (this->m_height + (1 << yShift) - 1) >> yShift;
+        }
+
+        inline int lineSize(int plane) const
+        {
+            if (plane < 0 || plane >= this->planes())
+                return 0;
+
+            if (this->m_lineSize[plane] > 0)
+                return this->m_lineSize[plane];
+
+            auto formatPlanes = VideoFormatPlanes::byFormat(this->m_format);
+
+            if (!formatPlanes)
+                return this->alignUp((this->m_width * this->m_bpp + 7) >> 3);
+
+            auto &formatPlane = formatPlanes->plane[plane];
+            int width = (this->m_width + (1 << formatPlane.xShift) - 1)
+                        >> formatPlane.xShift;
+
+            return this->alignUp((width * formatPlane.bitsPerPixel + 7) >> 3);
+        }
+
+        inline int planeOffset(int plane) const
+        {
+            if (plane < 0 || plane >= this->planes())
+                return 0;
+
+            if (this->m_planeOffset[plane] >= 0)
+                return this->m_planeOffset[plane];
+
+            if (plane == 0)
+                return 0;
+
+            return this->alignUp(this->planeOffset(plane - 1)
+                                 + this->lineSize(plane - 1)
+                                   * this->planeHeight(plane - 1));
+        }
+
+        inline int frameSize() const
+        {
+            int size = 0;
+
+            for (int plane = 0; plane < this->planes(); plane++)
+                size = qMax(size,
+                            this->planeOffset(plane)
+                            + this->lineSize(plane) * this->planeHeight(plane));
+
+            return size;
+        }
+
+        inline static QString layoutToString(const int *layout, int planes)
+        {
+            QStringList values;
+
+            for (int plane = 0; plane < planes; plane++)
+                values << QString::number(layout[plane]);
+
+            return values.join(':');
+        }
+
+        inline static void layoutFromString(const QString &str, int *layout)
+        {
+            auto values = str.split(':');
+
+            for (int plane = 0;
+                 plane < qMin(values.size(), int(AkVideoCaps::MaxPlanes));
+                 plane++)
+                layout[plane] = values[plane].trimmed().toInt();
+        }
 };
 
 AkVideoCaps::AkVideoCaps(QObject *parent):
@@ -288,7 +547,10 @@ AkVideoCaps::AkVideoCaps(const AkCaps &caps)
 {
     this->d = new AkVideoCapsPrivate();
 
-    if (caps.mimeType() == "video/x-raw") {
+    if (caps.cachedValue().type() == AkCapsValue::ValueTypeVideo) {
+        this->d->m_isValid = caps.isValid();
+        this->d->fromValue(caps.cachedValue());
+    } else if (caps.mimeType() == "video/x-raw") {
         this->d->m_isValid = caps.isValid();
         this->update(caps);
     } else {
@@ -310,6 +572,7 @@ AkVideoCaps::AkVideoCaps(const AkVideoCaps &other):
     this->d->m_width = other.d->m_width;
     this->d->m_height = other.d->m_height;
     this->d->m_fps = other.d->m_fps;
+    this->d->copyLayout(other.d);
 
     QList<QByteArray> properties = other.dynamicPropertyNames();
 
@@ -331,6 +594,7 @@ AkVideoCaps &AkVideoCaps::operator =(const AkVideoCaps &other)
         this->d->m_width = other.d->m_width;
         this->d->m_height = other.d->m_height;
         this->d->m_fps = other.d->m_fps;
+        this->d->copyLayout(other.d);
 
         this->clear();
 
@@ -345,7 +609,11 @@ AkVideoCaps &AkVideoCaps::operator =(const AkVideoCaps &other)
 
 AkVideoCaps &AkVideoCaps::operator =(const AkCaps &caps)
 {
-    if (caps.mimeType() == "video/x-raw") {
+    if (caps.cachedValue().type() == AkCapsValue::ValueTypeVideo) {
+        this->clear();
+        this->d->m_isValid = caps.isValid();
+        this->d->fromValue(caps.cachedValue());
+    } else if (caps.mimeType() == "video/x-raw") {
         this->d->m_isValid = caps.isValid();
         this->update(caps);
     } else {
@@ -355,6 +623,8 @@ AkVideoCaps &AkVideoCaps::operator =(const AkCaps &caps)
         this->d->m_width = 0;
         this->d->m_height = 0;
         this->d->m_fps = AkFrac();
+        this->d->m_align = 1;
+        this->d->resetLayout();
     }
 
     return *this;
@@ -367,6 +637,16 @@ AkVideoCaps &AkVideoCaps::operator =(const QString &caps)
 
 bool AkVideoCaps::operator ==(const AkVideoCaps &other) const
 {
+    if (!this->d->m_isValid || !other.d->m_isValid)
+        return this->d->m_isValid == other.d->m_isValid;
+
+    if (!this->d->sameFields(other.d))
+        return false;
+
+    if (this->dynamicPropertyNames().isEmpty()
+        && other.dynamicPropertyNames().isEmpty())
+        return true;
+
     return this->toString() == other.toString();
 }
 
@@ -455,9 +735,39 @@ AkFrac &AkVideoCaps::fps()
     return this->d->m_fps;
 }
 
+int AkVideoCaps::align() const
+{
+    return this->d->m_align;
+}
+
+int &AkVideoCaps::align()
+{
+    return this->d->m_align;
+}
+
+int AkVideoCaps::planes() const
+{
+    return this->d->planes();
+}
+
+int AkVideoCaps::lineSize(int plane) const
+{
+    return this->d->lineSize(plane);
+}
+
+int AkVideoCaps::planeOffset(int plane) const
+{
+    return this->d->planeOffset(plane);
+}
+
+int AkVideoCaps::planeHeight(int plane) const
+{
+    return this->d->planeHeight(plane);
+}
+
 int AkVideoCaps::pictureSize() const
 {
-    return this->d->m_bpp * this->d->m_width * this->d->m_height / 8;
+    return this->d->frameSize();
 }
 
 AkVideoCaps &AkVideoCaps::fromMap(const QVariantMap &caps)
@@ -473,13 +783,21 @@ AkVideoCaps &AkVideoCaps::fromMap(const QVariantMap &caps)
         return *this;
     }
 
+    this->d->resetLayout();
+
     for (const QString &key: caps.keys())
         if (key == "mimeType") {
             this->d->m_isValid = caps[key].toString() == "video/x-raw";
 
             if (!this->d->m_isValid)
                 return *this;
-        } else
+        } else if (key == "lineSize")
+            this->d->layoutFromString(caps[key].toString(),
+                                      this->d->m_lineSize);
+        else if (key == "planeOffset")
+            this->d->layoutFromString(caps[key].toString(),
+                                      this->d->m_planeOffset);
+        else
             this->setProperty(key.trimmed().toStdString().c_str(), caps[key]);
 
     return *this;
@@ -500,6 +818,16 @@ QVariantMap AkVideoCaps::toMap() const
         {"fps"   , QVariant::fromValue(this->d->m_fps)         }
     };
 
+    if (this->d->m_align != 1)
+        map["align"] = this->d->m_align;
+
+    if (this->d->hasExplicitLayout()) {
+        map["lineSize"] = this->d->layoutToString(this->d->m_lineSize,
+                                                  this->d->planes());
+        map["planeOffset"] = this->d->layoutToString(this->d->m_planeOffset,
+                                                     this->d->planes());
+    }
+
     for (const QByteArray &property: this->dynamicPropertyNames()) {
         QString key = QString::fromUtf8(property.constData());
         map[key] = this->property(property);
@@ -526,6 +854,16 @@ QString AkVideoCaps::toString() const
                                     .arg(this->d->m_height)
                                     .arg(this->d->m_fps.toString());
 
+    if (this->d->m_align != 1)
+        caps.append(QString(",align=%1").arg(this->d->m_align));
+
+    if (this->d->hasExplicitLayout())
+        caps.append(QString(",lineSize=%1,planeOffset=%2")
+                    .arg(this->d->layoutToString(this->d->m_lineSize,
+                                                 this->d->planes()))
+                    .arg(this->d->layoutToString(this->d->m_planeOffset,
+                                                 this->d->planes())));
+
     QStringList properties;
 
     for (const QByteArray &property: this->dynamicPropertyNames())
@@ -546,6 +884,8 @@ AkVideoCaps &AkVideoCaps::update(const AkCaps &caps)
         return *this;
 
     this->clear();
+    this->d->m_align = 1;
+    this->d->resetLayout();
 
     QList<QByteArray> properties = caps.dynamicPropertyNames();
 
@@ -560,6 +900,14 @@ AkVideoCaps &AkVideoCaps::update(const AkCaps &caps)
             this->d->m_height = caps.property(property).toInt();
         else if (property == "fps")
             this->d->m_fps = caps.property("fps").toString();
+        else if (property == "align")
+            this->d->m_align = caps.property(property).toInt();
+        else if (property == "lineSize")
+            this->d->layoutFromString(caps.property(property).toString(),
+                                      this->d->m_lineSize);
+        else if (property == "planeOffset")
+            this->d->layoutFromString(caps.property(property).toString(),
+                                      this->d->m_planeOffset);
         else
             this->setProperty(property, caps.property(property));
 
@@ -568,7 +916,62 @@ AkVideoCaps &AkVideoCaps::update(const AkCaps &caps)
 
 AkCaps AkVideoCaps::toCaps() const
 {
-    return AkCaps(this->toString());
+    if (!this->d->m_isValid)
+        return AkCaps();
+
+    auto properties = this->dynamicPropertyNames();
+
+    if (!properties.isEmpty())
+        return AkCaps(this->toString());
+
+    // Build the caps directly, parsing back the caps string is too slow for
+    // being done on every frame.
+    AkCaps caps;
+    caps.setMimeType("video/x-raw");
+    caps.setProperty("format", this->pixelFormatToString(this->d->m_format));
+    caps.setProperty("bpp", QString::number(this->d->m_bpp));
+    caps.setProperty("width", QString::number(this->d->m_width));
+    caps.setProperty("height", QString::number(this->d->m_height));
+    caps.setProperty("fps", this->d->m_fps.toString());
+
+    if (this->d->m_align != 1)
+        caps.setProperty("align", QString::number(this->d->m_align));
+
+    if (this->d->hasExplicitLayout()) {
+        caps.setProperty("lineSize",
+                         this->d->layoutToString(this->d->m_lineSize,
+                                                 this->d->planes()));
+        caps.setProperty("planeOffset",
+                         this->d->layoutToString(this->d->m_planeOffset,
+                                                 this->d->planes()));
+    }
+
+    caps.setValue(this->value());
+
+    return caps;
+}
+
+AkCapsValue AkVideoCaps::value() const
+{
+    if (!this->d->m_isValid)
+        return AkCapsValue();
+
+    return AkCapsValue(AkCapsValue::ValueTypeVideo,
+                       {this->d->m_format,
+                        this->d->m_bpp,
+                        this->d->m_width,
+                        this->d->m_height,
+                        this->d->m_fps.num(),
+                        this->d->m_fps.den(),
+                        this->d->m_align,
+                        this->d->m_lineSize[0],
+                        this->d->m_lineSize[1],
+                        this->d->m_lineSize[2],
+                        this->d->m_lineSize[3],
+                        this->d->m_planeOffset[0],
+                        this->d->m_planeOffset[1],
+                        this->d->m_planeOffset[2],
+                        this->d->m_planeOffset[3]});
 }
 
 int AkVideoCaps::bitsPerPixel(AkVideoCaps::PixelFormat pixelFormat)
@@ -583,9 +986,8 @@ int AkVideoCaps::bitsPerPixel(const QString &pixelFormat)
 
 QString AkVideoCaps::pixelFormatToString(AkVideoCaps::PixelFormat pixelFormat)
 {
-    AkVideoCaps caps;
-    int formatIndex = caps.metaObject()->indexOfEnumerator("PixelFormat");
-    QMetaEnum formatEnum = caps.metaObject()->enumerator(formatIndex);
+    int formatIndex = AkVideoCaps::staticMetaObject.indexOfEnumerator("PixelFormat");
+    QMetaEnum formatEnum = AkVideoCaps::staticMetaObject.enumerator(formatIndex);
     QString format(formatEnum.valueToKey(pixelFormat));
     format.remove("Format_");
 
@@ -594,10 +996,9 @@ QString AkVideoCaps::pixelFormatToString(AkVideoCaps::PixelFormat pixelFormat)
 
 AkVideoCaps::PixelFormat AkVideoCaps::pixelFormatFromString(const QString &pixelFormat)
 {
-    AkVideoCaps caps;
     QString format = "Format_" + pixelFormat;
-    int enumIndex = caps.metaObject()->indexOfEnumerator("PixelFormat");
-    QMetaEnum enumType = caps.metaObject()->enumerator(enumIndex);
+    int enumIndex = AkVideoCaps::staticMetaObject.indexOfEnumerator("PixelFormat");
+    QMetaEnum enumType = AkVideoCaps::staticMetaObject.enumerator(enumIndex);
     int enumValue = enumType.keyToValue(format.toStdString().c_str());
 
     return static_cast<PixelFormat>(enumValue);
@@ -670,6 +1071,31 @@ void AkVideoCaps::setFps(const AkFrac &fps)
     emit this->fpsChanged(fps);
 }
 
+void AkVideoCaps::setAlign(int align)
+{
+    if (this->d->m_align == align)
+        return;
+
+    this->d->m_align = align;
+    emit this->alignChanged(align);
+}
+
+void AkVideoCaps::setLineSize(int plane, int lineSize)
+{
+    if (plane < 0 || plane >= AkVideoCaps::MaxPlanes)
+        return;
+
+    this->d->m_lineSize[plane] = qMax(lineSize, 0);
+}
+
+void AkVideoCaps::setPlaneOffset(int plane, int offset)
+{
+    if (plane < 0 || plane >= AkVideoCaps::MaxPlanes)
+        return;
+
+    this->d->m_planeOffset[plane] = qMax(offset, -1);
+}
+
 void AkVideoCaps::resetFormat()
 {
     this->setFormat(AkVideoCaps::Format_none);
@@ -700,6 +1126,16 @@ void AkVideoCaps::resetFps()
     this->setFps(AkFrac());
 }
 
+void AkVideoCaps::resetAlign()
+{
+    this->setAlign(1);
+}
+
+void AkVideoCaps::resetLayout()
+{
+    this->d->resetLayout();
+}
+
 void AkVideoCaps::clear()
 {
     QList<QByteArray> properties = this->dynamicPropertyNames();
@@ -708,6 +1144,11 @@ void AkVideoCaps::clear()
         this->setProperty(property.constData(), QVariant());
 }
 
+uint qHash(const AkVideoCaps &caps, uint seed)
+{
+    return qHash(caps.value(), seed);
+}
+
 QDebug operator <<(QDebug debug, const AkVideoCaps &caps)
 {
     debug.nospace() << caps.toString();
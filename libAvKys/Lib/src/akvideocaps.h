@@ -22,7 +22,7 @@
 
 #include <QObject>
 
-#include "akcommons.h"
+#include "akcapsvalue.h"
 
 #define AkFourCC(a, b, c, d) \
     (((quint32(a) & 0xff) << 24) \
@@ -36,6 +36,11 @@ class AkVideoCapsPrivate;
 class AkCaps;
 class AkFrac;
 
+/* Frames are described plane by plane, each plane has a line size (stride)
+ * and an offset from the start of the buffer. Unless set explicitly, lines
+ * are aligned to 'align' bytes and planes follow one another, also aligned.
+ * The default alignment of 1 means tightly packed frames.
+ */
 class AKCOMMONS_EXPORT AkVideoCaps: public QObject
 {
     Q_OBJECT
@@ -72,6 +77,13 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
                WRITE setFps
                RESET resetFps
                NOTIFY fpsChanged)
+    Q_PROPERTY(int align
+               READ align
+               WRITE setAlign
+               RESET resetAlign
+               NOTIFY alignChanged)
+    Q_PROPERTY(int planes
+               READ planes)
     Q_PROPERTY(int pictureSize
                READ pictureSize)
 
@@ -270,6 +282,11 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
             Format_v308
         };
 
+        enum
+        {
+            MaxPlanes = 4
+        };
+
         explicit AkVideoCaps(QObject *parent=nullptr);
         AkVideoCaps(const QVariantMap &caps);
         AkVideoCaps(const QString &caps);
@@ -298,6 +315,12 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
         Q_INVOKABLE int &height();
         Q_INVOKABLE AkFrac fps() const;
         Q_INVOKABLE AkFrac &fps();
+        Q_INVOKABLE int align() const;
+        Q_INVOKABLE int &align();
+        Q_INVOKABLE int planes() const;
+        Q_INVOKABLE int lineSize(int plane) const;
+        Q_INVOKABLE int planeOffset(int plane) const;
+        Q_INVOKABLE int planeHeight(int plane) const;
         Q_INVOKABLE int pictureSize() const;
 
         Q_INVOKABLE AkVideoCaps &fromMap(const QVariantMap &caps);
@@ -306,6 +329,7 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
         Q_INVOKABLE QString toString() const;
         Q_INVOKABLE AkVideoCaps &update(const AkCaps &caps);
         Q_INVOKABLE AkCaps toCaps() const;
+        AkCapsValue value() const;
 
         Q_INVOKABLE static int bitsPerPixel(PixelFormat pixelFormat);
         Q_INVOKABLE static int bitsPerPixel(const QString &pixelFormat);
@@ -324,6 +348,7 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
         void widthChanged(int width);
         void heightChanged(int height);
         void fpsChanged(const AkFrac &fps);
+        void alignChanged(int align);
 
     public Q_SLOTS:
         void setFormat(PixelFormat format);
@@ -332,12 +357,17 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
         void setWidth(int width);
         void setHeight(int height);
         void setFps(const AkFrac &fps);
+        void setAlign(int align);
+        void setLineSize(int plane, int lineSize);
+        void setPlaneOffset(int plane, int offset);
         void resetFormat();
         void resetBpp();
         void resetSize();
         void resetWidth();
         void resetHeight();
         void resetFps();
+        void resetAlign();
+        void resetLayout();
         void clear();
 
     friend QDebug operator <<(QDebug debug, const AkVideoCaps &caps);
@@ -345,6 +375,7 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
     friend QDataStream &operator <<(QDataStream &ostream, const AkVideoCaps &caps);
 };
 
+AKCOMMONS_EXPORT uint qHash(const AkVideoCaps &caps, uint seed=0);
 QDebug operator <<(QDebug debug, const AkVideoCaps &caps);
 QDataStream &operator >>(QDataStream &istream, AkVideoCaps &caps);
 QDataStream &operator <<(QDataStream &ostream, const AkVideoCaps &caps);
@@ -0,0 +1,868 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QVector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "akvideoconverter.h"
+#include "akvideobufferpool.h"
+#include "akvideopacket.h"
+#include "akfrac.h"
+
+/* All conversions go through one intermediate row, either 32 bits ARGB
+ * (native endian, 0xAARRGGBB) or full width Y, U and V rows, depending on
+ * the color model of the source format. Readers unpack a source line into
+ * the intermediate row, writers pack it back into the destination format.
+ */
+enum ColorModel
+{
+    ColorModelRGB,
+    ColorModelYUV
+};
+
+struct ConvertRows
+{
+    quint32 *argb;
+    quint8 *y;
+    quint8 *u;
+    quint8 *v;
+};
+
+typedef void (*ReadRowFunc)(const quint8 *const *planes,
+                            int width,
+                            const ConvertRows &rows);
+typedef void (*WriteRowFunc)(const ConvertRows &rows,
+                             int width,
+                             quint8 *const *planes,
+                             bool writeChroma);
+
+struct PlaneSpec
+{
+    int xShift;
+    int yShift;
+    int bytes;
+};
+
+struct FormatSpec
+{
+    AkVideoCaps::PixelFormat format;
+    ColorModel model;
+    int planes;
+    PlaneSpec plane[3];
+    ReadRowFunc read;
+    WriteRowFunc write;
+
+    static const FormatSpec *byFormat(AkVideoCaps::PixelFormat format);
+};
+
+struct FrameLayout
+{
+    int lineSize[3];
+    int offset[3];
+    int size;
+};
+
+// Colorspace kernels, BT.601 limited range.
+
+inline quint8 clampByte(int value)
+{
+    return quint8(qBound(0, value, 255));
+}
+
+static void yuvToArgbRow(const quint8 *y,
+                         const quint8 *u,
+                         const quint8 *v,
+                         quint32 *argb,
+                         int width)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i yOffset = _mm_set1_epi16(16);
+    const __m128i cOffset = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i alpha = _mm_set1_epi8(char(0xff));
+    const __m128i kYV = _mm_setr_epi16(298, 409, 298, 409,
+                                       298, 409, 298, 409);
+    const __m128i kYU = _mm_setr_epi16(298, 516, 298, 516,
+                                       298, 516, 298, 516);
+    const __m128i kGYU = _mm_setr_epi16(298, -100, 298, -100,
+                                        298, -100, 298, -100);
+    const __m128i kGUV = _mm_setr_epi16(0, -208, 0, -208,
+                                        0, -208, 0, -208);
+
+    for (; x + 8 <= width; x += 8) {
+        __m128i y16 =
+                _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)),
+                                                zero),
+                              yOffset);
+        __m128i u16 =
+                _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x)),
+                                                zero),
+                              cOffset);
+        __m128i v16 =
+                _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x)),
+                                                zero),
+                              cOffset);
+
+        __m128i yuLo = _mm_unpacklo_epi16(y16, u16);
+        __m128i yuHi = _mm_unpackhi_epi16(y16, u16);
+        __m128i yvLo = _mm_unpacklo_epi16(y16, v16);
+        __m128i yvHi = _mm_unpackhi_epi16(y16, v16);
+        __m128i uvLo = _mm_unpacklo_epi16(u16, v16);
+        __m128i uvHi = _mm_unpackhi_epi16(u16, v16);
+
+        __m128i rLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvLo, kYV), round), 8);
+        __m128i rHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvHi, kYV), round), 8);
+        __m128i gLo = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, kGYU),
+                                                                 _mm_madd_epi16(uvLo, kGUV)),
+                                                   round), 8);
+        __m128i gHi = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, kGYU),
+                                                                 _mm_madd_epi16(uvHi, kGUV)),
+                                                   round), 8);
+        __m128i bLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, kYU), round), 8);
+        __m128i bHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, kYU), round), 8);
+
+        __m128i r16 = _mm_packs_epi32(rLo, rHi);
+        __m128i g16 = _mm_packs_epi32(gLo, gHi);
+        __m128i b16 = _mm_packs_epi32(bLo, bHi);
+
+        __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b16, b16),
+                                       _mm_packus_epi16(g16, g16));
+        __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r16, r16),
+                                       alpha);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(argb + x),
+                         _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(argb + x + 4),
+                         _mm_unpackhi_epi16(bg, ra));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; x + 8 <= width; x += 8) {
+        int16x8_t y16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + x))),
+                                  vdupq_n_s16(16));
+        int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x))),
+                                  vdupq_n_s16(128));
+        int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x))),
+                                  vdupq_n_s16(128));
+
+        int32x4_t cLo = vmull_n_s16(vget_low_s16(y16), 298);
+        int32x4_t cHi = vmull_n_s16(vget_high_s16(y16), 298);
+
+        int32x4_t rLo = vmlal_n_s16(cLo, vget_low_s16(v16), 409);
+        int32x4_t rHi = vmlal_n_s16(cHi, vget_high_s16(v16), 409);
+        int32x4_t gLo = vmlsl_n_s16(vmlsl_n_s16(cLo, vget_low_s16(u16), 100),
+                                    vget_low_s16(v16), 208);
+        int32x4_t gHi = vmlsl_n_s16(vmlsl_n_s16(cHi, vget_high_s16(u16), 100),
+                                    vget_high_s16(v16), 208);
+        int32x4_t bLo = vmlal_n_s16(cLo, vget_low_s16(u16), 516);
+        int32x4_t bHi = vmlal_n_s16(cHi, vget_high_s16(u16), 516);
+
+        uint8x8x4_t bgra;
+        bgra.val[0] = vqmovun_s16(vcombine_s16(vqmovn_s32(vrshrq_n_s32(bLo, 8)),
+                                               vqmovn_s32(vrshrq_n_s32(bHi, 8))));
+        bgra.val[1] = vqmovun_s16(vcombine_s16(vqmovn_s32(vrshrq_n_s32(gLo, 8)),
+                                               vqmovn_s32(vrshrq_n_s32(gHi, 8))));
+        bgra.val[2] = vqmovun_s16(vcombine_s16(vqmovn_s32(vrshrq_n_s32(rLo, 8)),
+                                               vqmovn_s32(vrshrq_n_s32(rHi, 8))));
+        bgra.val[3] = vdup_n_u8(0xff);
+        vst4_u8(reinterpret_cast<uint8_t *>(argb + x), bgra);
+    }
+#endif
+
+    for (; x < width; x++) {
+        int c = 298 * (y[x] - 16);
+        int d = u[x] - 128;
+        int e = v[x] - 128;
+
+        int r = clampByte((c + 409 * e + 128) >> 8);
+        int g = clampByte((c - 100 * d - 208 * e + 128) >> 8);
+        int b = clampByte((c + 516 * d + 128) >> 8);
+
+        argb[x] = 0xff000000 | quint32(r << 16) | quint32(g << 8) | quint32(b);
+    }
+}
+
+static void argbToYuvRow(const quint32 *argb,
+                         quint8 *y,
+                         quint8 *u,
+                         quint8 *v,
+                         int width)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i yOffset = _mm_set1_epi16(16);
+    const __m128i cOffset = _mm_set1_epi16(128);
+
+    // Coefficients in memory order: B, G, R, A.
+    const __m128i kY = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+    const __m128i kU = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+    const __m128i kV = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(argb + x));
+        __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+        __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+        __m128i components[3];
+        const __m128i *k[3] = {&kY, &kU, &kV};
+
+        for (int c = 0; c < 3; c++) {
+            __m128 sLo = _mm_castsi128_ps(_mm_madd_epi16(lo, *k[c]));
+            __m128 sHi = _mm_castsi128_ps(_mm_madd_epi16(hi, *k[c]));
+
+            // Add the partial sums of each pixel.
+            __m128i sum =
+                    _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(sLo, sHi, _MM_SHUFFLE(2, 0, 2, 0))),
+                                  _mm_castps_si128(_mm_shuffle_ps(sLo, sHi, _MM_SHUFFLE(3, 1, 3, 1))));
+            sum = _mm_srai_epi32(_mm_add_epi32(sum, round), 8);
+            components[c] = _mm_packs_epi32(sum, sum);
+        }
+
+        components[0] = _mm_add_epi16(components[0], yOffset);
+        components[1] = _mm_add_epi16(components[1], cOffset);
+        components[2] = _mm_add_epi16(components[2], cOffset);
+
+        quint8 *dst[3] = {y + x, u + x, v + x};
+
+        for (int c = 0; c < 3; c++) {
+            int value = _mm_cvtsi128_si32(_mm_packus_epi16(components[c],
+                                                           components[c]));
+            memcpy(dst[c], &value, 4);
+        }
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t bgra = vld4_u8(reinterpret_cast<const uint8_t *>(argb + x));
+        int16x8_t b = vreinterpretq_s16_u16(vmovl_u8(bgra.val[0]));
+        int16x8_t g = vreinterpretq_s16_u16(vmovl_u8(bgra.val[1]));
+        int16x8_t r = vreinterpretq_s16_u16(vmovl_u8(bgra.val[2]));
+
+        int32x4_t yLo = vmull_n_s16(vget_low_s16(r), 66);
+        yLo = vmlal_n_s16(yLo, vget_low_s16(g), 129);
+        yLo = vmlal_n_s16(yLo, vget_low_s16(b), 25);
+        int32x4_t yHi = vmull_n_s16(vget_high_s16(r), 66);
+        yHi = vmlal_n_s16(yHi, vget_high_s16(g), 129);
+        yHi = vmlal_n_s16(yHi, vget_high_s16(b), 25);
+
+        int32x4_t uLo = vmull_n_s16(vget_low_s16(b), 112);
+        uLo = vmlsl_n_s16(uLo, vget_low_s16(g), 74);
+        uLo = vmlsl_n_s16(uLo, vget_low_s16(r), 38);
+        int32x4_t uHi = vmull_n_s16(vget_high_s16(b), 112);
+        uHi = vmlsl_n_s16(uHi, vget_high_s16(g), 74);
+        uHi = vmlsl_n_s16(uHi, vget_high_s16(r), 38);
+
+        int32x4_t vLo = vmull_n_s16(vget_low_s16(r), 112);
+        vLo = vmlsl_n_s16(vLo, vget_low_s16(g), 94);
+        vLo = vmlsl_n_s16(vLo, vget_low_s16(b), 18);
+        int32x4_t vHi = vmull_n_s16(vget_high_s16(r), 112);
+        vHi = vmlsl_n_s16(vHi, vget_high_s16(g), 94);
+        vHi = vmlsl_n_s16(vHi, vget_high_s16(b), 18);
+
+        int16x8_t y16 = vcombine_s16(vmovn_s32(vrshrq_n_s32(yLo, 8)),
+                                     vmovn_s32(vrshrq_n_s32(yHi, 8)));
+        int16x8_t u16 = vcombine_s16(vmovn_s32(vrshrq_n_s32(uLo, 8)),
+                                     vmovn_s32(vrshrq_n_s32(uHi, 8)));
+        int16x8_t v16 = vcombine_s16(vmovn_s32(vrshrq_n_s32(vLo, 8)),
+                                     vmovn_s32(vrshrq_n_s32(vHi, 8)));
+
+        vst1_u8(y + x, vqmovun_s16(vaddq_s16(y16, vdupq_n_s16(16))));
+        vst1_u8(u + x, vqmovun_s16(vaddq_s16(u16, vdupq_n_s16(128))));
+        vst1_u8(v + x, vqmovun_s16(vaddq_s16(v16, vdupq_n_s16(128))));
+    }
+#endif
+
+    for (; x < width; x++) {
+        int r = (argb[x] >> 16) & 0xff;
+        int g = (argb[x] >> 8) & 0xff;
+        int b = argb[x] & 0xff;
+
+        y[x] = quint8(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        u[x] = quint8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[x] = quint8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+// Readers
+
+static void readARGB(const quint8 *const *planes,
+                     int width,
+                     const ConvertRows &rows)
+{
+    memcpy(rows.argb, planes[0], size_t(width) * sizeof(quint32));
+}
+
+static void read0RGB(const quint8 *const *planes,
+                     int width,
+                     const ConvertRows &rows)
+{
+    auto line = reinterpret_cast<const quint32 *>(planes[0]);
+
+    for (int x = 0; x < width; x++)
+        rows.argb[x] = line[x] | 0xff000000;
+}
+
+static void readRGB24(const quint8 *const *planes,
+                      int width,
+                      const ConvertRows &rows)
+{
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 3)
+        rows.argb[x] = 0xff000000
+                     | quint32(line[0] << 16)
+                     | quint32(line[1] << 8)
+                     | quint32(line[2]);
+}
+
+static void readBGR24(const quint8 *const *planes,
+                      int width,
+                      const ConvertRows &rows)
+{
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 3)
+        rows.argb[x] = 0xff000000
+                     | quint32(line[2] << 16)
+                     | quint32(line[1] << 8)
+                     | quint32(line[0]);
+}
+
+static void readRGB565LE(const quint8 *const *planes,
+                         int width,
+                         const ConvertRows &rows)
+{
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 2) {
+        quint32 pixel = quint32(line[0]) | quint32(line[1] << 8);
+        quint32 r = (pixel >> 11) & 0x1f;
+        quint32 g = (pixel >> 5) & 0x3f;
+        quint32 b = pixel & 0x1f;
+
+        rows.argb[x] = 0xff000000
+                     | (((r << 3) | (r >> 2)) << 16)
+                     | (((g << 2) | (g >> 4)) << 8)
+                     | ((b << 3) | (b >> 2));
+    }
+}
+
+static void readRGB555LE(const quint8 *const *planes,
+                         int width,
+                         const ConvertRows &rows)
+{
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 2) {
+        quint32 pixel = quint32(line[0]) | quint32(line[1] << 8);
+        quint32 r = (pixel >> 10) & 0x1f;
+        quint32 g = (pixel >> 5) & 0x1f;
+        quint32 b = pixel & 0x1f;
+
+        rows.argb[x] = 0xff000000
+                     | (((r << 3) | (r >> 2)) << 16)
+                     | (((g << 3) | (g >> 2)) << 8)
+                     | ((b << 3) | (b >> 2));
+    }
+}
+
+static void readGray(const quint8 *const *planes,
+                     int width,
+                     const ConvertRows &rows)
+{
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++)
+        rows.argb[x] = 0xff000000 | (0x010101 * quint32(line[x]));
+}
+
+static void readYUV444P(const quint8 *const *planes,
+                        int width,
+                        const ConvertRows &rows)
+{
+    memcpy(rows.y, planes[0], size_t(width));
+    memcpy(rows.u, planes[1], size_t(width));
+    memcpy(rows.v, planes[2], size_t(width));
+}
+
+static void readYUVSubsampledP(const quint8 *const *planes,
+                               int width,
+                               const ConvertRows &rows)
+{
+    memcpy(rows.y, planes[0], size_t(width));
+
+    for (int x = 0; x < width; x++) {
+        rows.u[x] = planes[1][x >> 1];
+        rows.v[x] = planes[2][x >> 1];
+    }
+}
+
+template <int Y0, int U, int Y1, int V>
+static void readPackedYUV422(const quint8 *const *planes,
+                             int width,
+                             const ConvertRows &rows)
+{
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x += 2, line += 4) {
+        rows.y[x] = line[Y0];
+        rows.u[x] = line[U];
+        rows.v[x] = line[V];
+
+        if (x + 1 < width) {
+            rows.y[x + 1] = line[Y1];
+            rows.u[x + 1] = line[U];
+            rows.v[x + 1] = line[V];
+        }
+    }
+}
+
+template <int U, int V>
+static void readSemiPlanar(const quint8 *const *planes,
+                           int width,
+                           const ConvertRows &rows)
+{
+    memcpy(rows.y, planes[0], size_t(width));
+
+    for (int x = 0; x < width; x++) {
+        auto chroma = planes[1] + 2 * (x >> 1);
+        rows.u[x] = chroma[U];
+        rows.v[x] = chroma[V];
+    }
+}
+
+// Writers
+
+static void writeARGB(const ConvertRows &rows,
+                      int width,
+                      quint8 *const *planes,
+                      bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+
+    memcpy(planes[0], rows.argb, size_t(width) * sizeof(quint32));
+}
+
+static void writeRGB24(const ConvertRows &rows,
+                       int width,
+                       quint8 *const *planes,
+                       bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 3) {
+        line[0] = quint8(rows.argb[x] >> 16);
+        line[1] = quint8(rows.argb[x] >> 8);
+        line[2] = quint8(rows.argb[x]);
+    }
+}
+
+static void writeBGR24(const ConvertRows &rows,
+                       int width,
+                       quint8 *const *planes,
+                       bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 3) {
+        line[0] = quint8(rows.argb[x]);
+        line[1] = quint8(rows.argb[x] >> 8);
+        line[2] = quint8(rows.argb[x] >> 16);
+    }
+}
+
+static void writeRGB565LE(const ConvertRows &rows,
+                          int width,
+                          quint8 *const *planes,
+                          bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 2) {
+        quint32 pixel = ((rows.argb[x] >> 8) & 0xf800)
+                      | ((rows.argb[x] >> 5) & 0x07e0)
+                      | ((rows.argb[x] >> 3) & 0x001f);
+        line[0] = quint8(pixel);
+        line[1] = quint8(pixel >> 8);
+    }
+}
+
+static void writeRGB555LE(const ConvertRows &rows,
+                          int width,
+                          quint8 *const *planes,
+                          bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x++, line += 2) {
+        quint32 pixel = ((rows.argb[x] >> 9) & 0x7c00)
+                      | ((rows.argb[x] >> 6) & 0x03e0)
+                      | ((rows.argb[x] >> 3) & 0x001f);
+        line[0] = quint8(pixel);
+        line[1] = quint8(pixel >> 8);
+    }
+}
+
+static void writeGray(const ConvertRows &rows,
+                      int width,
+                      quint8 *const *planes,
+                      bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+    auto line = planes[0];
+
+    // Same weights as qGray().
+    for (int x = 0; x < width; x++) {
+        quint32 r = (rows.argb[x] >> 16) & 0xff;
+        quint32 g = (rows.argb[x] >> 8) & 0xff;
+        quint32 b = rows.argb[x] & 0xff;
+        line[x] = quint8((11 * r + 16 * g + 5 * b) >> 5);
+    }
+}
+
+// Average two horizontally adjacent chroma samples.
+inline quint8 chromaPair(const quint8 *chroma, int x, int width)
+{
+    return x + 1 < width?
+                quint8((chroma[x] + chroma[x + 1] + 1) >> 1):
+                chroma[x];
+}
+
+static void writeYUV444P(const ConvertRows &rows,
+                         int width,
+                         quint8 *const *planes,
+                         bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+
+    memcpy(planes[0], rows.y, size_t(width));
+    memcpy(planes[1], rows.u, size_t(width));
+    memcpy(planes[2], rows.v, size_t(width));
+}
+
+static void writeYUVSubsampledP(const ConvertRows &rows,
+                                int width,
+                                quint8 *const *planes,
+                                bool writeChroma)
+{
+    memcpy(planes[0], rows.y, size_t(width));
+
+    if (!writeChroma)
+        return;
+
+    for (int x = 0; x < width; x += 2) {
+        planes[1][x >> 1] = chromaPair(rows.u, x, width);
+        planes[2][x >> 1] = chromaPair(rows.v, x, width);
+    }
+}
+
+template <int Y0, int U, int Y1, int V>
+static void writePackedYUV422(const ConvertRows &rows,
+                              int width,
+                              quint8 *const *planes,
+                              bool writeChroma)
+{
+    Q_UNUSED(writeChroma)
+    auto line = planes[0];
+
+    for (int x = 0; x < width; x += 2, line += 4) {
+        line[Y0] = rows.y[x];
+        line[Y1] = x + 1 < width? rows.y[x + 1]: rows.y[x];
+        line[U] = chromaPair(rows.u, x, width);
+        line[V] = chromaPair(rows.v, x, width);
+    }
+}
+
+template <int U, int V>
+static void writeSemiPlanar(const ConvertRows &rows,
+                            int width,
+                            quint8 *const *planes,
+                            bool writeChroma)
+{
+    memcpy(planes[0], rows.y, size_t(width));
+
+    if (!writeChroma)
+        return;
+
+    for (int x = 0; x < width; x += 2) {
+        auto chroma = planes[1] + x;
+        chroma[U] = chromaPair(rows.u, x, width);
+        chroma[V] = chromaPair(rows.v, x, width);
+    }
+}
+
+const FormatSpec *FormatSpec::byFormat(AkVideoCaps::PixelFormat format)
+{
+    static const FormatSpec formatSpecs[] = {
+        {AkVideoCaps::Format_argb    , ColorModelRGB, 1, {{0, 0, 4}, {0, 0, 0}, {0, 0, 0}}, readARGB    , writeARGB    },
+        {AkVideoCaps::Format_0rgb    , ColorModelRGB, 1, {{0, 0, 4}, {0, 0, 0}, {0, 0, 0}}, read0RGB    , writeARGB    },
+        {AkVideoCaps::Format_rgb24   , ColorModelRGB, 1, {{0, 0, 3}, {0, 0, 0}, {0, 0, 0}}, readRGB24   , writeRGB24   },
+        {AkVideoCaps::Format_bgr24   , ColorModelRGB, 1, {{0, 0, 3}, {0, 0, 0}, {0, 0, 0}}, readBGR24   , writeBGR24   },
+        {AkVideoCaps::Format_rgb565le, ColorModelRGB, 1, {{0, 0, 2}, {0, 0, 0}, {0, 0, 0}}, readRGB565LE, writeRGB565LE},
+        {AkVideoCaps::Format_rgb555le, ColorModelRGB, 1, {{0, 0, 2}, {0, 0, 0}, {0, 0, 0}}, readRGB555LE, writeRGB555LE},
+        {AkVideoCaps::Format_gray    , ColorModelRGB, 1, {{0, 0, 1}, {0, 0, 0}, {0, 0, 0}}, readGray    , writeGray    },
+        {AkVideoCaps::Format_yuv420p , ColorModelYUV, 3, {{0, 0, 1}, {1, 1, 1}, {1, 1, 1}}, readYUVSubsampledP      , writeYUVSubsampledP      },
+        {AkVideoCaps::Format_yuv422p , ColorModelYUV, 3, {{0, 0, 1}, {1, 0, 1}, {1, 0, 1}}, readYUVSubsampledP      , writeYUVSubsampledP      },
+        {AkVideoCaps::Format_yuv444p , ColorModelYUV, 3, {{0, 0, 1}, {0, 0, 1}, {0, 0, 1}}, readYUV444P             , writeYUV444P             },
+        {AkVideoCaps::Format_yuyv422 , ColorModelYUV, 1, {{1, 0, 4}, {0, 0, 0}, {0, 0, 0}}, readPackedYUV422<0, 1, 2, 3>, writePackedYUV422<0, 1, 2, 3>},
+        {AkVideoCaps::Format_uyvy422 , ColorModelYUV, 1, {{1, 0, 4}, {0, 0, 0}, {0, 0, 0}}, readPackedYUV422<1, 0, 3, 2>, writePackedYUV422<1, 0, 3, 2>},
+        {AkVideoCaps::Format_yvyu422 , ColorModelYUV, 1, {{1, 0, 4}, {0, 0, 0}, {0, 0, 0}}, readPackedYUV422<0, 3, 2, 1>, writePackedYUV422<0, 3, 2, 1>},
+        {AkVideoCaps::Format_nv12    , ColorModelYUV, 2, {{0, 0, 1}, {1, 1, 2}, {0, 0, 0}}, readSemiPlanar<0, 1>    , writeSemiPlanar<0, 1>    },
+        {AkVideoCaps::Format_nv21    , ColorModelYUV, 2, {{0, 0, 1}, {1, 1, 2}, {0, 0, 0}}, readSemiPlanar<1, 0>    , writeSemiPlanar<1, 0>    },
+    };
+
+    for (auto &spec: formatSpecs)
+        if (spec.format == format)
+            return &spec;
+
+    return nullptr;
+}
+
+class AkVideoConverterPrivate
+{
+    public:
+        QVector<quint32> m_argb;
+        QVector<quint32> m_argbScaled;
+        QVector<quint8> m_yuv;
+        QVector<quint8> m_yuvScaled;
+        QVector<int> m_xMap;
+
+        inline static bool layout(const FormatSpec *spec,
+                                  const AkVideoCaps &caps,
+                                  int bufferSize,
+                                  FrameLayout *frameLayout);
+        inline static ConvertRows rows(quint32 *argb,
+                                       quint8 *yuv,
+                                       int width);
+};
+
+/* Reads the plane layout of a frame from its caps.
+ *
+ * The layout of the planes is described by the caps, but frames coming from
+ * elements that don't fill it may still have padded lines. For single plane
+ * formats, if the caps don't set any layout and the buffer is bigger than
+ * the frame, the line size is derived from the buffer size instead.
+ */
+bool AkVideoConverterPrivate::layout(const FormatSpec *spec,
+                                     const AkVideoCaps &caps,
+                                     int bufferSize,
+                                     FrameLayout *frameLayout)
+{
+    memset(frameLayout, 0, sizeof(FrameLayout));
+
+    if (caps.planes() != spec->planes)
+        return false;
+
+    for (int plane = 0; plane < spec->planes; plane++) {
+        frameLayout->lineSize[plane] = caps.lineSize(plane);
+        frameLayout->offset[plane] = caps.planeOffset(plane);
+    }
+
+    frameLayout->size = caps.pictureSize();
+
+    if (bufferSize < 0)
+        return true;
+
+    if (spec->planes == 1
+        && caps.align() == 1
+        && caps.planeOffset(0) == 0
+        && bufferSize > frameLayout->size
+        && bufferSize % caps.height() == 0) {
+        frameLayout->lineSize[0] = bufferSize / caps.height();
+        frameLayout->size = bufferSize;
+    }
+
+    return bufferSize >= frameLayout->size;
+}
+
+ConvertRows AkVideoConverterPrivate::rows(quint32 *argb,
+                                          quint8 *yuv,
+                                          int width)
+{
+    return ConvertRows {argb, yuv, yuv + width, yuv + 2 * width};
+}
+
+AkVideoConverter::AkVideoConverter()
+{
+    this->d = new AkVideoConverterPrivate;
+}
+
+AkVideoConverter::~AkVideoConverter()
+{
+    delete this->d;
+}
+
+bool AkVideoConverter::canConvert(AkVideoCaps::PixelFormat format)
+{
+    return FormatSpec::byFormat(format) != nullptr;
+}
+
+QList<AkVideoCaps::PixelFormat> AkVideoConverter::supportedFormats()
+{
+    return {
+        AkVideoCaps::Format_argb,
+        AkVideoCaps::Format_0rgb,
+        AkVideoCaps::Format_rgb24,
+        AkVideoCaps::Format_bgr24,
+        AkVideoCaps::Format_rgb565le,
+        AkVideoCaps::Format_rgb555le,
+        AkVideoCaps::Format_gray,
+        AkVideoCaps::Format_yuv420p,
+        AkVideoCaps::Format_yuv422p,
+        AkVideoCaps::Format_yuv444p,
+        AkVideoCaps::Format_yuyv422,
+        AkVideoCaps::Format_uyvy422,
+        AkVideoCaps::Format_yvyu422,
+        AkVideoCaps::Format_nv12,
+        AkVideoCaps::Format_nv21
+    };
+}
+
+AkVideoPacket AkVideoConverter::convert(const AkVideoPacket &packet,
+                                        AkVideoCaps::PixelFormat format,
+                                        const QSize &size)
+{
+    auto iCaps = packet.caps();
+    auto iSpec = FormatSpec::byFormat(iCaps.format());
+    auto oSpec = FormatSpec::byFormat(format);
+
+    if (!iCaps || !iSpec || !oSpec)
+        return AkVideoPacket();
+
+    int iWidth = iCaps.width();
+    int iHeight = iCaps.height();
+    int oWidth = size.isEmpty()? iWidth: size.width();
+    int oHeight = size.isEmpty()? iHeight: size.height();
+
+    if (iWidth < 1 || iHeight < 1)
+        return AkVideoPacket();
+
+    // The output keeps the alignment of the input.
+    AkVideoCaps oCaps(iCaps);
+    oCaps.format() = format;
+    oCaps.bpp() = AkVideoCaps::bitsPerPixel(format);
+    oCaps.width() = oWidth;
+    oCaps.height() = oHeight;
+    oCaps.resetLayout();
+
+    FrameLayout iLayout;
+    FrameLayout oLayout;
+
+    if (!this->d->layout(iSpec, iCaps, packet.buffer().size(), &iLayout))
+        return AkVideoPacket();
+
+    this->d->layout(oSpec, oCaps, -1, &oLayout);
+
+    auto iBuffer = packet.buffer();
+    auto oBuffer = AkVideoBufferPool::globalInstance()->buffer(oCaps,
+                                                               oLayout.size);
+    auto iData = reinterpret_cast<const quint8 *>(iBuffer.constData());
+    auto oData = reinterpret_cast<quint8 *>(AkVideoBufferPool::data(oBuffer));
+
+    bool scaleX = oWidth != iWidth;
+    this->d->m_argb.resize(iWidth);
+    this->d->m_yuv.resize(3 * iWidth);
+    this->d->m_argbScaled.resize(oWidth);
+    this->d->m_yuvScaled.resize(3 * oWidth);
+    this->d->m_xMap.resize(oWidth);
+
+    for (int x = 0; x < oWidth; x++)
+        this->d->m_xMap[x] = x * iWidth / oWidth;
+
+    auto iRows = this->d->rows(this->d->m_argb.data(),
+                               this->d->m_yuv.data(),
+                               iWidth);
+    auto sRows = scaleX?
+                     this->d->rows(this->d->m_argbScaled.data(),
+                                   this->d->m_yuvScaled.data(),
+                                   oWidth):
+                     iRows;
+    auto xMap = this->d->m_xMap.constData();
+    int lastY = -1;
+
+    for (int y = 0; y < oHeight; y++) {
+        int ys = y * iHeight / oHeight;
+
+        // Unpack, resample and convert the source line only when it changes.
+        if (ys != lastY) {
+            const quint8 *iPlanes[3];
+
+            for (int plane = 0; plane < iSpec->planes; plane++)
+                iPlanes[plane] = iData
+                               + iLayout.offset[plane]
+                               + (ys >> iSpec->plane[plane].yShift)
+                                 * iLayout.lineSize[plane];
+
+            iSpec->read(iPlanes, iWidth, iRows);
+
+            if (scaleX) {
+                if (iSpec->model == ColorModelRGB) {
+                    for (int x = 0; x < oWidth; x++)
+                        sRows.argb[x] = iRows.argb[xMap[x]];
+                } else {
+                    for (int x = 0; x < oWidth; x++) {
+                        sRows.y[x] = iRows.y[xMap[x]];
+                        sRows.u[x] = iRows.u[xMap[x]];
+                        sRows.v[x] = iRows.v[xMap[x]];
+                    }
+                }
+            }
+
+            if (iSpec->model == ColorModelRGB && oSpec->model == ColorModelYUV)
+                argbToYuvRow(sRows.argb, sRows.y, sRows.u, sRows.v, oWidth);
+            else if (iSpec->model == ColorModelYUV && oSpec->model == ColorModelRGB)
+                yuvToArgbRow(sRows.y, sRows.u, sRows.v, sRows.argb, oWidth);
+
+            lastY = ys;
+        }
+
+        quint8 *oPlanes[3];
+        bool writeChroma = true;
+
+        for (int plane = 0; plane < oSpec->planes; plane++) {
+            int yShift = oSpec->plane[plane].yShift;
+            oPlanes[plane] = oData
+                           + oLayout.offset[plane]
+                           + (y >> yShift) * oLayout.lineSize[plane];
+
+            if (yShift > 0 && (y & ((1 << yShift) - 1)))
+                writeChroma = false;
+        }
+
+        oSpec->write(sRows, oWidth, oPlanes, writeChroma);
+    }
+
+    AkVideoPacket oPacket(packet);
+    oPacket.caps() = oCaps;
+    oPacket.buffer() = oBuffer;
+
+    return oPacket;
+}
@@ -0,0 +1,51 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVIDEOCONVERTER_H
+#define AKVIDEOCONVERTER_H
+
+#include <QSize>
+
+#include "akvideocaps.h"
+
+class AkVideoConverterPrivate;
+class AkVideoPacket;
+
+/* Built-in raw video converter.
+ *
+ * Converts between the most common packed and planar RGB and YUV formats,
+ * and rescales the frame (nearest neighbour) in the same pass.
+ */
+class AKCOMMONS_EXPORT AkVideoConverter
+{
+    public:
+        AkVideoConverter();
+        ~AkVideoConverter();
+
+        static bool canConvert(AkVideoCaps::PixelFormat format);
+        static QList<AkVideoCaps::PixelFormat> supportedFormats();
+        AkVideoPacket convert(const AkVideoPacket &packet,
+                              AkVideoCaps::PixelFormat format,
+                              const QSize &size=QSize());
+
+    private:
+        AkVideoConverterPrivate *d;
+};
+
+#endif // AKVIDEOCONVERTER_H
@@ -21,17 +21,20 @@
 #include <QVariant>
 
 #include "akvideopacket.h"
+#include "akpacketpool.h"
 #include "akcaps.h"
 #include "akvideocaps.h"
 
-class AkVideoPacketPrivate
+class AkVideoPacketPrivate: public QSharedData
 {
     public:
         AkVideoCaps m_caps;
+
+        AK_PACKET_POOL_ALLOCATED(AkVideoPacketPrivate)
 };
 
-AkVideoPacket::AkVideoPacket(QObject *parent):
-    AkPacket(parent)
+AkVideoPacket::AkVideoPacket():
+    AkPacket()
 {
     this->d = new AkVideoPacketPrivate();
 }
@@ -52,45 +55,27 @@ AkVideoPacket::AkVideoPacket(const AkVideoCaps &caps,
     this->id() = id;
 }
 
-AkVideoPacket::AkVideoPacket(const AkPacket &other)
+AkVideoPacket::AkVideoPacket(const AkPacket &other):
+    AkPacket(other)
 {
     this->d = new AkVideoPacketPrivate();
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
 }
 
 AkVideoPacket::AkVideoPacket(const AkVideoPacket &other):
-    AkPacket()
+    AkPacket(other),
+    d(other.d)
 {
-    this->d = new AkVideoPacketPrivate();
-    this->d->m_caps = other.d->m_caps;
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
 }
 
 AkVideoPacket::~AkVideoPacket()
 {
-    delete this->d;
 }
 
 AkVideoPacket &AkVideoPacket::operator =(const AkPacket &other)
 {
+    AkPacket::operator =(other);
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
 
     return *this;
 }
@@ -98,13 +83,8 @@ AkVideoPacket &AkVideoPacket::operator =(const AkPacket &other)
 AkVideoPacket &AkVideoPacket::operator =(const AkVideoPacket &other)
 {
     if (this != &other) {
-        this->d->m_caps = other.d->m_caps;
-        this->data() = other.data();
-        this->buffer() = other.buffer();
-        this->pts() = other.pts();
-        this->timeBase() = other.timeBase();
-        this->index() = other.index();
-        this->id() = other.id();
+        AkPacket::operator =(other);
+        this->d = other.d;
     }
 
     return *this;
@@ -177,11 +157,7 @@ AkPacket AkVideoPacket::toPacket() const
 
 void AkVideoPacket::setCaps(const AkVideoCaps &caps)
 {
-    if (this->d->m_caps == caps)
-        return;
-
     this->d->m_caps = caps;
-    emit this->capsChanged(caps);
 }
 
 void AkVideoPacket::resetCaps()
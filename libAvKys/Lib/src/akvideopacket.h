@@ -27,15 +27,14 @@ class AkVideoCaps;
 
 class AKCOMMONS_EXPORT AkVideoPacket: public AkPacket
 {
-    Q_OBJECT
+    Q_GADGET
     Q_PROPERTY(AkVideoCaps caps
                READ caps
                WRITE setCaps
-               RESET resetCaps
-               NOTIFY capsChanged)
+               RESET resetCaps)
 
     public:
-        explicit AkVideoPacket(QObject *parent=nullptr);
+        AkVideoPacket();
         AkVideoPacket(const AkVideoCaps &caps,
                       const QByteArray &buffer=QByteArray(),
                       qint64 pts=0,
@@ -55,17 +54,13 @@ class AKCOMMONS_EXPORT AkVideoPacket: public AkPacket
         Q_INVOKABLE QString toString() const;
         Q_INVOKABLE AkPacket toPacket() const;
 
-    private:
-        AkVideoPacketPrivate *d;
-
-    Q_SIGNALS:
-        void capsChanged(const AkVideoCaps &caps);
+        Q_INVOKABLE void setCaps(const AkVideoCaps &caps);
+        Q_INVOKABLE void resetCaps();
 
-    public Q_SLOTS:
-        void setCaps(const AkVideoCaps &caps);
-        void resetCaps();
+    private:
+        QSharedDataPointer<AkVideoPacketPrivate> d;
 
-        friend QDebug operator <<(QDebug debug, const AkVideoPacket &packet);
+    friend QDebug operator <<(QDebug debug, const AkVideoPacket &packet);
 };
 
 QDebug operator <<(QDebug debug, const AkVideoPacket &packet);
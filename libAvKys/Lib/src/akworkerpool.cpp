@@ -0,0 +1,261 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "akworkerpool.h"
+
+// Chunks per thread when the grain is chosen automatically.
+#define AUTO_CHUNKS_PER_THREAD 4
+
+class AkWorkerPoolJob
+{
+    public:
+        const AkWorkerPool::RangeFunc *m_func;
+        int m_rows;
+        int m_grain;
+        int m_chunks;
+        QAtomicInt m_next;
+        QAtomicInt m_pending;
+        QAtomicInteger<qint64> m_busyTime;
+        QMutex m_mutex;
+        QWaitCondition m_done;
+
+        AkWorkerPoolJob(const AkWorkerPool::RangeFunc *func,
+                        int rows,
+                        int grain):
+            m_func(func),
+            m_rows(rows),
+            m_grain(grain),
+            m_chunks((rows + grain - 1) / grain),
+            m_next(0),
+            m_pending((rows + grain - 1) / grain),
+            m_busyTime(0)
+        {
+        }
+
+        inline void work();
+        inline void wait();
+};
+
+class AkWorkerPoolTask: public QRunnable
+{
+    public:
+        AkWorkerPoolTask(const QSharedPointer<AkWorkerPoolJob> &job):
+            m_job(job)
+        {
+            this->setAutoDelete(true);
+        }
+
+        void run()
+        {
+            this->m_job->work();
+        }
+
+    private:
+        QSharedPointer<AkWorkerPoolJob> m_job;
+};
+
+struct AkWorkerPoolStats
+{
+    quint64 calls;
+    qint64 wallTime;
+    qint64 busyTime;
+};
+
+class AkWorkerPoolPrivate
+{
+    public:
+        QThreadPool m_pool;
+        QHash<QByteArray, AkWorkerPoolStats> m_stats;
+        mutable QMutex m_mutex;
+
+        inline void record(const char *tag, qint64 wallTime, qint64 busyTime);
+        inline static int defaultMaxThreads();
+};
+
+Q_GLOBAL_STATIC(AkWorkerPool, akWorkerPool)
+
+AkWorkerPool::AkWorkerPool(int maxThreads)
+{
+    this->d = new AkWorkerPoolPrivate;
+    this->d->m_pool.setMaxThreadCount(maxThreads < 0?
+                                          AkWorkerPoolPrivate::defaultMaxThreads():
+                                          maxThreads);
+}
+
+AkWorkerPool::~AkWorkerPool()
+{
+    this->d->m_pool.waitForDone();
+    delete this->d;
+}
+
+AkWorkerPool *AkWorkerPool::globalInstance()
+{
+    return akWorkerPool;
+}
+
+int AkWorkerPool::maxThreads() const
+{
+    return this->d->m_pool.maxThreadCount();
+}
+
+void AkWorkerPool::setMaxThreads(int maxThreads)
+{
+    this->d->m_pool.setMaxThreadCount(maxThreads);
+}
+
+void AkWorkerPool::resetMaxThreads()
+{
+    this->setMaxThreads(AkWorkerPoolPrivate::defaultMaxThreads());
+}
+
+void AkWorkerPool::parallelFor(int rows,
+                               int grain,
+                               const RangeFunc &func,
+                               const char *tag)
+{
+    if (rows < 1)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int threads = this->d->m_pool.maxThreadCount();
+
+    if (grain < 1)
+        grain = qMax(1, rows / (AUTO_CHUNKS_PER_THREAD * (threads + 1)));
+
+    int chunks = (rows + grain - 1) / grain;
+    int helpers = qMin(threads - this->d->m_pool.activeThreadCount(),
+                       chunks - 1);
+
+    if (helpers < 1) {
+        func(0, rows);
+        qint64 wallTime = timer.nsecsElapsed();
+        this->d->record(tag, wallTime, wallTime);
+
+        return;
+    }
+
+    auto job = QSharedPointer<AkWorkerPoolJob>::create(&func, rows, grain);
+
+    for (int i = 0; i < helpers; i++)
+        this->d->m_pool.start(new AkWorkerPoolTask(job));
+
+    job->work();
+    job->wait();
+
+    this->d->record(tag, timer.nsecsElapsed(), job->m_busyTime.load());
+}
+
+QVariantMap AkWorkerPool::statistics() const
+{
+    QVariantMap statistics;
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+
+    for (auto it = this->d->m_stats.constBegin();
+         it != this->d->m_stats.constEnd();
+         it++) {
+        qreal speedup = it->wallTime > 0?
+                            qreal(it->busyTime) / it->wallTime: 1.0;
+
+        statistics[QString::fromUtf8(it.key())] = QVariantMap {
+            {"calls"   , it->calls   },
+            {"wallTime", it->wallTime},
+            {"busyTime", it->busyTime},
+            {"speedup" , speedup     }
+        };
+    }
+
+    return statistics;
+}
+
+void AkWorkerPool::resetStatistics()
+{
+    QMutexLocker mutexLocker(&this->d->m_mutex);
+    this->d->m_stats.clear();
+}
+
+void AkWorkerPoolJob::work()
+{
+    QElapsedTimer timer;
+    timer.start();
+    int finished = 0;
+
+    forever {
+        int chunk = this->m_next.fetchAndAddRelaxed(1);
+
+        if (chunk >= this->m_chunks)
+            break;
+
+        int first = chunk * this->m_grain;
+        int last = qMin(first + this->m_grain, this->m_rows);
+        (*this->m_func)(first, last);
+        finished++;
+    }
+
+    if (finished < 1)
+        return;
+
+    this->m_busyTime.fetchAndAddRelaxed(timer.nsecsElapsed());
+
+    if (this->m_pending.fetchAndAddOrdered(-finished) == finished) {
+        this->m_mutex.lock();
+        this->m_done.wakeAll();
+        this->m_mutex.unlock();
+    }
+}
+
+void AkWorkerPoolJob::wait()
+{
+    this->m_mutex.lock();
+
+    while (this->m_pending.loadAcquire() > 0)
+        this->m_done.wait(&this->m_mutex);
+
+    this->m_mutex.unlock();
+}
+
+void AkWorkerPoolPrivate::record(const char *tag,
+                                 qint64 wallTime,
+                                 qint64 busyTime)
+{
+    if (!tag)
+        return;
+
+    QMutexLocker mutexLocker(&this->m_mutex);
+    auto &stats = this->m_stats[QByteArray(tag)];
+    stats.calls++;
+    stats.wallTime += wallTime;
+    stats.busyTime += busyTime;
+}
+
+int AkWorkerPoolPrivate::defaultMaxThreads()
+{
+    // The calling thread works too.
+    return qMax(QThread::idealThreadCount() - 1, 1);
+}
@@ -0,0 +1,73 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+#ifndef AKWORKERPOOL_H
+#define AKWORKERPOOL_H
+
+#include <functional>
+#include <QVariantMap>
+
+#include "akcommons.h"
+
+class AkWorkerPoolPrivate;
+
+/* Process wide pool of worker threads for data parallel work.
+ *
+ * parallelFor() splits [0, rows) in chunks of grain rows. The calling thread
+ * and the free workers claim the chunks one by one until none is left, so a
+ * thread that finishes early takes over the remaining work of the others.
+ *
+ * All the elements share the same workers, and only the ones that are idle
+ * at the moment of the call are recruited, so several elements processing
+ * at the same time don't oversubscribe the cores. The caller never waits for
+ * a chunk that nobody is running, so nested calls can't deadlock.
+ */
+class AKCOMMONS_EXPORT AkWorkerPool
+{
+    Q_DISABLE_COPY(AkWorkerPool)
+
+    public:
+        typedef std::function<void (int first, int last)> RangeFunc;
+
+        AkWorkerPool(int maxThreads=-1);
+        ~AkWorkerPool();
+
+        static AkWorkerPool *globalInstance();
+
+        int maxThreads() const;
+        void setMaxThreads(int maxThreads);
+        void resetMaxThreads();
+
+        // A grain < 1 picks the chunk size from the number of threads.
+        void parallelFor(int rows,
+                         int grain,
+                         const RangeFunc &func,
+                         const char *tag=nullptr);
+
+        /* Per tag statistics of the parallelFor() calls: number of calls,
+         * wall and busy time in nanoseconds, and the achieved speedup
+         * (busy time / wall time).
+         */
+        QVariantMap statistics() const;
+        void resetStatistics();
+
+    private:
+        AkWorkerPoolPrivate *d;
+};
+
+#endif // AKWORKERPOOL_H
@@ -62,6 +62,11 @@ bool BinElement::blocking() const
     return this->d->m_blocking;
 }
 
+QString BinElement::plan() const
+{
+    return this->d->m_pipelineDescription.plan();
+}
+
 AkElementPtr BinElement::element(const QString &elementName)
 {
     return this->d->m_elements[elementName];
@@ -44,11 +44,14 @@ class PipelinePrivate
         QList<QStringList> m_connections;
         QVariantMap m_properties;
         QString m_error;
+        QStringList m_plan;
 
         inline QMetaMethod methodByName(QObject *object,
                                         const QString &methodName,
                                         QMetaMethod::MethodType methodType);
         inline QVariant solveProperty(const QVariant &property) const;
+        inline bool isNoOp(const QString &elementName) const;
+        inline bool bypass(const QString &elementName);
 };
 
 Pipeline::Pipeline(QObject *parent):
@@ -259,6 +262,8 @@ bool Pipeline::parse(const QString &description)
         }
     }
 
+    this->compile();
+
     if (this->linkAll()) {
         if (this->connectAll())
             return true;
@@ -398,6 +403,42 @@ QList<Qt::ConnectionType> Pipeline::outputConnectionTypes() const
     return outputoutputConnectionTypes;
 }
 
+QString Pipeline::plan() const
+{
+    return this->d->m_plan.join('\n');
+}
+
+/* Optimizes the graph before linking it.
+ *
+ * Multiplex and Probe elements that just forward the packets are removed,
+ * and their input and output links are merged. The result can be inspected
+ * with plan().
+ */
+bool Pipeline::compile()
+{
+    this->d->m_plan.clear();
+
+    for (const QString &elementName: this->d->m_elements.keys()) {
+        if (!this->d->isNoOp(elementName))
+            continue;
+
+        auto pluginId = this->d->m_elements[elementName]->pluginId();
+
+        if (this->d->bypass(elementName))
+            this->d->m_plan << QString("bypass %1 (%2)")
+                               .arg(elementName)
+                               .arg(pluginId);
+    }
+
+    for (const QStringList &link: this->d->m_links)
+        this->d->m_plan << QString("link %1 -> %2 %3")
+                           .arg(link[0])
+                           .arg(link[1])
+                           .arg(link.value(2, "AutoConnection"));
+
+    return true;
+}
+
 QMetaMethod PipelinePrivate::methodByName(QObject *object,
                                           const QString &methodName,
                                           QMetaMethod::MethodType methodType)
@@ -654,6 +695,68 @@ QVariant PipelinePrivate::solveProperty(const QVariant &property) const
     return QVariant(QVariantList());
 }
 
+bool PipelinePrivate::isNoOp(const QString &elementName) const
+{
+    auto element = this->m_elements.value(elementName);
+
+    // Named elements can be accessed from outside, keep them.
+    if (!element || !element->objectName().isEmpty())
+        return false;
+
+    for (const QStringList &connection: this->m_connections)
+        if (connection[0] == elementName
+            || connection[2] == elementName)
+            return false;
+
+    if (element->pluginId() == "Multiplex")
+        return element->property("inputIndex").toInt() < 0
+               && element->property("outputIndex").toInt() < 0
+               && element->property("caps").toString().isEmpty();
+
+    if (element->pluginId() == "Probe")
+        return !element->property("log").toBool();
+
+    return false;
+}
+
+bool PipelinePrivate::bypass(const QString &elementName)
+{
+    QList<QStringList> inputs;
+    QList<QStringList> outputs;
+    QList<QStringList> links;
+
+    for (const QStringList &link: this->m_links)
+        if (link[0] == elementName && link[1] == elementName)
+            return false;
+        else if (link[1] == elementName)
+            inputs << link;
+        else if (link[0] == elementName)
+            outputs << link;
+        else
+            links << link;
+
+    for (const QStringList &input: inputs)
+        for (const QStringList &output: outputs) {
+            // Don't leave the bin without elements.
+            if (input[0] == "IN." && output[1] == "OUT.")
+                return false;
+
+            QString inputType = input.value(2, "AutoConnection");
+            QString outputType = output.value(2, "AutoConnection");
+
+            // The explicit type wins.
+            QString connectionType =
+                    inputType != "AutoConnection"? inputType: outputType;
+
+            links << QStringList {input[0], output[1], connectionType};
+        }
+
+    this->m_links = links;
+    this->m_elements.remove(elementName);
+
+    return true;
+}
+
 void Pipeline::addLinks(const QStringList &links)
 {
     QStringList link;
@@ -813,6 +916,7 @@ void Pipeline::cleanAll()
     this->resetElements();
     this->resetLinks();
     this->d->m_connections.clear();
+    this->d->m_plan.clear();
     this->resetProperties();
     this->resetError();
 }
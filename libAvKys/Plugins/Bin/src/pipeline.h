@@ -51,6 +51,8 @@ class Pipeline: public QObject
                READ inputs)
     Q_PROPERTY(QList<AkElementPtr> outputs
                READ outputs)
+    Q_PROPERTY(QString plan
+               READ plan)
 
     public:
         explicit Pipeline(QObject *parent=nullptr);
@@ -67,6 +69,8 @@ class Pipeline: public QObject
         Q_INVOKABLE QList<AkElementPtr> inputs() const;
         Q_INVOKABLE QList<AkElementPtr> outputs() const;
         Q_INVOKABLE QList<Qt::ConnectionType> outputConnectionTypes() const;
+        Q_INVOKABLE QString plan() const;
+        Q_INVOKABLE bool compile();
         Q_INVOKABLE bool linkAll();
         Q_INVOKABLE bool unlinkAll();
         Q_INVOKABLE bool connectAll();
@@ -32,6 +32,10 @@ GridLayout {
             sldRadius.value = radius
             spbRadius.rvalue = radius
         }
+        onPassesChanged: {
+            sldPasses.value = passes
+            spbPasses.rvalue = passes
+        }
     }
 
     // Configure blur radius.
@@ -56,4 +60,29 @@ GridLayout {
 
         onRvalueChanged: Blur.radius = rvalue
     }
+
+    // Configure the number of box blur passes, 3 looks Gaussian.
+    Label {
+        id: lblPasses
+        text: qsTr("Passes")
+    }
+    Slider {
+        id: sldPasses
+        value: Blur.passes
+        stepSize: 1
+        from: 1
+        to: 8
+        Layout.fillWidth: true
+
+        onValueChanged: Blur.passes = value
+    }
+    AkSpinBox {
+        id: spbPasses
+        rvalue: Blur.passes
+        minimumValue: sldPasses.from
+        maximumValue: sldPasses.to
+        step: sldPasses.stepSize
+
+        onRvalueChanged: Blur.passes = rvalue
+    }
 }
@@ -18,26 +18,37 @@
  */
 
 #include <QImage>
+#include <QVarLengthArray>
+#include <QtMath>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "blurelement.h"
-#include "pixel.h"
+
+// The reciprocals are scaled by 2^BLUR_RECIPROCAL_SHIFT.
+#define BLUR_RECIPROCAL_SHIFT 40
 
 class BlurElementPrivate
 {
     public:
         int m_radius;
+        int m_passes;
+
+        // Scratch buffers, kept between frames.
+        QVector<quint32> m_sums;
+        QVector<quint64> m_reciprocals;
+        QImage m_passFrame;
 
         BlurElementPrivate():
-            m_radius(5)
+            m_radius(5),
+            m_passes(1)
         {
         }
 
-        inline void integralImage(const QImage &image,
-                                  int oWidth, int oHeight,
-                                  PixelU32 *integral);
+        inline const quint64 *reciprocals(int radius);
+        inline void blur(const QImage &src, QImage &dst, int radius);
 };
 
 BlurElement::BlurElement():
@@ -56,33 +67,150 @@ int BlurElement::radius() const
     return this->d->m_radius;
 }
 
-void BlurElementPrivate::integralImage(const QImage &image,
-                                       int oWidth, int oHeight,
-                                       PixelU32 *integral)
+int BlurElement::passes() const
 {
-    for (int y = 1; y < oHeight; y++) {
-        auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y - 1));
-
-        // Reset current line summation.
-        PixelU32 sum;
-
-        for (int x = 1; x < oWidth; x++) {
-            QRgb pixel = line[x - 1];
-
-            // Accumulate pixels in current line.
-            sum += pixel;
+    return this->d->m_passes;
+}
 
-            // Offset to the current line.
-            int offset = x + y * oWidth;
+const quint64 *BlurElementPrivate::reciprocals(int radius)
+{
+    /* x / n is computed as (x * ceil(2^40 / n)) >> 40, which is exact for
+     * all the sums a window of n pixels can have in any practical frame size.
+     */
+    int size = 2 * radius + 2;
+
+    if (this->m_reciprocals.size() != size) {
+        this->m_reciprocals.resize(size);
+        this->m_reciprocals[0] = 0;
+
+        for (int n = 1; n < size; n++)
+            this->m_reciprocals[n] =
+                    ((Q_UINT64_C(1) << BLUR_RECIPROCAL_SHIFT) + quint64(n) - 1)
+                    / quint64(n);
+    }
 
-            // Offset to the previous line.
-            // equivalent to x + (y - 1) * oWidth;
-            int offsetPrevious = offset - oWidth;
+    return this->m_reciprocals.constData();
+}
 
-            // Accumulate current line and previous line.
-            integral[offset] = sum + integral[offsetPrevious];
+void BlurElementPrivate::blur(const QImage &src, QImage &dst, int radius)
+{
+    int width = src.width();
+    int height = src.height();
+    int lineSize = 4 * width;
+
+    if (this->m_sums.size() < lineSize * height)
+        this->m_sums.resize(lineSize * height);
+
+    auto sums = this->m_sums.data();
+    auto reciprocals = this->reciprocals(radius);
+
+    // Horizontal running sums, the lines go in parallel.
+    AkPixelKernel<>::forEachBand(height, [&] (int first, int last) {
+        for (int y = first; y < last; y++) {
+            auto line = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto sumLine = sums + y * lineSize;
+            quint32 r = 0;
+            quint32 g = 0;
+            quint32 b = 0;
+            quint32 a = 0;
+
+            for (int x = 0; x < qMin(radius, width); x++) {
+                r += quint32(qRed(line[x]));
+                g += quint32(qGreen(line[x]));
+                b += quint32(qBlue(line[x]));
+                a += quint32(qAlpha(line[x]));
+            }
+
+            for (int x = 0; x < width; x++, sumLine += 4) {
+                int xIn = x + radius;
+                int xOut = x - radius - 1;
+
+                if (xIn < width) {
+                    r += quint32(qRed(line[xIn]));
+                    g += quint32(qGreen(line[xIn]));
+                    b += quint32(qBlue(line[xIn]));
+                    a += quint32(qAlpha(line[xIn]));
+                }
+
+                if (xOut >= 0) {
+                    r -= quint32(qRed(line[xOut]));
+                    g -= quint32(qGreen(line[xOut]));
+                    b -= quint32(qBlue(line[xOut]));
+                    a -= quint32(qAlpha(line[xOut]));
+                }
+
+                sumLine[0] = r;
+                sumLine[1] = g;
+                sumLine[2] = b;
+                sumLine[3] = a;
+            }
         }
-    }
+    }, true, "Blur");
+
+    // scanLine() detaches, so it can't be called from the workers.
+    auto dstBits = dst.bits();
+    auto dstLineSize = dst.bytesPerLine();
+
+    /* Vertical running sums, the columns go in parallel. Each band walks down
+     * the lines keeping the sums of its own columns, so the memory is still
+     * read line by line.
+     */
+    AkPixelKernel<>::forEachBand(width, [&] (int first, int last) {
+        int bandSize = 4 * (last - first);
+        QVarLengthArray<quint32, 1024> column(bandSize);
+        memset(column.data(), 0, size_t(bandSize) * sizeof(quint32));
+
+        auto addLine = [&] (int y) {
+            auto sumLine = sums + y * lineSize + 4 * first;
+
+            for (int k = 0; k < bandSize; k++)
+                column[k] += sumLine[k];
+        };
+
+        auto removeLine = [&] (int y) {
+            auto sumLine = sums + y * lineSize + 4 * first;
+
+            for (int k = 0; k < bandSize; k++)
+                column[k] -= sumLine[k];
+        };
+
+        for (int y = 0; y < qMin(radius, height); y++)
+            addLine(y);
+
+        for (int y = 0; y < height; y++) {
+            int yIn = y + radius;
+            int yOut = y - radius - 1;
+
+            if (yIn < height)
+                addLine(yIn);
+
+            if (yOut >= 0)
+                removeLine(yOut);
+
+            // The window is cut at the borders of the frame.
+            int kh = qMin(y + radius, height - 1) - qMax(y - radius, 0) + 1;
+            quint64 khInv = reciprocals[kh];
+            auto oLine = reinterpret_cast<QRgb *>(dstBits + y * dstLineSize);
+            const quint32 *sum = column.constData();
+
+            for (int x = first; x < last; x++, sum += 4) {
+                int kw = qMin(x + radius, width - 1) - qMax(x - radius, 0) + 1;
+                quint64 kwInv = reciprocals[kw];
+
+                // floor(floor(s / kw) / kh) == floor(s / (kw * kh))
+                auto mean = [kwInv, khInv] (quint32 s) -> int {
+                    quint64 m = (quint64(s) * kwInv) >> BLUR_RECIPROCAL_SHIFT;
+
+                    return int((m * khInv) >> BLUR_RECIPROCAL_SHIFT);
+                };
+
+                oLine[x] = qRgba(mean(sum[0]),
+                                 mean(sum[1]),
+                                 mean(sum[2]),
+                                 mean(sum[3]));
+            }
+        }
+    }, true, "Blur");
 }
 
 QString BlurElement::controlInterfaceProvide(const QString &controlId) const
@@ -110,11 +238,25 @@ void BlurElement::setRadius(int radius)
     emit this->radiusChanged(radius);
 }
 
+void BlurElement::setPasses(int passes)
+{
+    if (this->d->m_passes == passes)
+        return;
+
+    this->d->m_passes = passes;
+    emit this->passesChanged(passes);
+}
+
 void BlurElement::resetRadius()
 {
     this->setRadius(5);
 }
 
+void BlurElement::resetPasses()
+{
+    this->setPasses(1);
+}
+
 AkPacket BlurElement::iStream(const AkPacket &packet)
 {
     QImage src = AkUtils::packetToImage(packet);
@@ -123,33 +265,30 @@ AkPacket BlurElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
-
-    int oWidth = src.width() + 1;
-    int oHeight = src.height() + 1;
-    PixelU32 *integral = new PixelU32[oWidth * oHeight];
-    this->d->integralImage(src, oWidth, oHeight, integral);
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
-    int radius = this->d->m_radius;
+    int radius = qMax(0, this->d->m_radius);
+    int passes = qBound(1, this->d->m_passes, 8);
 
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        int yp = qMax(y - radius, 0);
-        int kh = qMin(y + radius, src.height() - 1) - yp + 1;
+    /* A single pass is a box blur. Several box blurs in a row approach a
+     * Gaussian blur, each one takes a smaller radius so the result spreads as
+     * much as a single box of the requested radius.
+     */
+    if (passes > 1)
+        radius = qRound(radius / qSqrt(passes));
 
-        for (int x = 0; x < src.width(); x++) {
-            int xp = qMax(x - radius, 0);
-            int kw = qMin(x + radius, src.width() - 1) - xp + 1;
+    if (passes > 1 && this->d->m_passFrame.size() != src.size())
+        this->d->m_passFrame = QImage(src.size(), src.format());
 
-            PixelU32 sum = integralSum(integral, oWidth, xp, yp, kw, kh);
-            PixelU32 mean = sum / quint32(kw * kh);
+    // Alternate between both frames, so the last pass ends in oFrame.
+    const QImage *input = &src;
 
-            oLine[x] = qRgba(int(mean.r), int(mean.g), int(mean.b), int(mean.a));
-        }
+    for (int pass = passes; pass > 0; pass--) {
+        QImage &output = pass & 1? oFrame: this->d->m_passFrame;
+        this->d->blur(*input, output, radius);
+        input = &output;
     }
 
-    delete [] integral;
-
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
@@ -32,12 +32,18 @@ class BlurElement: public AkElement
                WRITE setRadius
                RESET resetRadius
                NOTIFY radiusChanged)
+    Q_PROPERTY(int passes
+               READ passes
+               WRITE setPasses
+               RESET resetPasses
+               NOTIFY passesChanged)
 
     public:
         explicit BlurElement();
         ~BlurElement();
 
         Q_INVOKABLE int radius() const;
+        Q_INVOKABLE int passes() const;
 
     private:
         BlurElementPrivate *d;
@@ -49,10 +55,13 @@ class BlurElement: public AkElement
 
     signals:
         void radiusChanged(int radius);
+        void passesChanged(int passes);
 
     public slots:
         void setRadius(int radius);
+        void setPasses(int passes);
         void resetRadius();
+        void resetPasses();
         AkPacket iStream(const AkPacket &packet);
 };
 
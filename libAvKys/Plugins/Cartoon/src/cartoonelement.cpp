@@ -449,7 +449,7 @@ AkPacket CartoonElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (this->d->m_id != packet.id()) {
         this->d->m_id = packet.id();
@@ -19,7 +19,9 @@
 
 #include <QVariant>
 #include <QImage>
+#include <QMutex>
 #include <QQmlContext>
+#include <akcolorlut.h>
 #include <akutils.h>
 #include <akpacket.h>
 
@@ -29,6 +31,16 @@ class ChangeHSLElementPrivate
 {
     public:
         QVector<qreal> m_kernel;
+        QMutex m_mutex;
+        AkColorLut m_lut;
+        bool m_lutDirty;
+
+        ChangeHSLElementPrivate():
+            m_lutDirty(true)
+        {
+        }
+
+        inline void updateLut(const QVector<qreal> &kernel);
 };
 
 ChangeHSLElement::ChangeHSLElement(): AkElement()
@@ -51,9 +63,13 @@ QVariantList ChangeHSLElement::kernel() const
 {
     QVariantList kernel;
 
+    this->d->m_mutex.lock();
+
     for (const qreal &e: this->d->m_kernel)
         kernel << e;
 
+    this->d->m_mutex.unlock();
+
     return kernel;
 }
 
@@ -80,10 +96,18 @@ void ChangeHSLElement::setKernel(const QVariantList &kernel)
     for (const QVariant &e: kernel)
         k << e.toReal();
 
-    if (this->d->m_kernel == k)
+    this->d->m_mutex.lock();
+
+    if (this->d->m_kernel == k) {
+        this->d->m_mutex.unlock();
+
         return;
+    }
 
     this->d->m_kernel = k;
+    this->d->m_lutDirty = true;
+    this->d->m_mutex.unlock();
+
     emit this->kernelChanged(kernel);
 }
 
@@ -100,47 +124,98 @@ void ChangeHSLElement::resetKernel()
 
 AkPacket ChangeHSLElement::iStream(const AkPacket &packet)
 {
-    if (this->d->m_kernel.size() < 12)
+    this->d->m_mutex.lock();
+    QVector<qreal> kernel = this->d->m_kernel;
+    bool lutDirty = this->d->m_lutDirty;
+    this->d->m_lutDirty = false;
+    this->d->m_mutex.unlock();
+
+    if (kernel.size() < 12)
         akSend(packet)
 
+    // The table is only touched from here, rebuild it out of the lock.
+    if (lutDirty || this->d->m_lut.isEmpty())
+        this->d->updateLut(kernel);
+
     QImage src = AkUtils::packetToImage(packet);
 
     if (src.isNull())
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
-    QVector<qreal> kernel = this->d->m_kernel;
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+    this->d->m_lut.apply(src, oFrame, true, "ChangeHSL");
+
+    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+    akSend(oPacket)
+}
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+void ChangeHSLElementPrivate::updateLut(const QVector<qreal> &kernel)
+{
+    /* QColor is far too slow to run on every pixel, so the transform is
+     * sampled once per kernel change on the lattice of the table.
+     */
+    auto transform = [kernel] (int r, int g, int b) -> QRgb {
+        int h;
+        int s;
+        int l;
 
-        for (int x = 0; x < src.width(); x++) {
-            int h;
-            int s;
-            int l;
-            int a;
+        QColor(r, g, b).getHsl(&h, &s, &l);
 
-            QColor(srcLine[x]).getHsl(&h, &s, &l, &a);
+        int ht = int(h * kernel[0] + s * kernel[1] + l * kernel[2]  + kernel[3]);
+        int st = int(h * kernel[4] + s * kernel[5] + l * kernel[6]  + kernel[7]);
+        int lt = int(h * kernel[8] + s * kernel[9] + l * kernel[10] + kernel[11]);
 
-            int ht = int(h * kernel[0] + s * kernel[1] + l * kernel[2]  + kernel[3]);
-            int st = int(h * kernel[4] + s * kernel[5] + l * kernel[6]  + kernel[7]);
-            int lt = int(h * kernel[8] + s * kernel[9] + l * kernel[10] + kernel[11]);
+        ht = qBound(0, ht, 359);
+        st = qBound(0, st, 255);
+        lt = qBound(0, lt, 255);
 
-            ht = qBound(0, ht, 359);
-            st = qBound(0, st, 255);
-            lt = qBound(0, lt, 255);
+        return QColor::fromHsl(ht, st, lt).rgb();
+    };
 
-            QColor color;
-            color.setHsl(ht, st, lt, a);
+    /* The hue jumps from 359 to 0 across the reds, and it's undefined for the
+     * grays, so the transform is only continuous if it ignores the hue, or
+     * passes it through and keeps the grays gray.
+     */
+    bool hueUnused = qFuzzyIsNull(kernel[0])
+                     && qFuzzyIsNull(kernel[4])
+                     && qFuzzyIsNull(kernel[8]);
+    bool huePassed = qFuzzyCompare(kernel[0], 1.0)
+                     && qFuzzyIsNull(kernel[1])
+                     && qFuzzyIsNull(kernel[2])
+                     && qFuzzyIsNull(kernel[3])
+                     && qFuzzyIsNull(kernel[4])
+                     && qFuzzyIsNull(kernel[6])
+                     && qFuzzyIsNull(kernel[7])
+                     && qFuzzyIsNull(kernel[8]);
+
+    if (hueUnused || huePassed) {
+        this->m_lut.build(transform);
 
-            dstLine[x] = color.rgba();
-        }
+        return;
     }
 
-    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
-    akSend(oPacket)
+    /* Otherwise the cells touching a gray, or crossing the reds, are not
+     * interpolated. Inside any other cell the hue barely changes.
+     */
+    this->m_lut.build(transform, true, [] (QRgb lower, QRgb upper) {
+        int minHue = 360;
+        int maxHue = -1;
+
+        for (int i = 0; i < 8; i++) {
+            int h = QColor(qRed(i & 0x4? upper: lower),
+                           qGreen(i & 0x2? upper: lower),
+                           qBlue(i & 0x1? upper: lower)).hslHue();
+
+            if (h < 0)
+                return true;
+
+            minHue = qMin(minHue, h);
+            maxHue = qMax(maxHue, h);
+        }
+
+        return maxHue - minHue > 180;
+    });
 }
 
 #include "moc_changehslelement.cpp"
@@ -93,7 +93,7 @@ AkPacket CinemaElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
     int cy = src.height() >> 1;
 
     for (int y = 0; y < src.height(); y++) {
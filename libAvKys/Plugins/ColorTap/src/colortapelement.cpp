@@ -120,7 +120,7 @@ AkPacket ColorTapElement::iStream(const AkPacket &packet)
     }
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
     auto tableBits = reinterpret_cast<const QRgb *>(this->d->m_table.constBits());
 
     for (int y = 0; y < src.height(); y++) {
@@ -19,16 +19,26 @@
 
 #include <QVector>
 #include <QImage>
+#include <QMutex>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "colortransformelement.h"
 
+/* The kernel is applied in fixed point, with this many fractional bits. The
+ * sums are 64 bits wide, so any coefficient the user can type fits once it's
+ * bounded to COLORTRANSFORM_MAX, way beyond what saturates the output.
+ */
+#define COLORTRANSFORM_SHIFT 12
+#define COLORTRANSFORM_MAX 2147483648.0
+
 class ColorTransformElementPrivate
 {
     public:
         QVector<qreal> m_kernel;
+        QMutex m_mutex;
 };
 
 ColorTransformElement::ColorTransformElement(): AkElement()
@@ -51,9 +61,13 @@ QVariantList ColorTransformElement::kernel() const
 {
     QVariantList kernel;
 
+    this->d->m_mutex.lock();
+
     for (const qreal &e: this->d->m_kernel)
         kernel << e;
 
+    this->d->m_mutex.unlock();
+
     return kernel;
 }
 
@@ -80,10 +94,17 @@ void ColorTransformElement::setKernel(const QVariantList &kernel)
     for (const QVariant &e: kernel)
         k << e.toReal();
 
-    if (this->d->m_kernel == k)
+    this->d->m_mutex.lock();
+
+    if (this->d->m_kernel == k) {
+        this->d->m_mutex.unlock();
+
         return;
+    }
 
     this->d->m_kernel = k;
+    this->d->m_mutex.unlock();
+
     emit this->kernelChanged(kernel);
 }
 
@@ -100,7 +121,11 @@ void ColorTransformElement::resetKernel()
 
 AkPacket ColorTransformElement::iStream(const AkPacket &packet)
 {
-    if (this->d->m_kernel.size() < 12)
+    this->d->m_mutex.lock();
+    QVector<qreal> kernel = this->d->m_kernel;
+    this->d->m_mutex.unlock();
+
+    if (kernel.size() < 12)
         akSend(packet)
 
     QImage src = AkUtils::packetToImage(packet);
@@ -109,29 +134,37 @@ AkPacket ColorTransformElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
-    auto kernel = this->d->m_kernel;
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
-    for (int y = 0; y < src.height(); y++) {
-        auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    qint64 k[12];
+
+    for (int i = 0; i < 12; i++)
+        k[i] = qRound64(qBound(-COLORTRANSFORM_MAX,
+                               kernel[i],
+                               COLORTRANSFORM_MAX)
+                        * (1 << COLORTRANSFORM_SHIFT));
+
+    AkPixelKernel<>::forEachLine(src, oFrame, [&k, &src] (int y,
+                                                          const QRgb *srcLine,
+                                                          QRgb *dstLine) {
+        Q_UNUSED(y)
 
         for (int x = 0; x < src.width(); x++) {
-            int r = qRed(srcLine[x]);
-            int g = qGreen(srcLine[x]);
-            int b = qBlue(srcLine[x]);
+            qint64 r = qRed(srcLine[x]);
+            qint64 g = qGreen(srcLine[x]);
+            qint64 b = qBlue(srcLine[x]);
 
-            int rt = int(r * kernel[0] + g * kernel[1] + b * kernel[2]  + kernel[3]);
-            int gt = int(r * kernel[4] + g * kernel[5] + b * kernel[6]  + kernel[7]);
-            int bt = int(r * kernel[8] + g * kernel[9] + b * kernel[10] + kernel[11]);
+            qint64 rt = (r * k[0] + g * k[1] + b * k[2]  + k[3])  >> COLORTRANSFORM_SHIFT;
+            qint64 gt = (r * k[4] + g * k[5] + b * k[6]  + k[7])  >> COLORTRANSFORM_SHIFT;
+            qint64 bt = (r * k[8] + g * k[9] + b * k[10] + k[11]) >> COLORTRANSFORM_SHIFT;
 
-            rt = qBound(0, rt, 255);
-            gt = qBound(0, gt, 255);
-            bt = qBound(0, bt, 255);
+            rt = qBound<qint64>(0, rt, 255);
+            gt = qBound<qint64>(0, gt, 255);
+            bt = qBound<qint64>(0, bt, 255);
 
-            dstLine[x] = qRgba(rt, gt, bt, qAlpha(srcLine[x]));
+            dstLine[x] = qRgba(int(rt), int(gt), int(bt), qAlpha(srcLine[x]));
         }
-    }
+    }, true, "ColorTransform");
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
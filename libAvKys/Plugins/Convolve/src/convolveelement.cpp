@@ -22,12 +22,28 @@
 #include <QMutex>
 #include <QImage>
 #include <QQmlContext>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include <akutils.h>
 #include <akfrac.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "convolveelement.h"
 
+// A non zero kernel element, offsets are relative to the top-left tap.
+struct ConvolveTap
+{
+    int x;
+    int y;
+    int weight;
+};
+
 class ConvolveElementPrivate
 {
     public:
@@ -37,14 +53,77 @@ class ConvolveElementPrivate
         QMutex m_mutex;
         int m_bias;
 
+        // Derived from the kernel every time it changes.
+        QVector<ConvolveTap> m_taps;
+        QVector<ConvolveTap> m_rowTaps;
+        QVector<ConvolveTap> m_columnTaps;
+        bool m_separable;
+
         ConvolveElementPrivate():
             m_kernelSize(QSize(3, 3)),
             m_factor(AkFrac(1, 1)),
-            m_bias(0)
+            m_bias(0),
+            m_separable(false)
         {
         }
+
+        inline void updateTaps();
 };
 
+/* The channels are processed as 16 bits integers, 3 per pixel (R, G, B),
+ * with 32 bits accumulators. The alpha is copied from the source, so it's
+ * never convolved. Each tap multiplies a whole row at once, so the inner loops
+ * have no bounds checks nor branches.
+ */
+#define CONVOLVE_CHANNELS 3
+
+// acc[k] += weight * src[k], for k in [0, size).
+static inline void macRow(qint32 *acc, const qint16 *src, int weight, int size)
+{
+    int k = 0;
+
+    if (weight >= -32768 && weight <= 32767) {
+#if defined(__SSE2__)
+        const __m128i w = _mm_set1_epi16(qint16(weight));
+
+        for (; k + 8 <= size; k += 8) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k));
+            __m128i lo = _mm_mullo_epi16(values, w);
+            __m128i hi = _mm_mulhi_epi16(values, w);
+            auto acc0 = reinterpret_cast<__m128i *>(acc + k);
+            auto acc1 = reinterpret_cast<__m128i *>(acc + k + 4);
+
+            _mm_storeu_si128(acc0, _mm_add_epi32(_mm_loadu_si128(acc0),
+                                                 _mm_unpacklo_epi16(lo, hi)));
+            _mm_storeu_si128(acc1, _mm_add_epi32(_mm_loadu_si128(acc1),
+                                                 _mm_unpackhi_epi16(lo, hi)));
+        }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (; k + 8 <= size; k += 8) {
+            int16x8_t values = vld1q_s16(src + k);
+            vst1q_s32(acc + k,
+                      vmlal_n_s16(vld1q_s32(acc + k),
+                                  vget_low_s16(values),
+                                  qint16(weight)));
+            vst1q_s32(acc + k + 4,
+                      vmlal_n_s16(vld1q_s32(acc + k + 4),
+                                  vget_high_s16(values),
+                                  qint16(weight)));
+        }
+#endif
+    }
+
+    for (; k < size; k++)
+        acc[k] += weight * src[k];
+}
+
+// acc[k] += weight * src[k], for k in [0, size).
+static inline void macRow(qint32 *acc, const qint32 *src, int weight, int size)
+{
+    for (int k = 0; k < size; k++)
+        acc[k] += weight * src[k];
+}
+
 ConvolveElement::ConvolveElement(): AkElement()
 {
     this->d = new ConvolveElementPrivate;
@@ -54,6 +133,7 @@ ConvolveElement::ConvolveElement(): AkElement()
         0, 1, 0,
         0, 0, 0
     };
+    this->d->updateTaps();
 }
 
 ConvolveElement::~ConvolveElement()
@@ -112,8 +192,10 @@ void ConvolveElement::setKernel(const QVariantList &kernel)
     if (this->d->m_kernel == k)
         return;
 
-    QMutexLocker(&this->d->m_mutex);
+    this->d->m_mutex.lock();
     this->d->m_kernel = k;
+    this->d->updateTaps();
+    this->d->m_mutex.unlock();
     emit this->kernelChanged(kernel);
 }
 
@@ -122,8 +204,10 @@ void ConvolveElement::setKernelSize(const QSize &kernelSize)
     if (this->d->m_kernelSize == kernelSize)
         return;
 
-    QMutexLocker(&this->d->m_mutex);
+    this->d->m_mutex.lock();
     this->d->m_kernelSize = kernelSize;
+    this->d->updateTaps();
+    this->d->m_mutex.unlock();
     emit this->kernelSizeChanged(kernelSize);
 }
 
@@ -132,8 +216,9 @@ void ConvolveElement::setFactor(const AkFrac &factor)
     if (this->d->m_factor == factor)
         return;
 
-    QMutexLocker(&this->d->m_mutex);
+    this->d->m_mutex.lock();
     this->d->m_factor = factor;
+    this->d->m_mutex.unlock();
     emit this->factorChanged(factor);
 }
 
@@ -142,8 +227,9 @@ void ConvolveElement::setBias(int bias)
     if (this->d->m_bias == bias)
         return;
 
-    QMutexLocker(&this->d->m_mutex);
+    this->d->m_mutex.lock();
     this->d->m_bias = bias;
+    this->d->m_mutex.unlock();
     emit this->biasChanged(bias);
 }
 
@@ -181,67 +267,195 @@ AkPacket ConvolveElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
+    // Const, so the workers don't detach the shared copies while walking them.
     this->d->m_mutex.lock();
-    QVector<int> kernel = this->d->m_kernel;
-    const int *kernelBits = kernel.constData();
+    const auto taps = this->d->m_taps;
+    const auto rowTaps = this->d->m_rowTaps;
+    const auto columnTaps = this->d->m_columnTaps;
+    bool separable = this->d->m_separable;
     qint64 factorNum = this->d->m_factor.num();
     qint64 factorDen = this->d->m_factor.den();
-    int kernelWidth = this->d->m_kernelSize.width();
-    int kernelHeight = this->d->m_kernelSize.height();
+    int bias = this->d->m_bias;
+    int kernelWidth = qMax(1, this->d->m_kernelSize.width());
+    int kernelHeight = qMax(1, this->d->m_kernelSize.height());
     this->d->m_mutex.unlock();
 
+    int width = src.width();
+    int height = src.height();
     int minI = -(kernelWidth - 1) / 2;
-    int maxI = (kernelWidth + 1) / 2;
     int minJ = -(kernelHeight - 1) / 2;
-    int maxJ = (kernelHeight + 1) / 2;
-
-    for (int y = 0; y < src.height(); y++) {
-        auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int r = 0;
-            int g = 0;
-            int b = 0;
-
-            for (int j = minJ, k = 0; j < maxJ; j++) {
-                int yp = qBound(0, y + j, src.height() - 1);
-                auto iLine =
-                        reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-
-                for (int i = minI; i < maxI; i++, k++) {
-                    int xp = qBound(0, x + i, src.width() - 1);
-
-                    if (kernelBits[k]) {
-                        r += kernelBits[k] * qRed(iLine[xp]);
-                        g += kernelBits[k] * qGreen(iLine[xp]);
-                        b += kernelBits[k] * qBlue(iLine[xp]);
-                    }
-                }
+
+    // The input rows are padded by repeating the borders.
+    int paddedWidth = width + kernelWidth - 1;
+    int paddedLineSize = CONVOLVE_CHANNELS * paddedWidth;
+    int lineSize = CONVOLVE_CHANNELS * width;
+
+    // scanLine() detaches, so it can't be called from the workers.
+    auto oBits = oFrame.bits();
+    auto oLineSize = oFrame.bytesPerLine();
+
+    AkPixelKernel<>::forEachBand(height, [&] (int first, int last) {
+        int nLines = last - first + kernelHeight - 1;
+        QVector<qint16> padded(nLines * paddedLineSize);
+        QVector<qint32> acc(lineSize);
+
+        for (int line = 0; line < nLines; line++) {
+            int yp = qBound(0, first + minJ + line, height - 1);
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
+            auto paddedLine = padded.data() + line * paddedLineSize;
+
+            for (int x = 0; x < paddedWidth; x++) {
+                QRgb pixel = iLine[qBound(0, x + minI, width - 1)];
+                auto channels = paddedLine + CONVOLVE_CHANNELS * x;
+                channels[0] = qint16(qRed(pixel));
+                channels[1] = qint16(qGreen(pixel));
+                channels[2] = qint16(qBlue(pixel));
+            }
+        }
+
+        /* A separable kernel is applied as a horizontal pass over all the
+         * padded lines followed by a vertical pass, that is
+         * kernelWidth + kernelHeight taps per pixel instead of
+         * kernelWidth * kernelHeight.
+         */
+        QVector<qint32> rows;
+
+        if (separable) {
+            rows.resize(nLines * lineSize);
+
+            for (int line = 0; line < nLines; line++) {
+                auto row = rows.data() + line * lineSize;
+                auto paddedLine = padded.constData() + line * paddedLineSize;
+
+                for (auto &tap: rowTaps)
+                    macRow(row,
+                           paddedLine + CONVOLVE_CHANNELS * tap.x,
+                           tap.weight,
+                           lineSize);
             }
+        }
 
-            if (factorNum) {
-                r = int(factorNum * r / factorDen + this->d->m_bias);
-                g = int(factorNum * g / factorDen + this->d->m_bias);
-                b = int(factorNum * b / factorDen + this->d->m_bias);
+        for (int y = first; y < last; y++) {
+            auto line = y - first;
+            acc.fill(0);
 
-                r = qBound(0, r, 255);
-                g = qBound(0, g, 255);
-                b = qBound(0, b, 255);
+            if (separable) {
+                for (auto &tap: columnTaps)
+                    macRow(acc.data(),
+                           rows.constData() + (line + tap.y) * lineSize,
+                           tap.weight,
+                           lineSize);
             } else {
-                r = 255;
-                g = 255;
-                b = 255;
+                for (auto &tap: taps)
+                    macRow(acc.data(),
+                           padded.constData()
+                           + (line + tap.y) * paddedLineSize
+                           + CONVOLVE_CHANNELS * tap.x,
+                           tap.weight,
+                           lineSize);
             }
 
-            oLine[x] = qRgba(r, g, b, qAlpha(iLine[x]));
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto oLine = reinterpret_cast<QRgb *>(oBits + y * oLineSize);
+            auto channels = acc.constData();
+
+            for (int x = 0; x < width; x++, channels += CONVOLVE_CHANNELS) {
+                int r = 255;
+                int g = 255;
+                int b = 255;
+
+                if (factorNum) {
+                    r = qBound(0, int(factorNum * channels[0] / factorDen + bias), 255);
+                    g = qBound(0, int(factorNum * channels[1] / factorDen + bias), 255);
+                    b = qBound(0, int(factorNum * channels[2] / factorDen + bias), 255);
+                }
+
+                oLine[x] = qRgba(r, g, b, qAlpha(iLine[x]));
+            }
         }
-    }
+    }, true, "Convolve");
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
 
+void ConvolveElementPrivate::updateTaps()
+{
+    int kernelWidth = qMax(1, this->m_kernelSize.width());
+    int kernelHeight = qMax(1, this->m_kernelSize.height());
+    this->m_taps.clear();
+
+    for (int y = 0, k = 0; y < kernelHeight; y++)
+        for (int x = 0; x < kernelWidth; x++, k++) {
+            int weight = this->m_kernel.value(k);
+
+            if (weight)
+                this->m_taps << ConvolveTap {x, y, weight};
+        }
+
+    /* Try to write the kernel as the product of a column and a row vector.
+     * The row is the first non zero line divided by the GCD of its elements,
+     * then every line must be an integer multiple of it.
+     */
+    this->m_rowTaps.clear();
+    this->m_columnTaps.clear();
+    this->m_separable = false;
+
+    if (this->m_taps.isEmpty())
+        return;
+
+    auto kernelAt = [this, kernelWidth] (int x, int y) -> int {
+        return this->m_kernel.value(y * kernelWidth + x);
+    };
+
+    int firstLine = this->m_taps.first().y;
+    int gcd = 0;
+
+    for (int x = 0; x < kernelWidth; x++) {
+        int a = qAbs(kernelAt(x, firstLine));
+
+        for (int b = gcd; b;) {
+            int t = a % b;
+            a = b;
+            b = t;
+        }
+
+        gcd = a;
+    }
+
+    QVector<int> row(kernelWidth);
+    int pivot = -1;
+
+    for (int x = 0; x < kernelWidth; x++) {
+        row[x] = kernelAt(x, firstLine) / gcd;
+
+        if (pivot < 0 && row[x])
+            pivot = x;
+    }
+
+    QVector<int> column(kernelHeight);
+
+    for (int y = 0; y < kernelHeight; y++) {
+        column[y] = kernelAt(pivot, y) / row[pivot];
+
+        for (int x = 0; x < kernelWidth; x++)
+            if (kernelAt(x, y) != column[y] * row[x])
+                return;
+    }
+
+    for (int x = 0; x < kernelWidth; x++)
+        if (row[x])
+            this->m_rowTaps << ConvolveTap {x, 0, row[x]};
+
+    for (int y = 0; y < kernelHeight; y++)
+        if (column[y])
+            this->m_columnTaps << ConvolveTap {0, y, column[y]};
+
+    // Only worth it if it takes less taps.
+    this->m_separable = this->m_rowTaps.size() + this->m_columnTaps.size()
+                        < this->m_taps.size();
+}
+
 #include "moc_convolveelement.cpp"
@@ -36,7 +36,6 @@ CONFIG += plugin
 HEADERS = \
     src/denoise.h \
     src/denoiseelement.h \
-    src/pixel.h \
     src/params.h
 
 INCLUDEPATH += \
@@ -46,7 +45,7 @@ LIBS += -L$${PWD}/../../Lib/ -l$${COMMONS_TARGET}
 
 OTHER_FILES += pspec.json
 
-QT += qml concurrent
+QT += qml
 
 RESOURCES += \
     Denoise.qrc
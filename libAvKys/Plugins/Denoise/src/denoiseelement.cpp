@@ -19,14 +19,20 @@
 
 #include <QImage>
 #include <QQmlContext>
-#include <QtConcurrent>
+#include <QVector>
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
+#include <akworkerpool.h>
 
 #include "denoiseelement.h"
 #include "params.h"
 
+// Side of the square tiles the frame is split into. A tile and its search
+// window fit in the L2 cache for the usual radius values.
+#define TILE_SIZE 64
+
 class DenoiseElementPrivate
 {
     public:
@@ -35,22 +41,29 @@ class DenoiseElementPrivate
         int m_mu;
         qreal m_sigma;
         int *m_weight;
+        int m_tableFactor;
+
+        // Reused from frame to frame while the frame size doesn't change.
+        QVector<AkPixelU8> m_planes;
+        QVector<AkPixelU32> m_integral;
+        QVector<AkPixelU64> m_integral2;
 
         DenoiseElementPrivate():
             m_radius(1),
             m_factor(1024),
             m_mu(0),
             m_sigma(1.0),
-            m_weight(nullptr)
+            m_weight(nullptr),
+            m_tableFactor(0)
         {
         }
 
         inline void makeTable(int factor);
         inline void integralImage(const QImage &image,
                                   int oWidth, int oHeight,
-                                  PixelU8 *planes,
-                                  PixelU32 *integral,
-                                  PixelU64 *integral2);
+                                  AkPixelU8 *planes,
+                                  AkPixelU32 *integral,
+                                  AkPixelU64 *integral2);
         inline static void denoise(const DenoiseStaticParams &staticParams,
                                    const DenoiseParams *params);
 };
@@ -61,6 +74,7 @@ DenoiseElement::DenoiseElement(): AkElement()
 
     this->d->m_weight = new int[1 << 24];
     this->d->makeTable(this->d->m_factor);
+    this->d->m_tableFactor = this->d->m_factor;
 }
 
 DenoiseElement::~DenoiseElement()
@@ -91,25 +105,25 @@ qreal DenoiseElement::sigma() const
 
 void DenoiseElementPrivate::integralImage(const QImage &image,
                                           int oWidth, int oHeight,
-                                          PixelU8 *planes,
-                                          PixelU32 *integral,
-                                          PixelU64 *integral2)
+                                          AkPixelU8 *planes,
+                                          AkPixelU32 *integral,
+                                          AkPixelU64 *integral2)
 {
     for (int y = 1; y < oHeight; y++) {
         auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y - 1));
-        PixelU8 *planesLine = planes
-                              + (y - 1) * image.width();
+        AkPixelU8 *planesLine = planes
+                                + (y - 1) * image.width();
 
         // Reset current line summation.
-        PixelU32 sum;
-        PixelU64 sum2;
+        AkPixelU32 sum;
+        AkPixelU64 sum2;
 
         for (int x = 1; x < oWidth; x++) {
             QRgb pixel = line[x - 1];
 
             // Accumulate pixels in current line.
             sum += pixel;
-            sum2 += pow2(pixel);
+            sum2 += akPixelPow2(pixel);
 
             // Offset to the current line.
             int offset = x + y * oWidth;
@@ -130,33 +144,37 @@ void DenoiseElementPrivate::integralImage(const QImage &image,
 void DenoiseElementPrivate::denoise(const DenoiseStaticParams &staticParams,
                                     const DenoiseParams *params)
 {
-    PixelU32 sum = integralSum(staticParams.integral, staticParams.oWidth,
-                               params->xp, params->yp, params->kw, params->kh);
-    PixelU64 sum2 = integralSum(staticParams.integral2, staticParams.oWidth,
-                                params->xp, params->yp, params->kw, params->kh);
+    AkPixelU32 sum = akPixelIntegralSum(staticParams.integral,
+                                        staticParams.oWidth,
+                                        params->xp, params->yp,
+                                        params->kw, params->kh);
+    AkPixelU64 sum2 = akPixelIntegralSum(staticParams.integral2,
+                                         staticParams.oWidth,
+                                         params->xp, params->yp,
+                                         params->kw, params->kh);
     quint32 ks = quint32(params->kw * params->kh);
 
-    PixelU32 mean = sum / ks;
-    PixelU32 dev = sqrt(ks * sum2 - pow2(sum)) / ks;
+    AkPixelU32 mean = sum / ks;
+    AkPixelU32 dev = akPixelSqrt(ks * sum2 - akPixelPow2(AkPixelU64(sum))) / ks;
 
-    mean = bound(0u, mean + staticParams.mu, 255u);
-    dev = bound(0., mult(staticParams.sigma, dev), 127.);
+    mean = akPixelBound(0u, mean + staticParams.mu, 255u);
+    dev = akPixelBound(0., akPixelMult(staticParams.sigma, dev), 127.);
 
-    PixelU32 mdMask = (mean << 16) | (dev << 8);
+    AkPixelU32 mdMask = (mean << 16) | (dev << 8);
 
-    PixelI32 pixel;
-    PixelI32 sumW;
+    AkPixelI32 pixel;
+    AkPixelI32 sumW;
 
     for (int j = 0; j < params->kh; j++) {
-        const PixelU8 *line = staticParams.planes
-                              + (params->yp + j) * staticParams.width;
+        const AkPixelU8 *line = staticParams.planes
+                                + (params->yp + j) * staticParams.width;
 
         for (int i = 0; i < params->kw; i++) {
-            PixelU8 pix = line[params->xp + i];
-            PixelU32 mask = mdMask | pix;
-            PixelI32 weight(staticParams.weights[mask.r],
-                            staticParams.weights[mask.g],
-                            staticParams.weights[mask.b]);
+            AkPixelU8 pix = line[params->xp + i];
+            AkPixelU32 mask = mdMask | pix;
+            AkPixelI32 weight(staticParams.weights[mask.r],
+                              staticParams.weights[mask.g],
+                              staticParams.weights[mask.b]);
             pixel += weight * pix;
             sumW += weight;
         }
@@ -178,7 +196,6 @@ void DenoiseElementPrivate::denoise(const DenoiseStaticParams &staticParams,
         pixel.b /= sumW.b;
 
     *params->oPixel = qRgba(pixel.r, pixel.g, pixel.b, params->alpha);
-    delete params;
 }
 
 void DenoiseElementPrivate::makeTable(int factor)
@@ -288,73 +305,88 @@ AkPacket DenoiseElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
 
-    static int factor = 1024;
-
-    if (this->d->m_factor != factor) {
-        this->d->makeTable(factor);
-        factor = this->d->m_factor;
+    if (this->d->m_tableFactor != this->d->m_factor) {
+        this->d->makeTable(this->d->m_factor);
+        this->d->m_tableFactor = this->d->m_factor;
     }
 
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+
+    int width = src.width();
+    int height = src.height();
+    int oWidth = width + 1;
+    int oHeight = height + 1;
+    int integralSize = oWidth * oHeight;
+
+    /* The first row and column of the integral images are never written,
+     * they stay zeroed since the allocation.
+     */
+    if (this->d->m_integral.size() != integralSize) {
+        this->d->m_planes.resize(0);
+        this->d->m_integral.resize(0);
+        this->d->m_integral2.resize(0);
+        this->d->m_planes.resize(integralSize);
+        this->d->m_integral.resize(integralSize);
+        this->d->m_integral2.resize(integralSize);
+    }
 
-    int oWidth = src.width() + 1;
-    int oHeight = src.height() + 1;
-    PixelU8 *planes = new PixelU8[oWidth * oHeight];
-    PixelU32 *integral = new PixelU32[oWidth * oHeight];
-    PixelU64 *integral2 = new PixelU64[oWidth * oHeight];
+    AkPixelU8 *planes = this->d->m_planes.data();
     this->d->integralImage(src,
                            oWidth, oHeight,
-                           planes, integral, integral2);
+                           planes,
+                           this->d->m_integral.data(),
+                           this->d->m_integral2.data());
 
     DenoiseStaticParams staticParams;
     staticParams.planes = planes;
-    staticParams.integral = integral;
-    staticParams.integral2 = integral2;
-    staticParams.width = src.width();
+    staticParams.integral = this->d->m_integral.constData();
+    staticParams.integral2 = this->d->m_integral2.constData();
+    staticParams.width = width;
     staticParams.oWidth = oWidth;
     staticParams.weights = this->d->m_weight;
     staticParams.mu = this->d->m_mu;
     staticParams.sigma = this->d->m_sigma < 0.1? 0.1: this->d->m_sigma;
 
-    QThreadPool threadPool;
-
-    if (threadPool.maxThreadCount() < 8)
-        threadPool.setMaxThreadCount(8);
-
-    for (int y = 0, pos = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        int yp = qMax(y - radius, 0);
-        int kh = qMin(y + radius, src.height() - 1) - yp + 1;
-
-        for (int x = 0; x < src.width(); x++, pos++) {
-            int xp = qMax(x - radius, 0);
-            int kw = qMin(x + radius, src.width() - 1) - xp + 1;
-
-            auto params = new DenoiseParams();
-            params->xp = xp;
-            params->yp = yp;
-            params->kw = kw;
-            params->kh = kh;
-            params->iPixel = planes[pos];
-            params->oPixel = oLine + x;
-            params->alpha = qAlpha(iLine[x]);
-
-            if (radius >= 20)
-                QtConcurrent::run(&threadPool,
-                                  DenoiseElementPrivate::denoise,
-                                  staticParams,
-                                  params);
-            else
-                this->d->denoise(staticParams, params);
+    int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    // scanLine() detaches, so it can't be called from the workers.
+    auto oBits = oFrame.bits();
+    auto oLineSize = oFrame.bytesPerLine();
+
+    AkWorkerPool::globalInstance()->parallelFor(tilesX * tilesY,
+                                                1,
+                                                [&] (int first, int last) {
+        for (int tile = first; tile < last; tile++) {
+            int x0 = TILE_SIZE * (tile % tilesX);
+            int y0 = TILE_SIZE * (tile / tilesX);
+            int x1 = qMin(x0 + TILE_SIZE, width);
+            int y1 = qMin(y0 + TILE_SIZE, height);
+
+            for (int y = y0; y < y1; y++) {
+                auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+                auto oLine = reinterpret_cast<QRgb *>(oBits + y * oLineSize);
+                int yp = qMax(y - radius, 0);
+                int kh = qMin(y + radius, height - 1) - yp + 1;
+                DenoiseParams params;
+
+                for (int x = x0, pos = y * width + x0; x < x1; x++, pos++) {
+                    int xp = qMax(x - radius, 0);
+                    int kw = qMin(x + radius, width - 1) - xp + 1;
+
+                    params.xp = xp;
+                    params.yp = yp;
+                    params.kw = kw;
+                    params.kh = kh;
+                    params.iPixel = planes[pos];
+                    params.oPixel = oLine + x;
+                    params.alpha = qAlpha(iLine[x]);
+
+                    DenoiseElementPrivate::denoise(staticParams, &params);
+                }
+            }
         }
-    }
-
-    threadPool.waitForDone();
-
-    delete [] planes;
-    delete [] integral;
-    delete [] integral2;
+    }, "Denoise");
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
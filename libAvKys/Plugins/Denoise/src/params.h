@@ -20,7 +20,7 @@
 #ifndef PARAMS_H
 #define PARAMS_H
 
-#include "pixel.h"
+#include <akpixel.h>
 
 struct DenoiseParams
 {
@@ -28,16 +28,16 @@ struct DenoiseParams
     int yp;
     int kw;
     int kh;
-    PixelU8 iPixel;
+    AkPixelU8 iPixel;
     QRgb *oPixel;
     int alpha;
 };
 
 struct DenoiseStaticParams
 {
-    const PixelU8 *planes;
-    const PixelU32 *integral;
-    const PixelU64 *integral2;
+    const AkPixelU8 *planes;
+    const AkPixelU32 *integral;
+    const AkPixelU64 *integral2;
 
     int width;
     int oWidth;
@@ -178,7 +178,7 @@ AkPacket DistortElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame = QImage(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     const QRgb *srcBits = reinterpret_cast<const QRgb *>(src.constBits());
     QRgb *destBits = reinterpret_cast<QRgb *>(oFrame.bits());
@@ -93,7 +93,7 @@ AkPacket EmbossElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_Grayscale8);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     for (int y = 0; y < src.height(); y++) {
         int y_m1 = y - 1;
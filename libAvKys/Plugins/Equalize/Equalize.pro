@@ -30,8 +30,7 @@ CONFIG += plugin
 
 HEADERS = \
     src/equalize.h \
-    src/equalizeelement.h \
-    src/pixelstructs.h
+    src/equalizeelement.h
 
 INCLUDEPATH += \
     ../../Lib/src
@@ -21,9 +21,9 @@
 #include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "equalizeelement.h"
-#include "pixelstructs.h"
 
 EqualizeElement::EqualizeElement(): AkElement()
 {
@@ -32,13 +32,11 @@ EqualizeElement::EqualizeElement(): AkElement()
 QVector<quint64> EqualizeElement::histogram(const QImage &img) const
 {
     QVector<quint64> histogram(256, 0);
+    quint64 *bins = histogram.data();
 
-    for (int y = 0; y < img.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(img.constScanLine(y));
-
-        for (int x = 0; x < img.width(); x++)
-            histogram[qGray(srcLine[x])]++;
-    }
+    AkPixelKernel<>::forEachPixel(img, [bins] (QRgb pixel) {
+        bins[qGray(pixel)]++;
+    });
 
     return histogram;
 }
@@ -82,22 +80,13 @@ AkPacket EqualizeElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
     QVector<quint8> equTable = this->equalizationTable(src);
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++){
-            int r = equTable[qRed(srcLine[x])];
-            int g = equTable[qGreen(srcLine[x])];
-            int b = equTable[qBlue(srcLine[x])];
-            int a = equTable[qAlpha(srcLine[x])];
-
-            dstLine[x] = qRgba(r, g, b, a);
-        }
-    }
+    const quint8 *table = equTable.constData();
+    AkPixelKernel<>::lookup(src, oFrame,
+                            table, table, table, table,
+                            true, "Equalize");
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -49,7 +49,7 @@ LIBS += -L$${PWD}/../../Lib/ -l$${COMMONS_TARGET}
 
 OTHER_FILES += pspec.json
 
-QT += qml widgets concurrent
+QT += qml widgets
 
 RESOURCES += \
     FaceDetect.qrc \
@@ -58,7 +58,7 @@
  */
 
 #include <QtMath>
-#include <QtConcurrent>
+#include <akworkerpool.h>
 
 #include "haarcascade.h"
 #include "haardetector.h"
@@ -1129,13 +1129,10 @@ QVector<QRect> HaarDetector::detect(const QImage &image, qreal scaleFactor,
     const quint32 *icp[4];
 
     QList<QRect> roi;
-    QThreadPool threadPool;
+    QVector<HaarCascadeHID *> cascades;
     QMutex mutex;
     static const int border = 1;
 
-    if (threadPool.maxThreadCount() < 8)
-        threadPool.setMaxThreadCount(8);
-
     this->d->m_mutex.lock();
 
     for (qreal scale = 1; ; scale *= scaleFactor) {
@@ -1225,10 +1222,17 @@ QVector<QRect> HaarDetector::detect(const QImage &image, qreal scaleFactor,
                                                      &roi,
                                                      &mutex);
 
-        QtConcurrent::run(&threadPool, HaarCascadeHID::run, cascade);
+        cascades << cascade;
     }
 
-    threadPool.waitForDone();
+    AkWorkerPool::globalInstance()->parallelFor(cascades.size(),
+                                                1,
+                                                [&cascades] (int first,
+                                                             int last) {
+        for (int i = first; i < last; i++)
+            HaarCascadeHID::run(cascades[i]);
+    }, "FaceDetect");
+
     this->d->m_mutex.unlock();
 
     return this->d->groupRectangles(roi.toVector(), this->d->m_minNeighbors);
@@ -467,7 +467,7 @@ AkPacket FireElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (src.size() != this->d->m_framSize) {
         this->d->m_fireBuffer = QImage();
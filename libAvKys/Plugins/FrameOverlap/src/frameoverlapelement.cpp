@@ -19,24 +19,62 @@
 
 #include <QImage>
 #include <QQmlContext>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "frameoverlapelement.h"
 
+/* A phase holding up to this many frames can keep its sums in 16 bits per
+ * channel.
+ */
+#define MAX_FRAMES_U16 257
+
 class FrameOverlapElementPrivate
 {
     public:
         int m_nFrames;
         int m_stride;
+
+        /* Ring buffer with the last nFrames frames, and the running sum of
+         * the frames of each stride phase. The output of a frame is the
+         * average of its phase, so adding the new frame and subtracting the
+         * evicted one is all the work needed, whatever nFrames is.
+         *
+         * Two frames of the ring are at most nFrames - 1 frames apart, so
+         * with a stride of nFrames or more every phase holds a single frame
+         * and the output is the frame itself. Then there are no sums, and the
+         * ring only keeps the history in case the parameters change.
+         */
         QVector<QImage> m_frames;
+        QVector<QVector<AkPixelU16>> m_sums16;
+        QVector<QVector<AkPixelU32>> m_sums32;
+        QVector<int> m_counts;
+        qint64 m_frameCount;
         QSize m_frameSize;
+        int m_ringFrames;
+        int m_ringStride;
+        int m_ringPhases;
 
         FrameOverlapElementPrivate():
             m_nFrames(16),
-            m_stride(4)
+            m_stride(4),
+            m_frameCount(0),
+            m_ringFrames(0),
+            m_ringStride(0),
+            m_ringPhases(0)
         {
         }
+
+        inline void reset(const QSize &frameSize, int nFrames, int stride);
+        inline void push(const QImage &frame);
+        template<typename T>
+        inline void pushSums(QVector<QVector<AkPixel<T>>> &sums,
+                             const QImage &frame);
+        template<typename T>
+        inline void mean(const QVector<QVector<AkPixel<T>>> &sums,
+                         QImage &oFrame) const;
 };
 
 FrameOverlapElement::FrameOverlapElement(): AkElement()
@@ -77,6 +115,8 @@ void FrameOverlapElement::controlInterfaceConfigure(QQmlContext *context,
 
 void FrameOverlapElement::setNFrames(int nFrames)
 {
+    nFrames = qMax(nFrames, 0);
+
     if (this->d->m_nFrames == nFrames)
         return;
 
@@ -86,6 +126,8 @@ void FrameOverlapElement::setNFrames(int nFrames)
 
 void FrameOverlapElement::setStride(int stride)
 {
+    stride = qMax(stride, 0);
+
     if (this->d->m_stride == stride)
         return;
 
@@ -111,58 +153,158 @@ AkPacket FrameOverlapElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    int nFrames = this->d->m_nFrames;
 
-    if (src.size() != this->d->m_frameSize) {
-        this->d->m_frames.clear();
-        this->d->m_frameSize = src.size();
+    if (nFrames < 1) {
+        QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+        oFrame.fill(qRgba(0, 0, 0, 0));
+        AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+        akSend(oPacket)
     }
 
-    this->d->m_frames << src.copy();
-    int diff = this->d->m_frames.size() - this->d->m_nFrames;
+    int stride = this->d->m_stride > 0? this->d->m_stride: 1;
 
-    for (int i = 0; i < diff; i++)
-        this->d->m_frames.removeFirst();
+    if (src.size() != this->d->m_frameSize
+        || nFrames != this->d->m_ringFrames
+        || stride != this->d->m_ringStride)
+        this->d->reset(src.size(), nFrames, stride);
 
-    int stride = this->d->m_stride > 0? this->d->m_stride: 1;
+    this->d->push(src);
 
-    for (int y = 0; y < oFrame.height(); y++) {
-        QRgb *dstBits = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < oFrame.width(); x++) {
-            int r = 0;
-            int g = 0;
-            int b = 0;
-            int a = 0;
-            int n = 0;
-
-            for (int frame = this->d->m_frames.size() - 1;
-                 frame >= 0;
-                 frame -= stride) {
-                QRgb pixel = this->d->m_frames[frame].pixel(x, y);
-
-                r += qRed(pixel);
-                g += qGreen(pixel);
-                b += qBlue(pixel);
-                a += qAlpha(pixel);
-                n++;
-            }
-
-            if (n > 0) {
-                r /= n;
-                g /= n;
-                b /= n;
-                a /= n;
-
-                dstBits[x] = qRgba(r, g, b, a);
-            } else {
-                dstBits[x] = qRgba(0, 0, 0, 0);
-            }
-        }
+    if (this->d->m_ringPhases < 1) {
+        AkPacket oPacket = AkUtils::imageToPacket(src, packet);
+        akSend(oPacket)
     }
 
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+
+    if (this->d->m_sums16.isEmpty())
+        this->d->mean(this->d->m_sums32, oFrame);
+    else
+        this->d->mean(this->d->m_sums16, oFrame);
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
 
+void FrameOverlapElementPrivate::reset(const QSize &frameSize,
+                                       int nFrames,
+                                       int stride)
+{
+    // Keep the history when only the parameters changed.
+    QVector<QImage> history;
+
+    if (frameSize == this->m_frameSize && this->m_ringFrames > 0) {
+        qint64 first = qMax(this->m_frameCount - this->m_ringFrames,
+                            this->m_frameCount - nFrames);
+
+        for (qint64 i = qMax(first, qint64(0)); i < this->m_frameCount; i++)
+            history << this->m_frames[int(i % this->m_ringFrames)];
+    }
+
+    int phases = stride < nFrames? stride: 0;
+    int pixels = frameSize.width() * frameSize.height();
+    this->m_frames = QVector<QImage>(nFrames);
+    this->m_sums16.clear();
+    this->m_sums32.clear();
+
+    if (phases > 0) {
+        // The busiest phase holds one frame every stride frames.
+        if ((nFrames + stride - 1) / stride <= MAX_FRAMES_U16)
+            this->m_sums16 =
+                    QVector<QVector<AkPixelU16>>(phases,
+                                                 QVector<AkPixelU16>(pixels));
+        else
+            this->m_sums32 =
+                    QVector<QVector<AkPixelU32>>(phases,
+                                                 QVector<AkPixelU32>(pixels));
+    }
+
+    this->m_counts = QVector<int>(phases, 0);
+    this->m_frameCount = 0;
+    this->m_frameSize = frameSize;
+    this->m_ringFrames = nFrames;
+    this->m_ringStride = stride;
+    this->m_ringPhases = phases;
+
+    for (auto &frame: history)
+        this->push(frame);
+}
+
+void FrameOverlapElementPrivate::push(const QImage &frame)
+{
+    if (this->m_ringPhases < 1) {
+        // No sums to update, a shallow copy is enough.
+        this->m_frames[int(this->m_frameCount % this->m_ringFrames)] = frame;
+        this->m_frameCount++;
+    } else if (this->m_sums16.isEmpty()) {
+        this->pushSums(this->m_sums32, frame);
+    } else {
+        this->pushSums(this->m_sums16, frame);
+    }
+}
+
+template<typename T>
+void FrameOverlapElementPrivate::pushSums(QVector<QVector<AkPixel<T>>> &sums,
+                                          const QImage &frame)
+{
+    int slot = int(this->m_frameCount % this->m_ringFrames);
+    int phase = int(this->m_frameCount % this->m_ringPhases);
+    QImage &ringFrame = this->m_frames[slot];
+    AkPixel<T> *phaseSums = sums[phase].data();
+    AkPixel<T> *evictedSums = nullptr;
+
+    if (this->m_frameCount < this->m_ringFrames) {
+        ringFrame = QImage(frame.size(), frame.format());
+    } else {
+        int evictedPhase =
+                int((this->m_frameCount - this->m_ringFrames) % this->m_ringPhases);
+        evictedSums = sums[evictedPhase].data();
+        this->m_counts[evictedPhase]--;
+    }
+
+    int width = frame.width();
+
+    // Subtract the evicted frame and add the new one in a single pass.
+    AkPixelKernel<>::forEachLine(frame, ringFrame, [=] (int y,
+                                                         const QRgb *iLine,
+                                                         QRgb *ringLine) {
+        AkPixel<T> *sumsLine = phaseSums + y * width;
+
+        if (evictedSums) {
+            AkPixel<T> *evictedLine = evictedSums + y * width;
+
+            for (int x = 0; x < width; x++)
+                evictedLine[x] -= ringLine[x];
+        }
+
+        for (int x = 0; x < width; x++) {
+            sumsLine[x] += iLine[x];
+            ringLine[x] = iLine[x];
+        }
+    }, true, "FrameOverlap");
+
+    this->m_counts[phase]++;
+    this->m_frameCount++;
+}
+
+template<typename T>
+void FrameOverlapElementPrivate::mean(const QVector<QVector<AkPixel<T>>> &sums,
+                                      QImage &oFrame) const
+{
+    int phase = int((this->m_frameCount - 1) % this->m_ringPhases);
+    const AkPixel<T> *phaseSums = sums[phase].constData();
+    quint32 n = quint32(this->m_counts[phase]);
+    int width = oFrame.width();
+
+    AkPixelKernel<>::forEachLine(oFrame, [=] (int y, QRgb *oLine) {
+        const AkPixel<T> *sumsLine = phaseSums + y * width;
+
+        for (int x = 0; x < width; x++) {
+            AkPixelU32 mean = sumsLine[x] / n;
+            oLine[x] = qRgba(int(mean.r), int(mean.g), int(mean.b), int(mean.a));
+        }
+    }, true, "FrameOverlap");
+}
+
 #include "moc_frameoverlapelement.cpp"
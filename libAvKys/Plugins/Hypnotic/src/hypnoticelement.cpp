@@ -241,7 +241,7 @@ AkPacket HypnoticElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (src.size() != this->d->m_frameSize) {
         this->d->m_speed = 16;
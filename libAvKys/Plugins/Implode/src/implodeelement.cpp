@@ -28,6 +28,7 @@
 ImplodeElement::ImplodeElement(): AkElement()
 {
     this->m_amount = 1.0;
+    this->m_remapAmount = 0.0;
 }
 
 qreal ImplodeElement::amount() const
@@ -73,38 +74,51 @@ AkPacket ImplodeElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
-
-    int xc = src.width() >> 1;
-    int yc = src.height() >> 1;
-    int radius = qMin(xc, yc);
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        int yDiff = y - yc;
-
-        for (int x = 0; x < src.width(); x++) {
-            int xDiff = x - xc;
-            qreal distance = sqrt(xDiff * xDiff + yDiff * yDiff);
-
-            if (distance >= radius)
-                oLine[x] = iLine[x];
-            else {
-                qreal factor = pow(distance / radius, this->m_amount);
-
-                int xp = int(factor * xDiff + xc);
-                int yp = int(factor * yDiff + yc);
-
-                xp = qBound(0, xp, oFrame.width() - 1);
-                yp = qBound(0, yp, oFrame.height() - 1);
-
-                const QRgb *line = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-                oLine[x] = line[xp];
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+
+    qreal amount = this->m_amount;
+
+    // The mapping only depends on the frame size and the amount.
+    if (!this->m_remap.fits(src)
+        || this->m_remapAmount != amount) {
+        int xc = src.width() >> 1;
+        int yc = src.height() >> 1;
+        int radius = qMin(xc, yc);
+        int height = src.height();
+
+        this->m_remap.build(src.size(),
+                            AkRemap::stride(src),
+                            [=] (int y,
+                                 int width,
+                                 int stride,
+                                 qint32 *offsets) {
+            int yDiff = y - yc;
+
+            for (int x = 0; x < width; x++) {
+                int xDiff = x - xc;
+                qreal distance = sqrt(xDiff * xDiff + yDiff * yDiff);
+
+                if (distance >= radius) {
+                    offsets[x] = AkRemap::offset(x, y, stride);
+                } else {
+                    qreal factor = pow(distance / radius, amount);
+
+                    int xp = int(factor * xDiff + xc);
+                    int yp = int(factor * yDiff + yc);
+
+                    xp = qBound(0, xp, width - 1);
+                    yp = qBound(0, yp, height - 1);
+
+                    offsets[x] = AkRemap::offset(xp, yp, stride);
+                }
             }
-        }
+        }, true, "Implode");
+
+        this->m_remapAmount = amount;
     }
 
+    this->m_remap.apply(src, oFrame, true, "Implode");
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
@@ -24,6 +24,7 @@
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akremap.h>
 
 #include "matrixtransformelement.h"
 
@@ -31,7 +32,9 @@ class MatrixTransformElementPrivate
 {
     public:
         QVector<qreal> m_kernel;
+        QVector<qreal> m_remapKernel;
         QMutex m_mutex;
+        AkRemap m_remap;
 };
 
 MatrixTransformElement::MatrixTransformElement(): AkElement()
@@ -107,36 +110,44 @@ AkPacket MatrixTransformElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame = QImage(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     this->d->m_mutex.lock();
     QVector<qreal> kernel = this->d->m_kernel;
     this->d->m_mutex.unlock();
 
-    qreal det = kernel[0] * kernel[4] - kernel[1] * kernel[3];
-
-    QRect rect(0, 0, src.width(), src.height());
-    int cx = src.width() >> 1;
-    int cy = src.height() >> 1;
-
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int dx = int(x - cx - kernel[2]);
-            int dy = int(y - cy - kernel[5]);
-
-            int xp = int(cx + (dx * kernel[4] - dy * kernel[3]) / det);
-            int yp = int(cy + (dy * kernel[0] - dx * kernel[1]) / det);
-
-            if (rect.contains(xp, yp)) {
-                const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-                oLine[x] = iLine[xp];
-            } else
-                oLine[x] = qRgba(0, 0, 0, 0);
-        }
+    // The mapping only depends on the frame size and the kernel.
+    if (!this->d->m_remap.fits(src)
+        || this->d->m_remapKernel != kernel) {
+        qreal det = kernel[0] * kernel[4] - kernel[1] * kernel[3];
+
+        QRect rect(0, 0, src.width(), src.height());
+        int cx = src.width() >> 1;
+        int cy = src.height() >> 1;
+
+        this->d->m_remap.build(src.size(),
+                               AkRemap::stride(src),
+                               [=] (int y,
+                                    int width,
+                                    int stride,
+                                    qint32 *offsets) {
+            for (int x = 0; x < width; x++) {
+                int dx = int(x - cx - kernel[2]);
+                int dy = int(y - cy - kernel[5]);
+
+                int xp = int(cx + (dx * kernel[4] - dy * kernel[3]) / det);
+                int yp = int(cy + (dy * kernel[0] - dx * kernel[1]) / det);
+
+                offsets[x] = rect.contains(xp, yp)?
+                                 AkRemap::offset(xp, yp, stride): -1;
+            }
+        }, true, "MatrixTransform");
+
+        this->d->m_remapKernel = kernel;
     }
 
+    this->d->m_remap.apply(src, oFrame, true, "MatrixTransform");
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
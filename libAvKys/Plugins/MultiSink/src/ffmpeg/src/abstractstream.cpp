@@ -25,6 +25,7 @@
 #include <QFuture>
 #include <QWaitCondition>
 #include <akpacket.h>
+#include <aktrace.h>
 
 extern "C"
 {
@@ -277,8 +278,10 @@ void AbstractStreamPrivate::convertLoop()
 
         this->m_convertMutex.unlock();
 
-        if (packet)
+        if (packet) {
+            AkTraceScope traceScope("convertPacket", "encoder", packet);
             self->convertPacket(packet);
+        }
     }
 }
 
@@ -286,6 +289,7 @@ void AbstractStreamPrivate::encodeLoop()
 {
     while (this->m_runEncodeLoop) {
         if (auto frame = self->dequeueFrame()) {
+            AkTraceScope traceScope("encodeData", "encoder", -1, frame->pts);
             self->encodeData(frame);
             self->deleteFrame(&frame);
         }
@@ -32,6 +32,7 @@
 extern "C"
 {
     #include <libavutil/imgutils.h>
+    #include <libavutil/pixdesc.h>
     #include <libswscale/swscale.h>
 }
 
@@ -268,17 +269,35 @@ void VideoStream::convertPacket(const AkPacket &packet)
                             nullptr) < 0)
         return;
 
-    if (av_image_fill_linesizes(iFrame.linesize,
-                                iFormat,
-                                iWidth) < 0)
-        return;
+    // Read the frame planes in place, as described by the caps.
+    auto iCaps = videoPacket.caps();
+    auto iBuffer = videoPacket.buffer();
 
-    if (av_image_fill_pointers(reinterpret_cast<uint8_t **>(iFrame.data),
-                               iFormat,
-                               iHeight,
-                               reinterpret_cast<uint8_t *>(videoPacket.buffer().data()),
-                               iFrame.linesize) < 0) {
-        return;
+    auto iData = reinterpret_cast<uint8_t *>(const_cast<char *>(iBuffer.constData()));
+
+    if (av_pix_fmt_count_planes(iFormat) == iCaps.planes()) {
+        if (iBuffer.size() < iCaps.pictureSize())
+            return;
+
+        for (int plane = 0; plane < iCaps.planes(); plane++) {
+            iFrame.linesize[plane] = iCaps.lineSize(plane);
+            iFrame.data[plane] = iData + iCaps.planeOffset(plane);
+        }
+    } else {
+        // The caps don't know the planes of this format, assume packing.
+        if (av_image_fill_linesizes(iFrame.linesize,
+                                    iFormat,
+                                    iWidth) < 0)
+            return;
+
+        int iFrameSize = av_image_fill_pointers(iFrame.data,
+                                                iFormat,
+                                                iHeight,
+                                                iData,
+                                                iFrame.linesize);
+
+        if (iFrameSize < 0 || iBuffer.size() < iFrameSize)
+            return;
     }
 
     if (av_image_alloc(oFrame->data,
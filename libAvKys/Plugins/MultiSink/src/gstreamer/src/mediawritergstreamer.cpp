@@ -31,9 +31,11 @@
 #include <akaudiocaps.h>
 #include <akpacket.h>
 #include <akaudiopacket.h>
+#include <akvideocaps.h>
 #include <akvideopacket.h>
 #include <gst/gst.h>
 #include <gst/app/gstappsrc.h>
+#include <gst/video/video.h>
 #include <gst/pbutils/encoding-profile.h>
 
 #include "mediawritergstreamer.h"
@@ -2542,6 +2544,31 @@ void MediaWriterGStreamer::writeVideoPacket(const AkVideoPacket &packet)
     memcpy(info.data, videoPacket.buffer().constData(), size);
     gst_buffer_unmap(buffer, &info);
 
+    // Tell GStreamer how the planes are laid out in the buffer.
+    auto videoCaps = videoPacket.caps();
+    auto videoFormat = gst_video_format_from_string(iFormat.toStdString().c_str());
+    auto formatInfo = gst_video_format_get_info(videoFormat);
+
+    if (formatInfo
+        && int(GST_VIDEO_FORMAT_INFO_N_PLANES(formatInfo)) == videoCaps.planes()) {
+        gsize offset[GST_VIDEO_MAX_PLANES];
+        gint stride[GST_VIDEO_MAX_PLANES];
+
+        for (int plane = 0; plane < videoCaps.planes(); plane++) {
+            offset[plane] = gsize(videoCaps.planeOffset(plane));
+            stride[plane] = videoCaps.lineSize(plane);
+        }
+
+        gst_buffer_add_video_meta_full(buffer,
+                                       GST_VIDEO_FRAME_FLAG_NONE,
+                                       videoFormat,
+                                       guint(videoCaps.width()),
+                                       guint(videoCaps.height()),
+                                       guint(videoCaps.planes()),
+                                       offset,
+                                       stride);
+    }
+
     qint64 pts = qint64(videoPacket.pts() * videoPacket.timeBase().value() * GST_SECOND);
 
 #if 0
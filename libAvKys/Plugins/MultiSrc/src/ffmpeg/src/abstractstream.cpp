@@ -27,6 +27,7 @@
 #include <QWaitCondition>
 #include <akfrac.h>
 #include <akcaps.h>
+#include <aktrace.h>
 
 #include "abstractstream.h"
 #include "clock.h"
@@ -364,6 +365,10 @@ void AbstractStreamPrivate::packetLoop()
         this->m_packetMutex.unlock();
 
         if (gotPacket) {
+            AkTraceScope traceScope("processPacket",
+                                    "demuxer",
+                                    -1,
+                                    packet? packet->pts: AkNoPts<qint64>());
             self->processPacket(packet.data());
             emit self->notify();
         }
@@ -398,9 +403,13 @@ void AbstractStreamPrivate::dataLoop()
             this->m_dataMutex.unlock();
 
             if (gotFrame) {
-                if (frame)
+                if (frame) {
+                    AkTraceScope traceScope("processData",
+                                            "demuxer",
+                                            -1,
+                                            frame->pts);
                     self->processData(frame.data());
-                else {
+                } else {
                     emit self->eof();
                     this->m_runDataLoop = false;
                 }
@@ -30,8 +30,7 @@ CONFIG += plugin
 
 HEADERS = \
     src/normalize.h \
-    src/normalizeelement.h \
-    src/pixelstructs.h
+    src/normalizeelement.h
 
 INCLUDEPATH += \
     ../../Lib/src
@@ -20,9 +20,9 @@
 #include <QImage>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "normalizeelement.h"
-#include "pixelstructs.h"
 
 NormalizeElement::NormalizeElement(): AkElement()
 {
@@ -38,131 +38,92 @@ AkPacket NormalizeElement::iStream(const AkPacket &packet)
     QImage oFrame = src.convertToFormat(QImage::Format_ARGB32);
 
     // form histogram
-    QVector<HistogramListItem> histogram(256, HistogramListItem());
-
-    for (int y = 0; y < oFrame.height(); y++) {
-        const QRgb *dstLine = reinterpret_cast<const QRgb *>(oFrame.constScanLine(y));
-
-        for (int x = 0; x < oFrame.width(); x++) {
-            QRgb pixel = dstLine[x];
-            histogram[qRed(pixel)].red++;
-            histogram[qGreen(pixel)].green++;
-            histogram[qBlue(pixel)].blue++;
-            histogram[qAlpha(pixel)].alpha++;
-        }
-    }
+    QVector<AkPixelU32> histogram(256);
+    AkPixelKernel<>::histogram(oFrame, histogram.data());
 
     // find the histogram boundaries by locating the .01 percent levels.
-    ShortPixel high, low;
+    AkPixelU16 high, low;
     qint32 thresholdIntensity = qint32(oFrame.width() * oFrame.height() / 1e3);
-    IntegerPixel intensity;
+    AkPixelI32 intensity;
 
-    for (low.red = 0; low.red < 256; low.red++) {
-        intensity.red += histogram[low.red].red;
+    for (low.r = 0; low.r < 256; low.r++) {
+        intensity.r += histogram[low.r].r;
 
-        if (intensity.red > thresholdIntensity)
+        if (intensity.r > thresholdIntensity)
             break;
     }
 
     intensity.clear();
 
-    for (high.red = 255; high.red > 0; high.red--) {
-        intensity.red += histogram[high.red].red;
+    for (high.r = 255; high.r > 0; high.r--) {
+        intensity.r += histogram[high.r].r;
 
-        if (intensity.red > thresholdIntensity)
+        if (intensity.r > thresholdIntensity)
             break;
     }
 
     intensity.clear();
 
-    for (low.green = low.red; low.green < high.red; low.green++) {
-        intensity.green += histogram[low.green].green;
+    for (low.g = low.r; low.g < high.r; low.g++) {
+        intensity.g += histogram[low.g].g;
 
-        if (intensity.green > thresholdIntensity)
+        if (intensity.g > thresholdIntensity)
             break;
     }
 
     intensity.clear();
 
-    for (high.green = high.red; high.green != low.red; high.green--) {
-        intensity.green += histogram[high.green].green;
+    for (high.g = high.r; high.g != low.r; high.g--) {
+        intensity.g += histogram[high.g].g;
 
-        if (intensity.green > thresholdIntensity)
+        if (intensity.g > thresholdIntensity)
             break;
     }
 
     intensity.clear();
 
-    for (low.blue = low.green; low.blue < high.green; low.blue++) {
-        intensity.blue += histogram[low.blue].blue;
+    for (low.b = low.g; low.b < high.g; low.b++) {
+        intensity.b += histogram[low.b].b;
 
-        if (intensity.blue > thresholdIntensity)
+        if (intensity.b > thresholdIntensity)
             break;
     }
 
     intensity.clear();
 
-    for (high.blue = high.green; high.blue != low.green; high.blue--) {
-        intensity.blue += histogram[high.blue].blue;
+    for (high.b = high.g; high.b != low.g; high.b--) {
+        intensity.b += histogram[high.b].b;
 
-        if (intensity.blue > thresholdIntensity)
+        if (intensity.b > thresholdIntensity)
             break;
     }
 
     // stretch the histogram to create the normalized image mapping.
-    QVector<IntegerPixel> normalizeMap(256);
-
-    for (int i = 0; i < 256; i++) {
-        if(i < low.red)
-            normalizeMap[i].red = 0;
-        else {
-            if (i > high.red)
-                normalizeMap[i].red = 255;
-            else if (low.red != high.red)
-                normalizeMap[i].red = (255 * (i - low.red)) /
-                    (high.red - low.red);
-        }
-
-        if (i < low.green)
-            normalizeMap[i].green = 0;
-        else {
-            if(i > high.green)
-                normalizeMap[i].green = 255;
-            else if(low.green != high.green)
-                normalizeMap[i].green = (255 * (i - low.green)) /
-                    (high.green - low.green);
-        }
-
-        if (i < low.blue)
-            normalizeMap[i].blue = 0;
-        else {
-            if (i > high.blue)
-                normalizeMap[i].blue = 255;
-            else if (low.blue != high.blue)
-                normalizeMap[i].blue = (255*(i-low.blue)) /
-                    (high.blue - low.blue);
+    quint8 normalizeMap[3][256];
+    const quint16 lows[3] = {low.r, low.g, low.b};
+    const quint16 highs[3] = {high.r, high.g, high.b};
+
+    for (int c = 0; c < 3; c++)
+        for (int i = 0; i < 256; i++) {
+            if (lows[c] == highs[c])
+                normalizeMap[c][i] = quint8(i);
+            else if (i < lows[c])
+                normalizeMap[c][i] = 0;
+            else if (i > highs[c])
+                normalizeMap[c][i] = 255;
+            else
+                normalizeMap[c][i] = quint8((255 * (i - lows[c]))
+                                            / (highs[c] - lows[c]));
         }
-    }
 
     // write
-    for (int y = 0; y < oFrame.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < oFrame.width(); x++) {
-            QRgb pixel = oLine[x];
-
-            int r = (low.red != high.red)? normalizeMap[qRed(pixel)].red:
-                    qRed(pixel);
-
-            int g = (low.green != high.green)? normalizeMap[qGreen(pixel)].green:
-                        qGreen(pixel);
-
-            int b = (low.blue != high.blue)?  normalizeMap[qBlue(pixel)].blue:
-                        qBlue(pixel);
-
-            oLine[x] = qRgba(r, g, b, qAlpha(pixel));
-        }
-    }
+    AkPixelKernel<>::lookup(oFrame, oFrame,
+                            normalizeMap[0],
+                            normalizeMap[1],
+                            normalizeMap[2],
+                            nullptr,
+                            true,
+                            "Normalize");
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -18,9 +18,12 @@
  */
 
 #include <QImage>
+#include <QElapsedTimer>
+#include <QVarLengthArray>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "oilpaintelement.h"
 
@@ -34,6 +37,22 @@ int OilPaintElement::radius() const
     return this->m_radius;
 }
 
+QVariantMap OilPaintElement::timings() const
+{
+    QVariantMap timings;
+    this->m_mutex.lock();
+
+    for (auto it = this->m_timings.begin(); it != this->m_timings.end(); it++)
+        timings[QString::number(it.key())] = QVariantMap {
+            {"frames", it.value().first},
+            {"mean"  , qreal(it.value().second) / 1.0e6 / it.value().first}
+        };
+
+    this->m_mutex.unlock();
+
+    return timings;
+}
+
 QString OilPaintElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -64,6 +83,13 @@ void OilPaintElement::resetRadius()
     this->setRadius(2);
 }
 
+void OilPaintElement::resetTimings()
+{
+    this->m_mutex.lock();
+    this->m_timings.clear();
+    this->m_mutex.unlock();
+}
+
 AkPacket OilPaintElement::iStream(const AkPacket &packet)
 {
     QImage src = AkUtils::packetToImage(packet);
@@ -73,48 +99,175 @@ AkPacket OilPaintElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
 
+    QElapsedTimer timer;
+    timer.start();
+
     int radius = this->m_radius > 0? this->m_radius: 1;
-    QImage oFrame(src.size(), src.format());
-    int histogram[256];
+    int width = src.width();
+    int height = src.height();
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
     int scanBlockLen = (radius << 1) + 1;
-    QVector<const QRgb *> scanBlock(scanBlockLen);
 
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    // Every pixel is visited (2 * radius + 1) times, get its luma just once.
+    if (this->m_gray.size() != width * height)
+        this->m_gray.resize(width * height);
+
+    auto grayBits = this->m_gray.data();
+
+    AkPixelKernel<>::forEachBand(height, [&] (int first, int last) {
+        for (int y = first; y < last; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto grayLine = grayBits + y * width;
+
+            for (int x = 0; x < width; x++)
+                grayLine[x] = quint8(qGray(srcLine[x]));
+        }
+    }, true, "OilPaint");
+
+    /* The output is the pixel that first makes a luma reach the highest
+     * count, scanning the window line by line, as if the window was counted
+     * from scratch.
+     *
+     * The histogram of the window is kept while moving along the line, so
+     * each step only adds the incoming column and removes the outgoing one.
+     * The bins are also linked in one list per count, so the bins with the
+     * highest count are always at hand, and the count of each bin in each
+     * line of the window tells in which line that count is reached.
+     */
+    AkPixelKernel<>::forEachLine(oFrame, [&] (int y, QRgb *oLine) {
+        int maxCount = scanBlockLen * scanBlockLen;
+        int histogram[256];
+        int next[256];
+        int prev[256];
+        QVarLengthArray<int, 1024> levels(maxCount + 1);
+        QVarLengthArray<quint16, 256 * 16> lineCounts(256 * scanBlockLen);
+        QVarLengthArray<const QRgb *, 64> scanBlock(scanBlockLen);
+        QVarLengthArray<const quint8 *, 64> grayBlock(scanBlockLen);
 
         for (int j = 0, pos = y - radius; j < scanBlockLen; j++, pos++) {
-            int yp = qBound(0, pos, src.height());
+            int yp = qBound(0, pos, height - 1);
             scanBlock[j] = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
+            grayBlock[j] = grayBits + yp * width;
         }
 
-        for (int x = 0; x < src.width(); x++) {
-            int minI = x - radius;
-            int maxI = x + radius + 1;
+        memset(histogram, 0, 256 * sizeof(int));
+        memset(lineCounts.data(), 0, size_t(lineCounts.size()) * sizeof(quint16));
 
-            if (minI < 0)
-                minI = 0;
+        for (int i = 0; i <= maxCount; i++)
+            levels[i] = -1;
 
-            if (maxI > src.width())
-                maxI = src.width();
+        int mode = 0;
 
-            memset(histogram, 0, 256 * sizeof(int));
-            int max = 0;
-            QRgb oPixel = 0;
+        auto unlinkBin = [&] (int value) {
+            if (prev[value] >= 0)
+                next[prev[value]] = next[value];
+            else
+                levels[histogram[value]] = next[value];
 
-            for (int j = 0; j < scanBlockLen; j++)
-                for (int i = minI; i < maxI; i++) {
-                    QRgb pixel = scanBlock[j][i];
-                    int value = ++histogram[qGray(pixel)];
+            if (next[value] >= 0)
+                prev[next[value]] = prev[value];
+        };
 
-                    if (value > max) {
-                        max = value;
-                        oPixel = pixel;
-                    }
+        auto linkBin = [&] (int value) {
+            int &head = levels[histogram[value]];
+            prev[value] = -1;
+            next[value] = head;
+
+            if (head >= 0)
+                prev[head] = value;
+
+            head = value;
+        };
+
+        auto addColumn = [&] (int x) {
+            for (int j = 0; j < scanBlockLen; j++) {
+                int value = grayBlock[j][x];
+
+                if (histogram[value] > 0)
+                    unlinkBin(value);
+
+                histogram[value]++;
+                lineCounts[j * 256 + value]++;
+                linkBin(value);
+
+                if (histogram[value] > mode)
+                    mode = histogram[value];
+            }
+        };
+
+        auto removeColumn = [&] (int x) {
+            for (int j = 0; j < scanBlockLen; j++) {
+                int value = grayBlock[j][x];
+                unlinkBin(value);
+                histogram[value]--;
+                lineCounts[j * 256 + value]--;
+
+                if (histogram[value] > 0)
+                    linkBin(value);
+
+                if (levels[mode] < 0)
+                    mode--;
+            }
+        };
+
+        for (int x = 0; x < qMin(radius, width); x++)
+            addColumn(x);
+
+        for (int x = 0; x < width; x++) {
+            int xOut = x - radius - 1;
+            int xIn = x + radius;
+
+            if (xOut >= 0)
+                removeColumn(xOut);
+
+            if (xIn < width)
+                addColumn(xIn);
+
+            int minI = qMax(x - radius, 0);
+            int maxI = qMin(x + radius + 1, width);
+            int bestJ = scanBlockLen;
+            int bestI = 0;
+
+            // Find where each of the most frequent lumas reaches its count.
+            for (int value = levels[mode]; value >= 0; value = next[value]) {
+                int count = 0;
+                int j = 0;
+
+                for (; j < scanBlockLen; j++) {
+                    int lineCount = lineCounts[j * 256 + value];
+
+                    if (count + lineCount >= mode)
+                        break;
+
+                    count += lineCount;
                 }
 
-            oLine[x] = oPixel;
+                // Ties go to the luma that gets there first.
+                if (j > bestJ)
+                    continue;
+
+                auto grayLine = grayBlock[j];
+                int maxPos = j < bestJ? maxI: bestI;
+
+                for (int i = minI; i < maxPos; i++)
+                    if (grayLine[i] == value && ++count == mode) {
+                        bestJ = j;
+                        bestI = i;
+
+                        break;
+                    }
+            }
+
+            oLine[x] = scanBlock[bestJ][bestI];
         }
-    }
+    }, true, "OilPaint");
+
+    auto elapsed = timer.nsecsElapsed();
+    this->m_mutex.lock();
+    auto &timing = this->m_timings[radius];
+    timing.first++;
+    timing.second += elapsed;
+    this->m_mutex.unlock();
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -20,6 +20,8 @@
 #ifndef OILPAINTELEMENT_H
 #define OILPAINTELEMENT_H
 
+#include <QMutex>
+#include <QVector>
 #include <akelement.h>
 
 class OilPaintElement: public AkElement
@@ -36,8 +38,14 @@ class OilPaintElement: public AkElement
 
         Q_INVOKABLE int radius() const;
 
+        // Mean processing time in milliseconds, per radius.
+        Q_INVOKABLE QVariantMap timings() const;
+
     private:
         int m_radius;
+        QVector<quint8> m_gray;
+        QMap<int, QPair<quint64, quint64>> m_timings;
+        mutable QMutex m_mutex;
 
     protected:
         QString controlInterfaceProvide(const QString &controlId) const;
@@ -50,6 +58,7 @@ class OilPaintElement: public AkElement
     public slots:
         void setRadius(int radius);
         void resetRadius();
+        void resetTimings();
         AkPacket iStream(const AkPacket &packet);
 };
 
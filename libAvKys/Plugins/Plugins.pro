@@ -31,6 +31,7 @@ SUBDIRS += \
     MultiSink \
     MultiSrc \
     Probe \
+    Tee \
     VideoCapture \
     VirtualCamera
 
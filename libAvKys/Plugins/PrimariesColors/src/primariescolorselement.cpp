@@ -72,7 +72,7 @@ AkPacket PrimariesColorsElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     int f = this->m_factor + 1;
     int factor127 = (f * f - 3) * 127;
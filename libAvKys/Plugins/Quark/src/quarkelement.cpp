@@ -89,7 +89,7 @@ AkPacket QuarkElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (src.size() != this->d->m_frameSize) {
         this->d->m_frames.clear();
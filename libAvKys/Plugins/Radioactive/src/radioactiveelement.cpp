@@ -333,7 +333,7 @@ AkPacket RadioactiveElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (src.size() != this->d->m_frameSize) {
         this->d->m_blurZoomBuffer = QImage();
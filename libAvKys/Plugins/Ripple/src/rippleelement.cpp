@@ -481,7 +481,7 @@ AkPacket RippleElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (packet.caps() != this->d->m_caps) {
         this->d->m_prevFrame = QImage();
@@ -112,7 +112,7 @@ AkPacket ScanLinesElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     int showSize = this->m_showSize;
     int hideSize = this->m_hideSize;
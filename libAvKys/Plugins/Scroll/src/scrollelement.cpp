@@ -133,7 +133,7 @@ AkPacket ScrollElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame = QImage(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
 
     if (src.size() != this->d->m_curSize) {
         this->d->m_offset = 0.0;
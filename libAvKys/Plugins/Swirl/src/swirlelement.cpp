@@ -28,6 +28,7 @@
 SwirlElement::SwirlElement(): AkElement()
 {
     this->m_degrees = 60;
+    this->m_remapDegrees = 0;
 }
 
 qreal SwirlElement::degrees() const
@@ -73,49 +74,60 @@ AkPacket SwirlElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
-
-    qreal xScale = 1.0;
-    qreal yScale = 1.0;
-    qreal xCenter = src.width() >> 1;
-    qreal yCenter = src.height() >> 1;
-    qreal radius = qMax(xCenter, yCenter);
-
-    if (src.width() > src.height())
-        yScale = qreal(src.width() / src.height());
-    else if (src.width() < src.height())
-        xScale = qreal(src.height() / src.width());
-
-    qreal degrees = M_PI * this->m_degrees / 180.0;
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        qreal yDistance = yScale * (y - yCenter);
-
-        for (int x = 0; x < src.width(); x++) {
-            qreal xDistance = xScale * (x - xCenter);
-            qreal distance = xDistance * xDistance + yDistance * yDistance;
-
-            if (distance >= radius * radius)
-                oLine[x] = iLine[x];
-            else {
-                qreal factor = 1.0 - sqrt(distance) / radius;
-                qreal sine = sin(degrees * factor * factor);
-                qreal cosine = cos(degrees * factor * factor);
-
-                int xp = int((cosine * xDistance - sine * yDistance) / xScale + xCenter);
-                int yp = int((sine * xDistance + cosine * yDistance) / yScale + yCenter);
-
-                if (!oFrame.rect().contains(xp, yp))
-                    continue;
-
-                const QRgb *line = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-                oLine[x] = line[xp];
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+
+    qreal degrees = this->m_degrees;
+
+    // The mapping only depends on the frame size and the angle.
+    if (!this->m_remap.fits(src)
+        || this->m_remapDegrees != degrees) {
+        qreal xScale = 1.0;
+        qreal yScale = 1.0;
+        qreal xCenter = src.width() >> 1;
+        qreal yCenter = src.height() >> 1;
+        qreal radius = qMax(xCenter, yCenter);
+        QRect rect = src.rect();
+
+        if (src.width() > src.height())
+            yScale = qreal(src.width() / src.height());
+        else if (src.width() < src.height())
+            xScale = qreal(src.height() / src.width());
+
+        qreal angle = M_PI * degrees / 180.0;
+
+        this->m_remap.build(src.size(),
+                            AkRemap::stride(src),
+                            [=] (int y,
+                                 int width,
+                                 int stride,
+                                 qint32 *offsets) {
+            qreal yDistance = yScale * (y - yCenter);
+
+            for (int x = 0; x < width; x++) {
+                qreal xDistance = xScale * (x - xCenter);
+                qreal distance = xDistance * xDistance + yDistance * yDistance;
+
+                if (distance >= radius * radius) {
+                    offsets[x] = AkRemap::offset(x, y, stride);
+                } else {
+                    qreal factor = 1.0 - sqrt(distance) / radius;
+                    qreal sine = sin(angle * factor * factor);
+                    qreal cosine = cos(angle * factor * factor);
+
+                    int xp = int((cosine * xDistance - sine * yDistance) / xScale + xCenter);
+                    int yp = int((sine * xDistance + cosine * yDistance) / yScale + yCenter);
+
+                    offsets[x] = rect.contains(xp, yp)?
+                                     AkRemap::offset(xp, yp, stride): -1;
+                }
             }
-        }
+        }, true, "Swirl");
+
+        this->m_remapDegrees = degrees;
     }
 
+    this->m_remap.apply(src, oFrame, true, "Swirl");
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
@@ -17,42 +17,20 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
-#ifndef PIXELSTRUCTS_H
-#define PIXELSTRUCTS_H
+#ifndef TEE_H
+#define TEE_H
 
-#include <qglobal.h>
+#include <akplugin.h>
 
-template<typename T>
-struct Pixel
+class Tee: public QObject, public AkPlugin
 {
-    Pixel():
-        red(0), green(0), blue(0), alpha(0)
-    {
-    }
+    Q_OBJECT
+    Q_INTERFACES(AkPlugin)
+    Q_PLUGIN_METADATA(IID "org.avkys.plugin" FILE "pspec.json")
 
-    Pixel(T red, T green, T blue, T alpha):
-        red(red), green(green), blue(blue), alpha(alpha)
-    {
-    }
-
-    void clear() {
-        this->red = 0;
-        this->green = 0;
-        this->blue = 0;
-        this->alpha = 0;
-    }
-
-    T red;
-    T green;
-    T blue;
-    T alpha;
+    public:
+        QObject *create(const QString &key, const QString &specification);
+        QStringList keys() const;
 };
 
-// These are used as accumulators
-typedef struct Pixel<qint32> IntegerPixel;
-typedef struct Pixel<quint32> UIntegerPixel;
-typedef struct Pixel<quint16> ShortPixel;
-typedef struct Pixel<quint8>  CharPixel;
-typedef IntegerPixel HistogramListItem;
-
-#endif // PIXELSTRUCTS_H
+#endif // TEE_H
@@ -0,0 +1,105 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <akpacket.h>
+
+#include "teeelement.h"
+
+TeeElement::TeeElement(): AkElement()
+{
+}
+
+TeeElement::~TeeElement()
+{
+    this->clearBranches();
+}
+
+QVariantList TeeElement::branches() const
+{
+    QVariantList branches;
+    QMutexLocker mutexLocker(&this->m_mutex);
+
+    for (auto &element: this->m_branches) {
+        if (!element)
+            continue;
+
+        auto queue = AkElement::linkQueue(this, element.data());
+
+        if (!queue)
+            continue;
+
+        branches << QVariantMap {
+            {"element"   , QVariant::fromValue(element.data())},
+            {"depth"     , queue->depth()                     },
+            {"dropPolicy", queue->dropPolicy()                },
+            {"size"      , queue->size()                      },
+            {"dropped"   , queue->dropped()                   }
+        };
+    }
+
+    return branches;
+}
+
+bool TeeElement::addBranch(QObject *element,
+                           int depth,
+                           AkPacketQueue::DropPolicy dropPolicy)
+{
+    if (!element)
+        return false;
+
+    QMutexLocker mutexLocker(&this->m_mutex);
+
+    if (this->m_branches.contains(element))
+        return false;
+
+    if (!this->linkQueued(element, depth, dropPolicy))
+        return false;
+
+    this->m_branches << element;
+
+    return true;
+}
+
+bool TeeElement::removeBranch(QObject *element)
+{
+    QMutexLocker mutexLocker(&this->m_mutex);
+
+    if (!this->m_branches.removeOne(element))
+        return false;
+
+    return this->unlink(element);
+}
+
+void TeeElement::clearBranches()
+{
+    QMutexLocker mutexLocker(&this->m_mutex);
+
+    for (auto &element: this->m_branches)
+        if (element)
+            this->unlink(element.data());
+
+    this->m_branches.clear();
+}
+
+AkPacket TeeElement::iStream(const AkPacket &packet)
+{
+    akSend(packet)
+}
+
+#include "moc_teeelement.cpp"
@@ -0,0 +1,59 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef TEEELEMENT_H
+#define TEEELEMENT_H
+
+#include <QMutex>
+#include <QPointer>
+#include <akelement.h>
+
+/* Sends every packet to several branches.
+ *
+ * Each branch has its own queue and thread, so a slow branch only drops or
+ * delays its own packets. The packet is shared among all the branches, it's
+ * never copied.
+ */
+class TeeElement: public AkElement
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList branches
+               READ branches)
+
+    public:
+        explicit TeeElement();
+        ~TeeElement();
+
+        Q_INVOKABLE QVariantList branches() const;
+        Q_INVOKABLE bool addBranch(QObject *element,
+                                   int depth=2,
+                                   AkPacketQueue::DropPolicy dropPolicy=AkPacketQueue::DropPolicyDropOldest);
+        Q_INVOKABLE bool removeBranch(QObject *element);
+
+    private:
+        QList<QPointer<QObject>> m_branches;
+        mutable QMutex m_mutex;
+
+    public slots:
+        void clearBranches();
+
+        AkPacket iStream(const AkPacket &packet);
+};
+
+#endif // TEEELEMENT_H
@@ -27,6 +27,8 @@
 #include <akvideocaps.h>
 #include <akpacket.h>
 #include <akvideopacket.h>
+#include <akvideobufferpool.h>
+#include <aktrace.h>
 
 extern "C"
 {
@@ -389,11 +391,14 @@ void ConvertVideoFFmpegPrivate::packetLoop(ConvertVideoFFmpeg *stream)
 
         if (!stream->d->m_packets.isEmpty()) {
             AkPacket packet = stream->d->m_packets.dequeue();
+            AkTraceScope traceScope("decode", "convert", packet);
 
             AVPacket videoPacket;
             av_init_packet(&videoPacket);
-            videoPacket.data = reinterpret_cast<uint8_t *>(packet.buffer().data());
-            videoPacket.size = packet.buffer().size();
+            // The decoder only reads the data, don't detach the pooled buffer.
+            auto iBuffer = qAsConst(packet).buffer();
+            videoPacket.data = reinterpret_cast<uint8_t *>(const_cast<char *>(iBuffer.constData()));
+            videoPacket.size = iBuffer.size();
             videoPacket.pts = packet.pts();
 
 #ifdef HAVE_SENDRECV
@@ -460,6 +465,7 @@ void ConvertVideoFFmpegPrivate::dataLoop(ConvertVideoFFmpeg *stream)
 
         if (!stream->d->m_frames.isEmpty()) {
             FramePtr frame = stream->d->m_frames.dequeue();
+            AkTraceScope traceScope("processData", "convert", -1, frame->pts);
             stream->d->processData(frame);
 
             if (stream->d->m_frames.size() < stream->d->m_maxData)
@@ -543,38 +549,29 @@ void ConvertVideoFFmpegPrivate::convert(const FramePtr &frame)
     if (!this->m_scaleContext)
         return;
 
-    // Create oPicture
-    AVFrame oFrame;
-    memset(&oFrame, 0, sizeof(AVFrame));
-
     if (av_image_check_size(uint(frame->width),
                             uint(frame->height),
                             0,
                             nullptr) < 0)
         return;
 
-    if (av_image_fill_linesizes(oFrame.linesize,
-                                outPixFormat,
-                                frame->width) < 0)
-        return;
+    // Output lines are aligned for SIMD, the caps carry the line size.
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkVideoCaps::Format_rgb24;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = frame->width;
+    caps.height() = frame->height;
+    caps.fps() = this->m_fps;
+    caps.align() = AkVideoBufferPool::Alignment;
 
-    uint8_t *data[4];
-    memset(data, 0, 4 * sizeof(uint8_t *));
-    int frameSize = av_image_fill_pointers(data,
-                                           outPixFormat,
-                                           frame->height,
-                                           nullptr,
-                                           oFrame.linesize);
-
-    QByteArray oBuffer(frameSize, 0);
-
-    if (av_image_fill_pointers(reinterpret_cast<uint8_t **>(oFrame.data),
-                               outPixFormat,
-                               frame->height,
-                               reinterpret_cast<uint8_t *>(oBuffer.data()),
-                               oFrame.linesize) < 0) {
-        return;
-    }
+    auto oBuffer = AkVideoBufferPool::globalInstance()->buffer(caps);
+
+    // Create oPicture
+    AVFrame oFrame;
+    memset(&oFrame, 0, sizeof(AVFrame));
+    oFrame.linesize[0] = caps.lineSize(0);
+    oFrame.data[0] = reinterpret_cast<uint8_t *>(AkVideoBufferPool::data(oBuffer));
 
     // Convert picture format
     sws_scale(this->m_scaleContext,
@@ -585,14 +582,6 @@ void ConvertVideoFFmpegPrivate::convert(const FramePtr &frame)
               oFrame.data,
               oFrame.linesize);
 
-    AkVideoCaps caps;
-    caps.isValid() = true;
-    caps.format() = AkVideoCaps::Format_rgb24;
-    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
-    caps.width() = frame->width;
-    caps.height() = frame->height;
-    caps.fps() = this->m_fps;
-
     // Create packet
     AkVideoPacket oPacket;
     oPacket.caps() = caps;
@@ -27,6 +27,7 @@
 #include <akfrac.h>
 #include <akcaps.h>
 #include <akpacket.h>
+#include <akvideobufferpool.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -113,6 +114,7 @@ class CaptureV4L2Private
         AkFrac m_fps;
         AkFrac m_timeBase;
         AkCaps m_caps;
+        size_t m_frameSize;
         qint64 m_id;
         QVector<CaptureBuffer> m_buffers;
 
@@ -122,6 +124,7 @@ class CaptureV4L2Private
             m_nBuffers(32),
             m_fsWatcher(nullptr),
             m_fd(-1),
+            m_frameSize(0),
             m_id(-1)
         {
         }
@@ -969,7 +972,20 @@ AkPacket CaptureV4L2Private::processFrame(const char *buffer,
                                           size_t bufferSize,
                                           qint64 pts) const
 {
-    QByteArray oBuffer(buffer, int(bufferSize));
+    QByteArray oBuffer;
+
+    /* Compressed frames (MJPEG and the like) change their size every frame,
+     * pooling them would only fill the pool with buffers of sizes that never
+     * come back. Only raw frames, always as big as the format says, are
+     * pooled.
+     */
+    if (bufferSize == this->m_frameSize) {
+        oBuffer = AkVideoBufferPool::globalInstance()->buffer(this->m_caps,
+                                                              int(bufferSize));
+        memcpy(AkVideoBufferPool::data(oBuffer), buffer, bufferSize);
+    } else
+        oBuffer = QByteArray(buffer, int(bufferSize));
+
     AkPacket oPacket(this->m_caps, oBuffer);
 
     oPacket.setPts(pts);
@@ -1042,6 +1058,7 @@ bool CaptureV4L2::init()
     }
 
     this->d->m_caps = caps;
+    this->d->m_frameSize = fmt.fmt.pix.sizeimage;
     this->d->m_fps = caps.property("fps").toString();
     this->d->m_timeBase = this->d->m_fps.invert();
 
@@ -1097,6 +1114,7 @@ void CaptureV4L2::uninit()
 
     x_close(this->d->m_fd);
     this->d->m_caps.clear();
+    this->d->m_frameSize = 0;
     this->d->m_fps = AkFrac();
     this->d->m_timeBase = AkFrac();
     this->d->m_buffers.clear();
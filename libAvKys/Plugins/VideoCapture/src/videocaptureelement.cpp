@@ -29,6 +29,7 @@
 #include <akcaps.h>
 #include <akfrac.h>
 #include <akpacket.h>
+#include <aktrace.h>
 
 #include "videocaptureelement.h"
 #include "videocaptureglobals.h"
@@ -322,7 +323,13 @@ void VideoCaptureElementPrivate::cameraLoop()
                 continue;
             }
 
-            AkPacket packet = this->m_capture->readFrame();
+            AkPacket packet;
+
+            {
+                AkTraceScope traceScope("readFrame", "capture");
+                packet = this->m_capture->readFrame();
+                traceScope.setPacket(packet);
+            }
 
             if (!packet)
                 continue;
@@ -103,17 +103,35 @@ AkPacket ConvertVideoFFmpeg::convert(const AkPacket &packet, const AkCaps &oCaps
                             nullptr) < 0)
         return AkPacket();
 
-    if (av_image_fill_linesizes(iFrame.linesize,
-                                iFormat,
-                                videoPacket.caps().width()) < 0)
-        return AkPacket();
+    // Read the frame planes in place, as described by the caps.
+    auto iCaps = videoPacket.caps();
+    auto iBuffer = videoPacket.buffer();
 
-    if (av_image_fill_pointers(reinterpret_cast<uint8_t **>(iFrame.data),
-                               iFormat,
-                               videoPacket.caps().height(),
-                               reinterpret_cast<uint8_t *>(videoPacket.buffer().data()),
-                               iFrame.linesize) < 0) {
-        return AkPacket();
+    auto iData = reinterpret_cast<uint8_t *>(const_cast<char *>(iBuffer.constData()));
+
+    if (av_pix_fmt_count_planes(iFormat) == iCaps.planes()) {
+        if (iBuffer.size() < iCaps.pictureSize())
+            return AkPacket();
+
+        for (int plane = 0; plane < iCaps.planes(); plane++) {
+            iFrame.linesize[plane] = iCaps.lineSize(plane);
+            iFrame.data[plane] = iData + iCaps.planeOffset(plane);
+        }
+    } else {
+        // The caps don't know the planes of this format, assume packing.
+        if (av_image_fill_linesizes(iFrame.linesize,
+                                    iFormat,
+                                    iCaps.width()) < 0)
+            return AkPacket();
+
+        int iFrameSize = av_image_fill_pointers(iFrame.data,
+                                                iFormat,
+                                                iCaps.height(),
+                                                iData,
+                                                iFrame.linesize);
+
+        if (iFrameSize < 0 || iBuffer.size() < iFrameSize)
+            return AkPacket();
     }
 
     // Create oPicture
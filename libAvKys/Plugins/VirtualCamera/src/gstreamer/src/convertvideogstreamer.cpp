@@ -126,6 +126,31 @@ AkPacket ConvertVideoGStreamer::convert(const AkPacket &packet, const AkCaps &oC
 
     QString iFormat = AkVideoCaps::pixelFormatToString(videoPacket.caps().format());
     iFormat = gstToFF->key(iFormat, "I420");
+
+    // Tell GStreamer how the planes are laid out in the buffer.
+    auto iVideoCaps = videoPacket.caps();
+    auto iVideoFormat = gst_video_format_from_string(iFormat.toStdString().c_str());
+    auto iFormatInfo = gst_video_format_get_info(iVideoFormat);
+
+    if (iFormatInfo
+        && int(GST_VIDEO_FORMAT_INFO_N_PLANES(iFormatInfo)) == iVideoCaps.planes()) {
+        gsize offset[GST_VIDEO_MAX_PLANES];
+        gint stride[GST_VIDEO_MAX_PLANES];
+
+        for (int plane = 0; plane < iVideoCaps.planes(); plane++) {
+            offset[plane] = gsize(iVideoCaps.planeOffset(plane));
+            stride[plane] = iVideoCaps.lineSize(plane);
+        }
+
+        gst_buffer_add_video_meta_full(iBuffer,
+                                       GST_VIDEO_FRAME_FLAG_NONE,
+                                       iVideoFormat,
+                                       guint(iVideoCaps.width()),
+                                       guint(iVideoCaps.height()),
+                                       guint(iVideoCaps.planes()),
+                                       offset,
+                                       stride);
+    }
     GstCaps *iCaps = gst_caps_new_simple("video/x-raw",
                                          "format", G_TYPE_STRING, iFormat.toStdString().c_str(),
                                          "width", G_TYPE_INT, videoPacket.caps().width(),
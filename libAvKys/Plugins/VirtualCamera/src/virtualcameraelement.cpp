@@ -24,6 +24,7 @@
 #include <akutils.h>
 #include <akcaps.h>
 #include <akpacket.h>
+#include <aktrace.h>
 
 #include "virtualcameraelement.h"
 #include "virtualcameraglobals.h"
@@ -531,6 +532,7 @@ AkPacket VirtualCameraElement::iStream(const AkPacket &packet)
         this->d->m_mutexLib.unlock();
 #endif
 
+        AkTraceScope traceScope("writeFrame", "virtualCamera", oPacket);
         this->d->m_mutexLib.lock();
         this->d->m_cameraOut->writeFrame(oPacket);
         this->d->m_mutexLib.unlock();
@@ -95,7 +95,7 @@ AkPacket WarholElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame = QImage(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
     int nFrames = this->d->m_nFrames;
 
     for (int y = 0; y < src.height(); y++) {
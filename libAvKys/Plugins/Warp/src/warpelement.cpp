@@ -22,18 +22,30 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akpixel.h>
 
 #include "warpelement.h"
 
+// Subdivisions of a pixel in the distance table.
+#define WARP_DISTANCE_STEPS 4
+
 class WarpElementPrivate
 {
     public:
         qreal m_ripples;
         QSize m_frameSize;
-        QVector<qreal> m_phiTable;
+        qreal m_phiScale;
+
+        // Quantized distance of each pixel to the center of the frame.
+        QVector<int> m_distanceTable;
+
+        // Displacement of each distance in the current frame, 24.8 fixed point.
+        QVector<int> m_dxTable;
+        QVector<int> m_dyTable;
 
         WarpElementPrivate():
-            m_ripples(4)
+            m_ripples(4),
+            m_phiScale(0)
         {
         }
 };
@@ -91,19 +103,29 @@ AkPacket WarpElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame(src.size(), src.format());
+    QImage oFrame = AkUtils::frameImage(src.size(), src.format());
+
+    int width = src.width();
+    int height = src.height();
 
     if (src.size() != this->d->m_frameSize) {
-        int cx = src.width() >> 1;
-        int cy = src.height() >> 1;
+        int cx = width >> 1;
+        int cy = height >> 1;
+        qreal maxDistance = qMax(1.0, sqrt(cx * cx + cy * cy));
 
-        qreal k = 2.0 * M_PI / sqrt(cx * cx + cy * cy);
+        this->d->m_phiScale = 2.0 * M_PI / maxDistance / WARP_DISTANCE_STEPS;
+        this->d->m_distanceTable.resize(width * height);
+        int *distanceTable = this->d->m_distanceTable.data();
 
-        this->d->m_phiTable.clear();
+        for (int y = 0, i = 0; y < height; y++)
+            for (int x = 0; x < width; x++, i++)
+                distanceTable[i] =
+                        qRound(WARP_DISTANCE_STEPS
+                               * sqrt((x - cx) * (x - cx) + (y - cy) * (y - cy)));
 
-        for (int y = -cy; y < cy; y++)
-            for (int x = -cx; x < cx; x++)
-                this->d->m_phiTable << k * sqrt(x * x + y * y);
+        int steps = qCeil(WARP_DISTANCE_STEPS * maxDistance) + 2;
+        this->d->m_dxTable.resize(steps);
+        this->d->m_dyTable.resize(steps);
 
         this->d->m_frameSize = src.size();
         emit this->frameSizeChanged(this->d->m_frameSize);
@@ -120,24 +142,43 @@ AkPacket WarpElement::iStream(const AkPacket &packet)
     qreal ripples = this->d->m_ripples * sin((tval - 70) * M_PI / 64);
 
     tval = (tval + 1) & 511;
-    qreal *phiTable = this->d->m_phiTable.data();
 
-    for (int y = 0, i = 0; y < src.height(); y++) {
-        auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    /* The mapping changes every frame, so it isn't cached. The displacement
+     * only depends on the distance to the center though, so the trigonometry
+     * is done once per distance instead of once per pixel, and the offsets
+     * are computed while gathering.
+     */
+    int *dxTable = this->d->m_dxTable.data();
+    int *dyTable = this->d->m_dyTable.data();
+
+    for (int i = 0; i < this->d->m_dxTable.size(); i++) {
+        qreal phi = ripples * this->d->m_phiScale * i;
+        dxTable[i] = qRound(256 * dx * cos(phi));
+        dyTable[i] = qRound(256 * dy * sin(phi));
+    }
 
-        for (int x = 0; x < src.width(); x++, i++) {
-            qreal phi = ripples * phiTable[i];
+    const int *distanceTable = this->d->m_distanceTable.constData();
 
-            int xOrig = int(dx * cos(phi) + x);
-            int yOrig = int(dy * sin(phi) + y);
+    // The source lines can be padded, so they are read one by one.
+    auto srcBits = src.constBits();
+    int srcLineSize = src.bytesPerLine();
 
-            xOrig = qBound(0, xOrig, src.width());
-            yOrig = qBound(0, yOrig, src.height());
+    AkPixelKernel<>::forEachLine(oFrame, [=] (int y, QRgb *oLine) {
+        auto distanceLine = distanceTable + y * width;
 
-            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yOrig));
+        for (int x = 0; x < width; x++) {
+            int distance = distanceLine[x];
+
+            int xOrig = ((x << 8) + dxTable[distance]) >> 8;
+            int yOrig = ((y << 8) + dyTable[distance]) >> 8;
+
+            xOrig = qBound(0, xOrig, width - 1);
+            yOrig = qBound(0, yOrig, height - 1);
+
+            auto iLine = reinterpret_cast<const QRgb *>(srcBits + yOrig * srcLineSize);
             oLine[x] = iLine[xOrig];
         }
-    }
+    }, true, "Warp");
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -0,0 +1,139 @@
+# Webcamoid, webcam capture application.
+# Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+#
+# Webcamoid is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Webcamoid is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+#
+# Web-Site: http://webcamoid.github.io/
+
+exists(commons.pri) {
+    include(commons.pri)
+} else {
+    exists(../../commons.pri) {
+        include(../../commons.pri)
+    } else {
+        error("commons.pri file not found.")
+    }
+}
+
+# Checks the output of the effects against the reference images with akbench.
+# "make check" runs the comparison, "make references" writes the references
+# again, do it only from a known good build. To use the akbench and plugins of
+# the build of another checkout, run "qmake AKBENCH_BUILD=/path/to/its/build"
+# first.
+#
+# Every video filter is listed at least once, the effects that use qrand()
+# (Aging, Dice, Fire, Nervous, Quark...) are reproducible because akbench
+# reseeds it before every frame. Charify and Matrix draw text, so their
+# references are only valid with the same fonts (DejaVu).
+#
+# The references are the output of the effects before their optimization,
+# except for Warp: its distances are quantized to 1/4 pixel now, which moves
+# some samples by one pixel, so its reference is the quantized map and it must
+# match exactly.
+#
+# Approximate implementations have an explicit tolerance in
+# references/tolerances.json:
+#
+# - ChangeHSL: trilinear interpolation of a 33x33x33 LUT. The cells around the
+#   grays and the reds are exact when the kernel changes the hue.
+# - ColorTransform: 20.12 fixed point rounding.
+# - Photocopy: libm differences in exp().
+
+TEMPLATE = aux
+
+REFERENCE_EFFECTS = \
+    Aging \
+    Blur:radius=3 \
+    Blur:radius=3:passes=3 \
+    Cartoon \
+    ChangeHSL:kernel=1,0,0,0,0,0.5,0,0,0,0,1,16 \
+    ChangeHSL:kernel=1,0,0,120,0,1,0,0,0,0,1,0 \
+    Charify \
+    Cinema \
+    ColorFilter \
+    ColorReplace \
+    ColorTap \
+    ColorTransform:kernel=0.9,0.2,0,8,0.1,0.8,0.1,0,0,0.3,0.7,-8 \
+    Convolve:bias=16 \
+    Convolve:kernel=1,0,-1,2,0,-2,1,0,-1:bias=128 \
+    DelayGrab \
+    Denoise \
+    Dice \
+    Distort \
+    Dizzy \
+    Edge \
+    Edge:canny=true \
+    Emboss \
+    Equalize \
+    FaceDetect \
+    FalseColor \
+    Fire \
+    FrameOverlap:nFrames=4:stride=2 \
+    GrayScale \
+    Halftone \
+    Hypnotic \
+    Implode:amount=2 \
+    Invert \
+    Life \
+    Matrix \
+    MatrixTransform:kernel=0.9,0.2,-4,-0.1,1.1,3 \
+    Nervous \
+    Normalize \
+    OilPaint:radius=2 \
+    Photocopy \
+    Pixelate \
+    PrimariesColors \
+    Quark \
+    Radioactive \
+    Ripple \
+    ScanLines \
+    Scroll \
+    Shagadelic \
+    Swirl:degrees=90 \
+    Temperature \
+    Vignette \
+    Warhol \
+    Warp \
+    Wave
+
+REFERENCE_SIZE = 64x48
+REFERENCE_FORMAT = 0rgb
+
+isEmpty(AKBENCH_BUILD): AKBENCH_BUILD = $$OUT_PWD/../..
+
+AKBENCH_ARGS = \
+    -p $$shell_quote($$AKBENCH_BUILD/Plugins) \
+    -r \
+    -s $$REFERENCE_SIZE \
+    -f $$REFERENCE_FORMAT
+
+for(effect, REFERENCE_EFFECTS): AKBENCH_ARGS += -e $$shell_quote($$effect)
+
+unix: AKBENCH = LD_LIBRARY_PATH=$$shell_quote($$AKBENCH_BUILD/Lib) \
+                QT_QPA_PLATFORM=offscreen \
+                $$shell_quote($$AKBENCH_BUILD/AkBench/akbench)
+else: AKBENCH = $$shell_quote($$shell_path($$AKBENCH_BUILD/AkBench/akbench))
+
+check.commands = \
+    $$AKBENCH $$AKBENCH_ARGS \
+    --check-references $$shell_quote($$PWD/references)
+
+references.commands = \
+    $$AKBENCH $$AKBENCH_ARGS \
+    --save-references $$shell_quote($$PWD/references)
+
+QMAKE_EXTRA_TARGETS += check references
+
+OTHER_FILES += \
+    references/tolerances.json
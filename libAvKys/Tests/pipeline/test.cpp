@@ -0,0 +1,156 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QtTest>
+#include <akelement.h>
+
+#include "pipeline.h"
+
+class TestPipeline: public QObject
+{
+    Q_OBJECT
+
+    private:
+        ElementMap elements(const QStringList &names) const;
+        QString connectionType(const Pipeline &pipeline,
+                               const QString &src,
+                               const QString &dst) const;
+
+    private slots:
+        void initTestCase();
+        void autoConnectionIsKept();
+        void explicitConnectionIsKept();
+        void bypassKeepsExplicitType();
+        void bordersAreNotBypassed();
+};
+
+ElementMap TestPipeline::elements(const QStringList &names) const
+{
+    ElementMap elements;
+
+    for (auto &name: names)
+        elements[name] = AkElementPtr(new AkElement);
+
+    return elements;
+}
+
+QString TestPipeline::connectionType(const Pipeline &pipeline,
+                                     const QString &src,
+                                     const QString &dst) const
+{
+    for (auto &link: pipeline.links())
+        if (link.value(0) == src && link.value(1) == dst)
+            return link.value(2);
+
+    return QString();
+}
+
+void TestPipeline::initTestCase()
+{
+    AkElement::setRecursiveSearch(true);
+    AkElement::setSearchPaths(AkElement::searchPaths() << PLUGINS_PATH);
+}
+
+void TestPipeline::autoConnectionIsKept()
+{
+    Pipeline pipeline;
+    pipeline.setElements(this->elements({"a", "b", "c"}));
+    pipeline.setLinks({
+        {"IN.", "a", "AutoConnection"},
+        {"a"  , "b"},
+        {"a"  , "c", "AutoConnection"},
+        {"b"  , "OUT.", "AutoConnection"}
+    });
+
+    QVERIFY(pipeline.compile());
+    QCOMPARE(this->connectionType(pipeline, "a", "b"),
+             QString("AutoConnection"));
+    QCOMPARE(this->connectionType(pipeline, "a", "c"),
+             QString("AutoConnection"));
+}
+
+void TestPipeline::explicitConnectionIsKept()
+{
+    Pipeline pipeline;
+    pipeline.setElements(this->elements({"a", "b"}));
+    pipeline.setLinks({
+        {"a", "b", "QueuedConnection"}
+    });
+
+    QVERIFY(pipeline.compile());
+    QCOMPARE(this->connectionType(pipeline, "a", "b"),
+             QString("QueuedConnection"));
+}
+
+void TestPipeline::bypassKeepsExplicitType()
+{
+    auto probe = AkElement::create("Probe");
+
+    if (!probe)
+        QSKIP("The Probe plugin is not available");
+
+    auto elements = this->elements({"a", "b", "c", "d"});
+    elements["probe1"] = probe;
+    elements["probe2"] = AkElement::create("Probe");
+
+    Pipeline pipeline;
+    pipeline.setElements(elements);
+    pipeline.setLinks({
+        {"a"     , "probe1", "AutoConnection"},
+        {"probe1", "b"     , "QueuedConnection"},
+        {"c"     , "probe2"},
+        {"probe2", "d"     , "AutoConnection"}
+    });
+
+    QVERIFY(pipeline.compile());
+    QVERIFY(!pipeline.elements().contains("probe1"));
+    QVERIFY(!pipeline.elements().contains("probe2"));
+    QCOMPARE(this->connectionType(pipeline, "a", "b"),
+             QString("QueuedConnection"));
+    QCOMPARE(this->connectionType(pipeline, "c", "d"),
+             QString("AutoConnection"));
+    QVERIFY(pipeline.plan().contains("bypass probe1 (Probe)"));
+}
+
+void TestPipeline::bordersAreNotBypassed()
+{
+    auto probe = AkElement::create("Probe");
+
+    if (!probe)
+        QSKIP("The Probe plugin is not available");
+
+    ElementMap elements;
+    elements["probe"] = probe;
+
+    Pipeline pipeline;
+    pipeline.setElements(elements);
+    pipeline.setLinks({
+        {"IN."  , "probe", "AutoConnection"},
+        {"probe", "OUT." , "AutoConnection"}
+    });
+
+    QVERIFY(pipeline.compile());
+    QVERIFY(pipeline.elements().contains("probe"));
+    QCOMPARE(this->connectionType(pipeline, "IN.", "probe"),
+             QString("AutoConnection"));
+}
+
+QTEST_GUILESS_MAIN(TestPipeline)
+
+#include "test.moc"
@@ -109,6 +109,9 @@ SUBDIRS += \
     AkQml \
     Plugins
 
+isEmpty(NOAKBENCH): SUBDIRS += AkBench Tests/akbench
+isEmpty(NOTESTS): SUBDIRS += Tests/pipeline
+
 # Install rules
 
 INSTALLS += \